@@ -8,9 +8,14 @@
 #include "util/vm.hpp"
 #include "util/asm.hpp"
 #include <charconv>
+#include <cerrno>
 #include <immintrin.h>
 #include <zlib.h>
 
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
 #ifdef __linux__
 #define CAN_OVERCOMMIT
 #endif
@@ -31,13 +36,23 @@ static u8* get_jit_memory()
 	return static_cast<u8*>(s_memory2);
 }
 
-// Allocation counters (1G code, 1G data subranges)
-static atomic_t<u64> s_code_pos{0}, s_data_pos{0};
+// Code subrange layout (hot code is kept at the start of the region, cold code is allocated above it)
+static constexpr u32 c_hot_code_size = 0x10000000;
+static constexpr u32 c_cold_code_size = 0x40000000 - c_hot_code_size;
+
+// Allocation counters (256M hot code, 768M cold code, 1G data subranges)
+static atomic_t<u64> s_code_pos{0}, s_cold_pos{0}, s_data_pos{0};
 
 // Snapshot of code generated before main()
-static std::vector<u8> s_code_init, s_data_init;
+static std::vector<u8> s_code_init, s_cold_init, s_data_init;
 
-template <atomic_t<u64>& Ctr, uint Off, utils::protection Prot>
+// Code region used by the current thread
+static thread_local jit_placement s_placement = jit_placement::hot;
+
+// Set when the hot code region is backed by explicit huge pages (until finalize)
+static atomic_t<bool> s_huge_pages{false};
+
+template <atomic_t<u64>& Ctr, uint Off, uint Size, utils::protection Prot>
 static u8* add_jit_memory(usz size, uint align)
 {
 	// Select subrange
@@ -57,7 +72,7 @@ static u8* add_jit_memory(usz size, uint align)
 		const u64 _pos = utils::align(ctr & 0xffff'ffff, align);
 		const u64 _new = utils::align(_pos + size, align);
 
-		if (_new > 0x40000000) [[unlikely]]
+		if (_new > Size) [[unlikely]]
 		{
 			// Sorry, we failed, and further attempts should fail too.
 			ctr |= 0x40000000;
@@ -80,7 +95,6 @@ static u8* add_jit_memory(usz size, uint align)
 
 	if (pos == umax) [[unlikely]]
 	{
-		jit_log.error("Out of memory (size=0x%x, align=0x%x, off=0x%x)", size, align, Off);
 		return nullptr;
 	}
 
@@ -148,19 +162,96 @@ asmjit::Error jit_runtime::_release(void* ptr) noexcept
 
 u8* jit_runtime::alloc(usz size, uint align, bool exec) noexcept
 {
-	if (exec)
+	if (!size && !align)
 	{
-		return add_jit_memory<s_code_pos, 0x0, utils::protection::wx>(size, align);
+		// Return subrange info (cold code is addressed relative to the hot code base as well)
+		return exec ? add_jit_memory<s_code_pos, 0x0, c_hot_code_size, utils::protection::wx>(0, 0)
+			: add_jit_memory<s_data_pos, 0x40000000, 0x40000000, utils::protection::rw>(0, 0);
+	}
+
+	u8* result = nullptr;
+
+	if (!exec)
+	{
+		result = add_jit_memory<s_data_pos, 0x40000000, 0x40000000, utils::protection::rw>(size, align);
+	}
+	else if (s_placement == jit_placement::hot)
+	{
+		result = add_jit_memory<s_code_pos, 0x0, c_hot_code_size, utils::protection::wx>(size, align);
+
+		if (!result) [[unlikely]]
+		{
+			// Spill to the cold region when the hot one is exhausted
+			result = add_jit_memory<s_cold_pos, c_hot_code_size, c_cold_code_size, utils::protection::wx>(size, align);
+		}
 	}
 	else
 	{
-		return add_jit_memory<s_data_pos, 0x40000000, utils::protection::rw>(size, align);
+		result = add_jit_memory<s_cold_pos, c_hot_code_size, c_cold_code_size, utils::protection::wx>(size, align);
+
+		if (!result) [[unlikely]]
+		{
+			result = add_jit_memory<s_code_pos, 0x0, c_hot_code_size, utils::protection::wx>(size, align);
+		}
+	}
+
+	if (!result) [[unlikely]]
+	{
+		jit_log.error("Out of memory (size=0x%x, align=0x%x, exec=%d)", size, align, exec);
 	}
+
+	return result;
+}
+
+jit_placement jit_runtime::set_placement(jit_placement placement) noexcept
+{
+	return std::exchange(s_placement, placement);
+}
+
+void jit_runtime::set_huge_pages(bool enable) noexcept
+{
+	if (!enable)
+	{
+		return;
+	}
+
+#ifdef MAP_HUGETLB
+	if (s_huge_pages.exchange(true))
+	{
+		// Already done for the current boot
+		return;
+	}
+
+	// Remap the hot code region above the committed part (must be called before any code is generated for the current boot)
+	const u64 base = reinterpret_cast<u64>(get_jit_memory());
+	const u64 start = utils::align<u64>(base + (s_code_pos >> 32), 0x200000);
+	const u64 end = (base + c_hot_code_size) & ~u64{0x1fffff};
+
+	if (start >= end)
+	{
+		return;
+	}
+
+	u8* const ptr = reinterpret_cast<u8*>(start);
+	const u64 size = end - start;
+
+	if (::mmap(ptr, size, PROT_READ | PROT_WRITE | PROT_EXEC, MAP_FIXED | MAP_ANON | MAP_PRIVATE | MAP_HUGETLB, -1, 0) != ptr)
+	{
+		// Usually means that the huge page pool (vm.nr_hugepages) is too small, transparent huge pages are still used
+		jit_log.warning("Failed to map 0x%x bytes of JIT code memory with huge pages (%s)", size, std::strerror(errno));
+		utils::memory_reset(ptr, size, utils::protection::wx);
+		return;
+	}
+
+	jit_log.notice("Mapped 0x%x bytes of JIT code memory with huge pages", size);
+#else
+	jit_log.warning("Huge pages for JIT code are not supported on this platform");
+#endif
 }
 
 void jit_runtime::initialize()
 {
-	if (!s_code_init.empty() || !s_data_init.empty())
+	if (!s_code_init.empty() || !s_cold_init.empty() || !s_data_init.empty())
 	{
 		return;
 	}
@@ -168,12 +259,16 @@ void jit_runtime::initialize()
 	// Create code/data snapshot
 	s_code_init.resize(s_code_pos & 0xffff'ffff);
 	std::memcpy(s_code_init.data(), alloc(0, 0, true), s_code_init.size());
+	s_cold_init.resize(s_cold_pos & 0xffff'ffff);
+	std::memcpy(s_cold_init.data(), alloc(0, 0, true) + c_hot_code_size, s_cold_init.size());
 	s_data_init.resize(s_data_pos & 0xffff'ffff);
 	std::memcpy(s_data_init.data(), alloc(0, 0, false), s_data_init.size());
 }
 
 void jit_runtime::finalize() noexcept
 {
+	jit_log.notice("JIT memory usage: hot code 0x%x, cold code 0x%x, data 0x%x", s_code_pos & 0xffff'ffff, s_cold_pos & 0xffff'ffff, s_data_pos & 0xffff'ffff);
+
 	// Reset JIT memory
 #ifdef CAN_OVERCOMMIT
 	utils::memory_reset(get_jit_memory(), 0x80000000);
@@ -183,10 +278,16 @@ void jit_runtime::finalize() noexcept
 #endif
 
 	s_code_pos = 0;
+	s_cold_pos = 0;
 	s_data_pos = 0;
+	s_huge_pages = false;
 
 	// Restore code/data snapshot
+	const jit_placement old = set_placement(jit_placement::hot);
 	std::memcpy(alloc(s_code_init.size(), 1, true), s_code_init.data(), s_code_init.size());
+	set_placement(jit_placement::cold);
+	std::memcpy(alloc(s_cold_init.size(), 1, true), s_cold_init.data(), s_cold_init.size());
+	set_placement(old);
 	std::memcpy(alloc(s_data_init.size(), 1, false), s_data_init.data(), s_data_init.size());
 }
 
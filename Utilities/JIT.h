@@ -28,6 +28,13 @@ enum class jit_class
 	spu_data,
 };
 
+// Code region selected for executable allocations
+enum class jit_placement : u8
+{
+	hot, // Frequently executed code, kept compact to reduce iTLB pressure
+	cold, // Rarely executed or not yet profiled code
+};
+
 // ASMJIT runtime for emitting code in a single 2G region
 struct jit_runtime final : asmjit::HostRuntime
 {
@@ -40,9 +47,15 @@ struct jit_runtime final : asmjit::HostRuntime
 	// Do nothing (deallocation is delayed)
 	asmjit::Error _release(void* p) noexcept override;
 
-	// Allocate memory
+	// Allocate memory (executable memory is taken from the region selected by set_placement)
 	static u8* alloc(usz size, uint align, bool exec = true) noexcept;
 
+	// Select code region for allocations made by the current thread, returns the previous one
+	static jit_placement set_placement(jit_placement placement) noexcept;
+
+	// Try to back the unused part of the hot code region with explicit 2M pages
+	static void set_huge_pages(bool enable) noexcept;
+
 	// Should be called at least once after global initialization
 	static void initialize();
 
@@ -50,6 +63,27 @@ struct jit_runtime final : asmjit::HostRuntime
 	static void finalize() noexcept;
 };
 
+// Select code region for the current thread within a scope
+class jit_placement_scope
+{
+	const jit_placement m_old;
+
+public:
+	explicit jit_placement_scope(jit_placement placement) noexcept
+		: m_old(jit_runtime::set_placement(placement))
+	{
+	}
+
+	jit_placement_scope(const jit_placement_scope&) = delete;
+
+	jit_placement_scope& operator=(const jit_placement_scope&) = delete;
+
+	~jit_placement_scope()
+	{
+		jit_runtime::set_placement(m_old);
+	}
+};
+
 namespace asmjit
 {
 	// Should only be used to build global functions
@@ -7,11 +7,14 @@
 #include "Emu/IdManager.h"
 #include "Emu/GDB.h"
 #include "Emu/Cell/PPUThread.h"
+#include "Emu/Cell/PPUAnalyser.h"
 #include "Emu/Cell/SPUThread.h"
+#include "Emu/Cell/SPURecompiler.h"
 #include "Emu/RSX/RSXThread.h"
 #include "Emu/perf_meter.hpp"
 
 #include "util/asm.hpp"
+#include "util/sysinfo.hpp"
 #include <thread>
 #include <unordered_map>
 #include <map>
@@ -33,6 +36,8 @@ static thread_local u64 s_tls_sctr = -1;
 
 extern thread_local void(*g_tls_log_control)(const char* fmt, u64 progress);
 
+extern std::map<u32, ppu_symbol> ppu_get_symbols();
+
 template <>
 void fmt_class_string<cpu_flag>::format(std::string& out, u64 arg)
 {
@@ -76,24 +81,93 @@ struct cpu_prof
 		// Weak pointer to the thread
 		std::weak_ptr<cpu_thread> wptr;
 
+		// Thread name (for collapsed stacks)
+		std::string thread_name;
+
 		// Block occurences: name -> sample_count
 		std::unordered_map<u64, u64, value_hash<u64>> freq;
 
+		// SPU PC occurences: (name, pc) -> sample_count
+		std::map<std::pair<u64, u32>, u64> pcs;
+
+		// PPU call stack occurences (CIA first): stack -> sample_count
+		std::map<std::vector<u32>, u64> stacks;
+
 		// Total number of samples
 		u64 samples = 0, idle = 0;
 
 		sample_info(const std::shared_ptr<cpu_thread>& ptr)
 			: wptr(ptr)
+			, thread_name(ptr->get_name())
 		{
 		}
 
 		void reset()
 		{
 			freq.clear();
+			pcs.clear();
+			stacks.clear();
 			samples = 0;
 			idle = 0;
 		}
 
+		// Append results in collapsed stack format (thread;function;block;pc count)
+		void append_folded(std::string& out) const
+		{
+			if (pcs.empty())
+			{
+				return;
+			}
+
+			// Frame names must not contain separators
+			std::string thread = thread_name;
+			std::replace(thread.begin(), thread.end(), ';', '_');
+			std::replace(thread.begin(), thread.end(), ' ', '_');
+
+			for (auto& [key, count] : pcs)
+			{
+				const auto [name, pc] = key;
+
+				// Function is identified by the hash, block by the chunk address in lowest 16 bits
+				fmt::append(out, "%s;spu-%s", thread, fmt::base57(be_t<u64>{name & ~u64{0xffff}}));
+				out.resize(out.size() - 4);
+				fmt::append(out, ";chunk-0x%05x;0x%05x %u\n", (name & 0xffff) * 4, pc, count);
+			}
+
+			if (idle)
+			{
+				fmt::append(out, "%s;[idle] %u\n", thread, idle);
+			}
+		}
+
+		// Append results in perf script format (one event per unique call stack, weighted by the sample count)
+		void append_perf(std::string& out, u32 id, const std::map<u32, ppu_symbol>& symbols) const
+		{
+			std::string thread = thread_name;
+			std::replace(thread.begin(), thread.end(), ' ', '_');
+
+			for (auto& [stack, count] : stacks)
+			{
+				fmt::append(out, "%s %u 0.000000: %u cpu-clock:\n", thread, id, count);
+
+				for (u32 addr : stack)
+				{
+					auto found = symbols.upper_bound(addr);
+
+					if (found != symbols.begin() && ((--found)->second.size == 0 || addr - found->first < found->second.size))
+					{
+						fmt::append(out, "\t%16x %s+0x%x (%s)\n", addr, found->second.name, addr - found->first, found->second.module);
+					}
+					else
+					{
+						fmt::append(out, "\t%16x [unknown] ([unknown])\n", addr);
+					}
+				}
+
+				out += '\n';
+			}
+		}
+
 		// Print info
 		void print(u32 id) const
 		{
@@ -134,10 +208,132 @@ struct cpu_prof
 		}
 	};
 
+	// Capture CIA and a shallow LR/backchain walk (up to 8 frames)
+	static void sample_ppu(const ppu_thread& ppu, std::vector<u32>& stack)
+	{
+		stack.clear();
+		stack.emplace_back(atomic_storage<u32>::load(ppu.cia));
+
+		const auto is_valid = [](u64 addr)
+		{
+			return addr <= UINT32_MAX && addr % 4 == 0 && vm::check_addr(static_cast<u32>(addr), vm::page_executable);
+		};
+
+		// Registers are read without synchronization, the result is only a hint
+		u64 sp = atomic_storage<u64>::load(ppu.gpr[1]);
+
+		for (u32 i = 0; i < 8 && sp <= UINT32_MAX - 24 && sp % 0x10 == 0 && vm::check_addr(static_cast<u32>(sp), vm::page_readable, 24); i++)
+		{
+			const u64 addr = *vm::get_super_ptr<u64>(static_cast<u32>(sp + 16));
+
+			if (is_valid(addr))
+			{
+				stack.emplace_back(static_cast<u32>(addr));
+			}
+			else if (i == 0)
+			{
+				// Leaf function which hasn't saved LR yet
+				if (const u64 lr = atomic_storage<u64>::load(ppu.lr); is_valid(lr))
+				{
+					stack.emplace_back(static_cast<u32>(lr));
+				}
+			}
+			else
+			{
+				break;
+			}
+
+			const u64 next = *vm::get_super_ptr<u64>(static_cast<u32>(sp));
+
+			if (next <= sp)
+			{
+				// Stack grows down, back chain must go up
+				break;
+			}
+
+			sp = next;
+		}
+	}
+
+	// Write symbolized PPU call stacks (perf script format)
+	static void write_perf(const std::string& finished, const std::unordered_map<u32, sample_info, value_hash<u64>>& threads)
+	{
+		std::string out = finished;
+
+		const auto symbols = ppu_get_symbols();
+
+		for (auto& [id, info] : threads)
+		{
+			info.append_perf(out, id, symbols);
+		}
+
+		if (out.empty())
+		{
+			return;
+		}
+
+		const std::string path = fs::get_cache_dir() + "ppu_profile.perf";
+
+		if (!fs::write_file(path, fs::rewrite, out))
+		{
+			profiler.error("Failed to write %s (%s)", path, fs::g_tls_error);
+			return;
+		}
+
+		profiler.notice("PPU call stacks written to %s", path);
+	}
+
+	// Write collapsed stacks of all threads for flamegraph tools
+	static void write_folded(const std::string& finished, const std::unordered_map<u32, sample_info, value_hash<u64>>& threads)
+	{
+		std::string out = finished;
+
+		for (auto& [id, info] : threads)
+		{
+			info.append_folded(out);
+		}
+
+		if (out.empty())
+		{
+			return;
+		}
+
+		const std::string path = fs::get_cache_dir() + "spu_profile.folded";
+
+		if (!fs::write_file(path, fs::rewrite, out))
+		{
+			profiler.error("Failed to write %s (%s)", path, fs::g_tls_error);
+			return;
+		}
+
+		profiler.notice("Collapsed stacks written to %s", path);
+	}
+
 	void operator()()
 	{
 		std::unordered_map<u32, sample_info, value_hash<u64>> threads;
 
+		// Collapsed stacks of finished threads and flushed results
+		std::string finished;
+
+		// PPU call stacks of finished threads and flushed results
+		std::string finished_ppu;
+
+		// Scratch vector for PPU samples
+		std::vector<u32> stack;
+
+		// Symbolize PPU results of the thread (while the modules are still loaded)
+		const auto finish_ppu = [&](u32 id, const sample_info& info)
+		{
+			if (!info.stacks.empty())
+			{
+				info.append_perf(finished_ppu, id, ppu_get_symbols());
+			}
+		};
+
+		// Last time SPU ubertrampolines were rebalanced
+		u64 rebalance_time = get_system_time();
+
 		while (thread_ctrl::state() != thread_state::aborting)
 		{
 			bool flush = false;
@@ -176,8 +372,11 @@ struct cpu_prof
 					{
 						// Overwritten: print previous data
 						found->second.print(id);
+						found->second.append_folded(finished);
+						finish_ppu(id, found->second);
 						found->second.reset();
 						found->second.wptr = ptr;
+						found->second.thread_name = ptr->get_name();
 					}
 				}
 			}
@@ -202,8 +401,18 @@ struct cpu_prof
 
 					if (!(ptr->state.load() & (cpu_flag::wait + cpu_flag::stop + cpu_flag::dbg_global_pause)))
 					{
+						if (id >> 24 == 1)
+						{
+							sample_ppu(*static_cast<ppu_thread*>(ptr.get()), stack);
+							info.stacks[stack]++;
+							continue;
+						}
+
 						info.freq[name]++;
 
+						// Attribute the sample to the LS address within the function
+						info.pcs[{name, atomic_storage<u32>::load(static_cast<spu_thread*>(ptr.get())->pc)}]++;
+
 						// Append verification time to fixed common name 0000000...chunk-0x3fffc
 						if ((name & 0xffff) == 0)
 							info.freq[0xffff]++;
@@ -219,11 +428,20 @@ struct cpu_prof
 			for (auto it = threads.begin(), end = threads.end(); it != end;)
 			{
 				if (it->second.wptr.expired())
-					it->second.print(it->first), it = threads.erase(it);
+					it->second.print(it->first), it->second.append_folded(finished), finish_ppu(it->first, it->second), it = threads.erase(it);
 				else
 					it++;
 			}
 
+			// Reorder SPU ubertrampolines by the collected call frequencies (roughly every second)
+			if (const u64 now = get_system_time(); now - rebalance_time >= 1'000'000 && !Emu.IsStopped())
+			{
+				rebalance_time = now;
+
+				// Synchronized with the destruction of spu_runtime
+				spu_runtime::rebalance_ubertrampolines();
+			}
+
 			if (flush)
 			{
 				profiler.success("Flushing profiling results...");
@@ -232,8 +450,13 @@ struct cpu_prof
 				for (auto& [id, info] : threads)
 				{
 					info.print(id);
+					info.append_folded(finished);
+					finish_ppu(id, info);
 					info.reset();
 				}
+
+				write_folded(finished, threads);
+				write_perf(finished_ppu, threads);
 			}
 
 			// Wait, roughly for 20µs
@@ -245,6 +468,9 @@ struct cpu_prof
 		{
 			info.print(id);
 		}
+
+		write_folded(finished, threads);
+		write_perf(finished_ppu, threads);
 	}
 
 	static constexpr auto thread_name = "CPU Profiler"sv;
@@ -444,7 +670,11 @@ void cpu_thread::operator()()
 	{
 	case 1:
 	{
-		//g_fxo->get<cpu_profiler>()->registered.push(id);
+		if (g_cfg.core.ppu_prof)
+		{
+			g_fxo->get<cpu_profiler>()->registered.push(id);
+		}
+
 		break;
 	}
 	case 2:
@@ -932,6 +1162,29 @@ bool cpu_thread::suspend_work::push(cpu_thread* _this) noexcept
 		// First thread to push the work to the workload list pauses all threads and processes it
 		std::lock_guard lock(s_cpu_lock);
 
+		// Batching window: let other threads push their workloads before pausing, unless any of them is urgent
+		if (const u64 window = g_cfg.core.suspend_all_window; window && prio < suspend_prio_urgent)
+		{
+			perf_meter<"SUSPWIN"_u64> perf1;
+
+			const u64 until = get_tsc() + window * utils::get_tsc_freq() / 1000000;
+
+			for (bool urgent = false; !urgent && get_tsc() < until;)
+			{
+				utils::pause();
+
+				// Pushed workloads stay alive until processed
+				for (auto work = s_pushed.load(); work; work = work->next)
+				{
+					if (work->prio >= suspend_prio_urgent)
+					{
+						urgent = true;
+						break;
+					}
+				}
+			}
+		}
+
 		u128 copy = s_cpu_bits.load();
 
 		// Try to prefetch cpu->state earlier
@@ -992,6 +1245,7 @@ bool cpu_thread::suspend_work::push(cpu_thread* _this) noexcept
 
 		u8 min_prio = head->prio;
 		u8 max_prio = head->prio;
+		u32 task_count = 1;
 
 		if (auto* prev = head->next)
 		{
@@ -1007,6 +1261,7 @@ bool cpu_thread::suspend_work::push(cpu_thread* _this) noexcept
 				// Fill priority range
 				min_prio = std::min<u8>(min_prio, head->prio);
 				max_prio = std::max<u8>(max_prio, head->prio);
+				task_count++;
 			}
 			while (prev);
 		}
@@ -1048,6 +1303,24 @@ bool cpu_thread::suspend_work::push(cpu_thread* _this) noexcept
 			cpu->state -= cpu_flag::pause;
 			return true;
 		});
+
+		// Pauses by the number of workloads executed
+		if (task_count == 1)
+		{
+			perf_meter<"SUSP_x1"_u64> perf2(perf0);
+		}
+		else if (task_count < 4)
+		{
+			perf_meter<"SUSP_x2"_u64> perf2(perf0);
+		}
+		else if (task_count < 8)
+		{
+			perf_meter<"SUSP_x4"_u64> perf2(perf0);
+		}
+		else
+		{
+			perf_meter<"SUSP_x8"_u64> perf2(perf0);
+		}
 	}
 	else
 	{
@@ -1104,7 +1377,7 @@ void cpu_thread::flush_profilers() noexcept
 		return;
 	}
 
-	if (g_cfg.core.spu_prof || false)
+	if (g_cfg.core.spu_prof || g_cfg.core.ppu_prof)
 	{
 		g_fxo->get<cpu_profiler>()->registered.push(0);
 	}
@@ -124,6 +124,9 @@ public:
 	// Callback for thread_ctrl::wait or RSX wait
 	virtual void cpu_wait();
 
+	// Workloads with this priority are latency-sensitive and end the batching window of suspend_all()
+	static constexpr u8 suspend_prio_urgent = 3;
+
 	// For internal use
 	struct suspend_work
 	{
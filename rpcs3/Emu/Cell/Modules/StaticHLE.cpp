@@ -2,6 +2,9 @@
 #include "StaticHLE.h"
 #include "Emu/Cell/PPUModule.h"
 #include "Emu/Cell/PPUOpcodes.h"
+#include "Utilities/StrUtil.h"
+#include "Utilities/Thread.h"
+#include "util/sysinfo.hpp"
 
 LOG_CHANNEL(static_hle);
 
@@ -36,64 +39,139 @@ bool statichle_handler::load_patterns()
 {
 	for (u32 i = 0; i < shle_patterns_list.size(); i++)
 	{
-		auto& pattern = shle_patterns_list[i];
+		add_pattern(shle_patterns_list[i], "builtin", i);
+	}
 
-		if (pattern[0].size() != 64)
-		{
-			static_hle.error("[%d]:Start pattern length != 64", i);
-			continue;
-		}
-		if (pattern[1].size() != 2)
-		{
-			static_hle.error("[%d]:Crc16_length != 2", i);
-			continue;
-		}
-		if (pattern[2].size() != 4)
+	// Additional signatures, one per line with the same fields as above separated by spaces, # starts a comment
+	const std::string path = fs::get_config_dir() + "static_hle_patterns.txt";
+
+	if (fs::file f{path})
+	{
+		u32 line_index = 0;
+
+		for (const std::string& line : fmt::split(f.to_string(), {"\n", "\r"}))
 		{
-			static_hle.error("[d]:Crc16 length != 4", i);
-			continue;
+			line_index++;
+
+			const auto fields = fmt::split(line.substr(0, line.find_first_of('#')), {" ", "\t"});
+
+			if (fields.empty())
+			{
+				continue;
+			}
+
+			if (fields.size() != 6)
+			{
+				static_hle.error("%s[%d]: Expected 6 fields, got %d", path, line_index, fields.size());
+				continue;
+			}
+
+			add_pattern({fields[0], fields[1], fields[2], fields[3], fields[4], fields[5]}, path, line_index);
 		}
-		if (pattern[3].size() != 4)
+	}
+
+	hle_index.clear();
+	hle_wildcard.clear();
+	hle_matches.assign(hle_patterns.size(), 0);
+
+	for (u32 i = 0; i < hle_patterns.size(); i++)
+	{
+		const auto& pat = hle_patterns[i];
+
+		if (pat.start_pattern[0] > 0xff || pat.start_pattern[1] > 0xff || pat.start_pattern[2] > 0xff || pat.start_pattern[3] > 0xff)
 		{
-			static_hle.error("[d]:Total length != 4", i);
+			hle_wildcard.push_back(i);
 			continue;
 		}
 
-		shle_pattern dapat;
+		hle_index[pat.start_pattern[0] << 24 | pat.start_pattern[1] << 16 | pat.start_pattern[2] << 8 | pat.start_pattern[3]].push_back(i);
+	}
 
-		auto char_to_u8 = [&](u8 char1, u8 char2) -> u16
-		{
-			u8 hv, lv;
-			if (char1 == '.' && char2 == '.')
-				return 0xFFFF;
+	static_hle.notice("Loaded %u patterns (%u with a leading wildcard)", hle_patterns.size(), hle_wildcard.size());
+	return true;
+}
 
-			if (char1 == '.' || char2 == '.')
-			{
-				static_hle.error("[%d]:Broken byte pattern", i);
-				return -1;
-			}
+bool statichle_handler::add_pattern(const std::array<std::string, 6>& pattern, const std::string& source, u32 i)
+{
+	if (pattern[0].size() != 64)
+	{
+		static_hle.error("%s[%d]: Start pattern length != 64", source, i);
+		return false;
+	}
+	if (pattern[1].size() != 2)
+	{
+		static_hle.error("%s[%d]: Crc16_length != 2", source, i);
+		return false;
+	}
+	if (pattern[2].size() != 4)
+	{
+		static_hle.error("%s[%d]: Crc16 length != 4", source, i);
+		return false;
+	}
+	if (pattern[3].size() != 4)
+	{
+		static_hle.error("%s[%d]: Total length != 4", source, i);
+		return false;
+	}
 
-			hv = char1 > '9' ? char1 - 'A' + 10 : char1 - '0';
-			lv = char2 > '9' ? char2 - 'A' + 10 : char2 - '0';
+	shle_pattern dapat;
+	bool broken = false;
+
+	auto char_to_u8 = [&](u8 char1, u8 char2) -> u16
+	{
+		if (char1 == '.' && char2 == '.')
+			return 0xFFFF;
 
-			return (hv << 4) | lv;
+		const auto hex = [&](u8 c) -> u8
+		{
+			if (c >= '0' && c <= '9')
+				return c - '0';
+			if (c >= 'A' && c <= 'F')
+				return c - 'A' + 10;
+			if (c >= 'a' && c <= 'f')
+				return c - 'a' + 10;
+
+			broken = true;
+			return 0;
 		};
 
-		for (u32 j = 0; j < 32; j++)
-			dapat.start_pattern[j] = char_to_u8(pattern[0][j * 2], pattern[0][(j * 2) + 1]);
+		return (hex(char1) << 4) | hex(char2);
+	};
+
+	for (u32 j = 0; j < 32; j++)
+		dapat.start_pattern[j] = char_to_u8(pattern[0][j * 2], pattern[0][(j * 2) + 1]);
+
+	dapat.crc16_length = static_cast<u8>(char_to_u8(pattern[1][0], pattern[1][1]));
+	dapat.crc16        = static_cast<u16>((char_to_u8(pattern[2][0], pattern[2][1]) << 8) | char_to_u8(pattern[2][2], pattern[2][3]));
+	dapat.total_length = static_cast<u16>((char_to_u8(pattern[3][0], pattern[3][1]) << 8) | char_to_u8(pattern[3][2], pattern[3][3]));
+	dapat._module      = pattern[4];
+	dapat.name         = pattern[5];
+
+	if (broken)
+	{
+		static_hle.error("%s[%d]: Broken byte pattern", source, i);
+		return false;
+	}
 
-		dapat.crc16_length = ::narrow<u8>(char_to_u8(pattern[1][0], pattern[1][1]));
-		dapat.crc16        = (char_to_u8(pattern[2][0], pattern[2][1]) << 8) | char_to_u8(pattern[2][2], pattern[2][3]);
-		dapat.total_length = (char_to_u8(pattern[3][0], pattern[3][1]) << 8) | char_to_u8(pattern[3][2], pattern[3][3]);
-		dapat._module      = pattern[4];
-		dapat.name         = pattern[5];
+	dapat.fnid = ppu_generate_id(dapat.name.c_str());
 
-		dapat.fnid = ppu_generate_id(dapat.name.c_str());
+	// Check the target early, the patterns may come from a user file
+	const auto smodule = ppu_module_manager::get_module(dapat._module);
 
-		static_hle.notice("Added a pattern for %s(id:0x%X)", dapat.name, dapat.fnid);
-		hle_patterns.push_back(std::move(dapat));
+	if (smodule == nullptr)
+	{
+		static_hle.error("%s[%d]: Couldn't find module: %s", source, i, dapat._module);
+		return false;
 	}
 
+	if (!smodule->functions.count(dapat.fnid))
+	{
+		static_hle.error("%s[%d]: Couldn't find function %s in module %s", source, i, dapat.name, dapat._module);
+		return false;
+	}
+
+	static_hle.notice("Added a pattern for %s(id:0x%X)", dapat.name, dapat.fnid);
+	hle_patterns.push_back(std::move(dapat));
 	return true;
 }
 
@@ -126,54 +204,178 @@ u16 statichle_handler::gen_CRC16(const u8* data_p, usz length)
 	return static_cast<u16>(crc);
 }
 
-bool statichle_handler::check_against_patterns(vm::cptr<u8>& data, u32 size, u32 addr)
+u32 statichle_handler::find_pattern(const u8* data, u32 size)
 {
-	for (auto& pat : hle_patterns)
+	if (size < 32)
 	{
-		if (size < pat.total_length)
-			continue;
+		return -1;
+	}
+
+	const auto test = [&](const shle_pattern& pat)
+	{
+		if (size < std::max<u32>(pat.total_length, 32 + pat.crc16_length))
+			return false;
 
 		// check start pattern
-		int i = 0;
-		for (i = 0; i < 32; i++)
+		for (u32 i = 0; i < 32; i++)
 		{
 			if (pat.start_pattern[i] == 0xFFFF)
 				continue;
 			if (data[i] != pat.start_pattern[i])
-				break;
+				return false;
 		}
 
-		if (i != 32)
-			continue;
-
 		// start pattern ok, checking middle part
 		if (pat.crc16_length != 0)
 			if (gen_CRC16(&data[32], pat.crc16_length) != pat.crc16)
-				continue;
+				return false;
 
-		// we got a match!
-		static_hle.success("Found function %s at 0x%x", pat.name, addr);
+		return true;
+	};
 
-		// patch the code
-		const auto smodule = ppu_module_manager::get_module(pat._module);
+	u32 result = -1;
 
-		if (smodule == nullptr)
+	if (const auto found = hle_index.find(data[0] << 24 | data[1] << 16 | data[2] << 8 | data[3]); found != hle_index.end())
+	{
+		for (u32 index : found->second)
 		{
-			static_hle.error("Couldn't find module: %s", pat._module);
-			return false;
+			if (test(hle_patterns[index]))
+			{
+				result = index;
+				break;
+			}
 		}
+	}
 
-		const auto sfunc   = &smodule->functions.at(pat.fnid);
-		const u32 target   = ppu_function_manager::func_addr(sfunc->index) + 4;
+	// Keep the pattern list order when both kinds match
+	for (u32 index : hle_wildcard)
+	{
+		if (index >= result)
+			break;
 
-		// write stub
-		vm::write32(addr, ppu_instructions::LIS(0, (target&0xFFFF0000)>>16));
-		vm::write32(addr+4, ppu_instructions::ORI(0, 0, target&0xFFFF));
-		vm::write32(addr+8, ppu_instructions::MTCTR(0));
-		vm::write32(addr+12, ppu_instructions::BCTR());
+		if (test(hle_patterns[index]))
+		{
+			result = index;
+			break;
+		}
+	}
 
-		return true;
+	return result;
+}
+
+bool statichle_handler::patch(const shle_pattern& pat, u32 addr)
+{
+	// we got a match!
+	static_hle.success("Found function %s at 0x%x", pat.name, addr);
+
+	// patch the code
+	const auto smodule = ppu_module_manager::get_module(pat._module);
+
+	if (smodule == nullptr)
+	{
+		static_hle.error("Couldn't find module: %s", pat._module);
+		return false;
+	}
+
+	const auto sfunc   = &smodule->functions.at(pat.fnid);
+	const u32 target   = ppu_function_manager::func_addr(sfunc->index) + 4;
+
+	// write stub
+	vm::write32(addr, ppu_instructions::LIS(0, (target&0xFFFF0000)>>16));
+	vm::write32(addr+4, ppu_instructions::ORI(0, 0, target&0xFFFF));
+	vm::write32(addr+8, ppu_instructions::MTCTR(0));
+	vm::write32(addr+12, ppu_instructions::BCTR());
+
+	return true;
+}
+
+bool statichle_handler::check_against_patterns(vm::cptr<u8>& data, u32 size, u32 addr)
+{
+	const u32 index = find_pattern(data.get_ptr(), size);
+
+	if (index == umax)
+	{
+		return false;
+	}
+
+	hle_matches[index]++;
+	return patch(hle_patterns[index], addr);
+}
+
+u32 statichle_handler::scan(u32 addr, u32 size)
+{
+	if (hle_patterns.empty() || size < 32)
+	{
+		return 0;
+	}
+
+	// Chunks of the range are scanned in parallel, patching is done in address order afterwards
+	constexpr u32 chunk_size = 0x10000;
+
+	const u32 chunk_count = (size + chunk_size - 1) / chunk_size;
+
+	const u8* const base = vm::_ptr<const u8>(addr);
+
+	std::vector<std::vector<std::pair<u32, u32>>> found(chunk_count);
+
+	atomic_t<u32> next_chunk = 0;
+
+	const auto scan_chunks = [&]()
+	{
+		for (u32 chunk = next_chunk++; chunk < chunk_count; chunk = next_chunk++)
+		{
+			const u32 end = std::min(size, (chunk + 1) * chunk_size);
+
+			for (u32 off = chunk * chunk_size; off < end; off += 4)
+			{
+				if (const u32 index = find_pattern(base + off, size - off); index != umax)
+				{
+					found[chunk].emplace_back(addr + off, index);
+				}
+			}
+		}
+	};
+
+	if (const u32 thread_count = std::min<u32>(utils::get_thread_count(), chunk_count); thread_count > 1)
+	{
+		named_thread_group workers("Static HLE Scan ", thread_count, scan_chunks);
+	}
+	else
+	{
+		scan_chunks();
+	}
+
+	u32 patched = 0;
+	u32 next_addr = 0;
+
+	for (const auto& chunk : found)
+	{
+		for (const auto& [match_addr, index] : chunk)
+		{
+			// A stub was just written over this location
+			if (match_addr < next_addr)
+			{
+				continue;
+			}
+
+			hle_matches[index]++;
+
+			if (patch(hle_patterns[index], match_addr))
+			{
+				next_addr = match_addr + 16;
+				patched++;
+			}
+		}
+	}
+
+	for (u32 i = 0; i < hle_patterns.size(); i++)
+	{
+		if (hle_matches[i])
+		{
+			static_hle.notice("Pattern %u (%s::%s) matched %u time(s)", i, hle_patterns[i]._module, hle_patterns[i].name, hle_matches[i]);
+		}
 	}
 
-	return false;
+	static_hle.success("Patched %u function(s) in 0x%x bytes at 0x%x (%u patterns)", patched, size, addr, hle_patterns.size());
+	return patched;
 }
@@ -3,6 +3,7 @@
 #include "util/types.hpp"
 #include "Emu/Memory/vm_ptr.h"
 #include <vector>
+#include <unordered_map>
 
 struct shle_pattern
 {
@@ -25,8 +26,25 @@ public:
 	bool load_patterns();
 	bool check_against_patterns(vm::cptr<u8>& data, u32 size, u32 addr);
 
+	// Scan the code range once (in parallel) and patch every match, returns the number of patched functions
+	u32 scan(u32 addr, u32 size);
+
 protected:
 	u16 gen_CRC16(const u8* data_p, usz length);
 
+	bool add_pattern(const std::array<std::string, 6>& pattern, const std::string& source, u32 index);
+
+	// Returns the index of the first pattern matching the data, or -1
+	u32 find_pattern(const u8* data, u32 size);
+
+	bool patch(const shle_pattern& pat, u32 addr);
+
 	std::vector<shle_pattern> hle_patterns;
+
+	// Patterns indexed by their first big-endian word, patterns with a wildcard in it are tested everywhere
+	std::unordered_map<u32, std::vector<u32>> hle_index;
+	std::vector<u32> hle_wildcard;
+
+	// Matches per pattern since boot
+	std::vector<u32> hle_matches;
 };
@@ -5,6 +5,7 @@
 #include "Emu/Memory/vm_reservation.h"
 #include "Emu/Cell/SPUThread.h"
 #include "Emu/Cell/SPURecompiler.h"
+#include "Emu/Cell/SPUInterpreter.h"
 #include "Emu/Cell/lv2/sys_lwmutex.h"
 #include "Emu/Cell/lv2/sys_lwcond.h"
 #include "Emu/Cell/lv2/sys_spu.h"
@@ -19,6 +20,8 @@
 
 LOG_CHANNEL(cellSpurs);
 
+extern const spu_decoder<spu_interpreter_precise> g_spu_interpreter_precise;
+
 //----------------------------------------------------------------------------
 // Function prototypes
 //----------------------------------------------------------------------------
@@ -40,6 +43,8 @@ static void spursHalt(spu_thread& spu);
 //
 static bool spursKernel1SelectWorkload(spu_thread& spu);
 static bool spursKernel2SelectWorkload(spu_thread& spu);
+static u64 spursKernel1SelectWorkload(SpursKernelContext* ctxt, CellSpurs* spurs, u32 isPoll);
+static u64 spursKernel2SelectWorkload(SpursKernelContext* ctxt, CellSpurs* spurs, u32 isPoll);
 static void spursKernelDispatchWorkload(spu_thread& spu, u64 widAndPollStatus);
 static bool spursKernelWorkloadExit(spu_thread& spu);
 bool spursKernelEntry(spu_thread& spu);
@@ -259,360 +264,530 @@ s32 sys_spu_thread_switch_system_module(spu_thread& spu, u32 status)
 // SPURS kernel functions
 //----------------------------------------------------------------------------
 
-// Select a workload to run
-bool spursKernel1SelectWorkload(spu_thread& spu)
+// Select a workload to run, returns the workload id and the poll status.
+// Only the first 0x80 bytes of spurs are accessed, the caller is responsible for atomicity.
+u64 spursKernel1SelectWorkload(SpursKernelContext* ctxt, CellSpurs* spurs, u32 isPoll)
 {
-	const auto ctxt = spu._ptr<SpursKernelContext>(0x100);
-
-	// The first and only argument to this function is a boolean that is set to false if the function
-	// is called by the SPURS kernel and set to true if called by cellSpursModulePollStatus.
-	// If the first argument is true then the shared data is not updated with the result.
-	const auto isPoll = spu.gpr[3]._u32[3];
-
+	// isPoll is set to false if the function is called by the SPURS kernel and set to true if called by cellSpursModulePollStatus.
+	// If isPoll is true then the shared data is not updated with the result.
 	u32 wklSelectedId;
 	u32 pollStatus;
 
-	//vm::reservation_op(vm::cast(ctxt->spurs.addr()), 128, [&]()
+	// Calculate the contention (number of SPUs used) for each workload
+	u8 contention[CELL_SPURS_MAX_WORKLOAD];
+	u8 pendingContention[CELL_SPURS_MAX_WORKLOAD];
+	for (u32 i = 0; i < CELL_SPURS_MAX_WORKLOAD; i++)
 	{
-		// lock the first 0x80 bytes of spurs
-		auto spurs = ctxt->spurs.get_ptr();
+		contention[i] = spurs->wklCurrentContention[i] - ctxt->wklLocContention[i];
 
-		// Calculate the contention (number of SPUs used) for each workload
-		u8 contention[CELL_SPURS_MAX_WORKLOAD];
-		u8 pendingContention[CELL_SPURS_MAX_WORKLOAD];
-		for (u32 i = 0; i < CELL_SPURS_MAX_WORKLOAD; i++)
+		// If this is a poll request then the number of SPUs pending to context switch is also added to the contention presumably
+		// to prevent unnecessary jumps to the kernel
+		if (isPoll)
 		{
-			contention[i] = spurs->wklCurrentContention[i] - ctxt->wklLocContention[i];
-
-			// If this is a poll request then the number of SPUs pending to context switch is also added to the contention presumably
-			// to prevent unnecessary jumps to the kernel
-			if (isPoll)
+			pendingContention[i] = spurs->wklPendingContention[i] - ctxt->wklLocPendingContention[i];
+			if (i != ctxt->wklCurrentId)
 			{
-				pendingContention[i] = spurs->wklPendingContention[i] - ctxt->wklLocPendingContention[i];
-				if (i != ctxt->wklCurrentId)
-				{
-					contention[i] += pendingContention[i];
-				}
+				contention[i] += pendingContention[i];
 			}
 		}
+	}
 
-		wklSelectedId = CELL_SPURS_SYS_SERVICE_WORKLOAD_ID;
-		pollStatus = 0;
+	wklSelectedId = CELL_SPURS_SYS_SERVICE_WORKLOAD_ID;
+	pollStatus = 0;
 
-		// The system service has the highest priority. Select the system service if
-		// the system service message bit for this SPU is set.
-		if (spurs->sysSrvMessage & (1 << ctxt->spuNum))
+	// The system service has the highest priority. Select the system service if
+	// the system service message bit for this SPU is set.
+	if (spurs->sysSrvMessage & (1 << ctxt->spuNum))
+	{
+		ctxt->spuIdling = 0;
+		if (!isPoll || ctxt->wklCurrentId == CELL_SPURS_SYS_SERVICE_WORKLOAD_ID)
 		{
-			ctxt->spuIdling = 0;
-			if (!isPoll || ctxt->wklCurrentId == CELL_SPURS_SYS_SERVICE_WORKLOAD_ID)
-			{
-				// Clear the message bit
-				spurs->sysSrvMessage.raw() &= ~(1 << ctxt->spuNum);
-			}
+			// Clear the message bit
+			spurs->sysSrvMessage.raw() &= ~(1 << ctxt->spuNum);
 		}
-		else
+	}
+	else
+	{
+		// Caclulate the scheduling weight for each workload
+		u16 maxWeight = 0;
+		for (u32 i = 0; i < CELL_SPURS_MAX_WORKLOAD; i++)
 		{
-			// Caclulate the scheduling weight for each workload
-			u16 maxWeight = 0;
-			for (u32 i = 0; i < CELL_SPURS_MAX_WORKLOAD; i++)
+			u16 runnable = ctxt->wklRunnable1 & (0x8000 >> i);
+			u16 wklSignal = spurs->wklSignal1.load() & (0x8000 >> i);
+			u8  wklFlag = spurs->wklFlag.flag.load() == 0u ? spurs->wklFlagReceiver == i ? 1 : 0 : 0;
+			u8  readyCount = spurs->wklReadyCount1[i] > CELL_SPURS_MAX_SPU ? CELL_SPURS_MAX_SPU : spurs->wklReadyCount1[i].load();
+			u8  idleSpuCount = spurs->wklIdleSpuCountOrReadyCount2[i] > CELL_SPURS_MAX_SPU ? CELL_SPURS_MAX_SPU : spurs->wklIdleSpuCountOrReadyCount2[i].load();
+			u8  requestCount = readyCount + idleSpuCount;
+
+			// For a workload to be considered for scheduling:
+			// 1. Its priority must not be 0
+			// 2. The number of SPUs used by it must be less than the max contention for that workload
+			// 3. The workload should be in runnable state
+			// 4. The number of SPUs allocated to it must be less than the number of SPUs requested (i.e. readyCount)
+			//    OR the workload must be signalled
+			//    OR the workload flag is 0 and the workload is configured as the wokload flag receiver
+			if (runnable && ctxt->priority[i] != 0 && spurs->wklMaxContention[i] > contention[i])
 			{
-				u16 runnable = ctxt->wklRunnable1 & (0x8000 >> i);
-				u16 wklSignal = spurs->wklSignal1.load() & (0x8000 >> i);
-				u8  wklFlag = spurs->wklFlag.flag.load() == 0u ? spurs->wklFlagReceiver == i ? 1 : 0 : 0;
-				u8  readyCount = spurs->wklReadyCount1[i] > CELL_SPURS_MAX_SPU ? CELL_SPURS_MAX_SPU : spurs->wklReadyCount1[i].load();
-				u8  idleSpuCount = spurs->wklIdleSpuCountOrReadyCount2[i] > CELL_SPURS_MAX_SPU ? CELL_SPURS_MAX_SPU : spurs->wklIdleSpuCountOrReadyCount2[i].load();
-				u8  requestCount = readyCount + idleSpuCount;
-
-				// For a workload to be considered for scheduling:
-				// 1. Its priority must not be 0
-				// 2. The number of SPUs used by it must be less than the max contention for that workload
-				// 3. The workload should be in runnable state
-				// 4. The number of SPUs allocated to it must be less than the number of SPUs requested (i.e. readyCount)
-				//    OR the workload must be signalled
-				//    OR the workload flag is 0 and the workload is configured as the wokload flag receiver
-				if (runnable && ctxt->priority[i] != 0 && spurs->wklMaxContention[i] > contention[i])
+				if (wklFlag || wklSignal || (readyCount != 0 && requestCount > contention[i]))
 				{
-					if (wklFlag || wklSignal || (readyCount != 0 && requestCount > contention[i]))
+					// The scheduling weight of the workload is formed from the following parameters in decreasing order of priority:
+					// 1. Wokload signal set or workload flag or ready count > contention
+					// 2. Priority of the workload on the SPU
+					// 3. Is the workload the last selected workload
+					// 4. Minimum contention of the workload
+					// 5. Number of SPUs that are being used by the workload (lesser the number, more the weight)
+					// 6. Is the workload executable same as the currently loaded executable
+					// 7. The workload id (lesser the number, more the weight)
+					u16 weight = (wklFlag || wklSignal || (readyCount > contention[i])) ? 0x8000 : 0;
+					weight |= (ctxt->priority[i] & 0x7F) << 8; // TODO: was shifted << 16
+					weight |= i == ctxt->wklCurrentId ? 0x80 : 0x00;
+					weight |= (contention[i] > 0 && spurs->wklMinContention[i] > contention[i]) ? 0x40 : 0x00;
+					weight |= ((CELL_SPURS_MAX_SPU - contention[i]) & 0x0F) << 2;
+					weight |= ctxt->wklUniqueId[i] == ctxt->wklCurrentId ? 0x02 : 0x00;
+					weight |= 0x01;
+
+					// In case of a tie the lower numbered workload is chosen
+					if (weight > maxWeight)
 					{
-						// The scheduling weight of the workload is formed from the following parameters in decreasing order of priority:
-						// 1. Wokload signal set or workload flag or ready count > contention
-						// 2. Priority of the workload on the SPU
-						// 3. Is the workload the last selected workload
-						// 4. Minimum contention of the workload
-						// 5. Number of SPUs that are being used by the workload (lesser the number, more the weight)
-						// 6. Is the workload executable same as the currently loaded executable
-						// 7. The workload id (lesser the number, more the weight)
-						u16 weight = (wklFlag || wklSignal || (readyCount > contention[i])) ? 0x8000 : 0;
-						weight |= (ctxt->priority[i] & 0x7F) << 8; // TODO: was shifted << 16
-						weight |= i == ctxt->wklCurrentId ? 0x80 : 0x00;
-						weight |= (contention[i] > 0 && spurs->wklMinContention[i] > contention[i]) ? 0x40 : 0x00;
-						weight |= ((CELL_SPURS_MAX_SPU - contention[i]) & 0x0F) << 2;
-						weight |= ctxt->wklUniqueId[i] == ctxt->wklCurrentId ? 0x02 : 0x00;
-						weight |= 0x01;
-
-						// In case of a tie the lower numbered workload is chosen
-						if (weight > maxWeight)
-						{
-							wklSelectedId = i;
-							maxWeight = weight;
-							pollStatus = readyCount > contention[i] ? CELL_SPURS_MODULE_POLL_STATUS_READYCOUNT : 0;
-							pollStatus |= wklSignal ? CELL_SPURS_MODULE_POLL_STATUS_SIGNAL : 0;
-							pollStatus |= wklFlag ? CELL_SPURS_MODULE_POLL_STATUS_FLAG : 0;
-						}
+						wklSelectedId = i;
+						maxWeight = weight;
+						pollStatus = readyCount > contention[i] ? CELL_SPURS_MODULE_POLL_STATUS_READYCOUNT : 0;
+						pollStatus |= wklSignal ? CELL_SPURS_MODULE_POLL_STATUS_SIGNAL : 0;
+						pollStatus |= wklFlag ? CELL_SPURS_MODULE_POLL_STATUS_FLAG : 0;
 					}
 				}
 			}
+		}
 
-			// Not sure what this does. Possibly mark the SPU as idle/in use.
-			ctxt->spuIdling = wklSelectedId == CELL_SPURS_SYS_SERVICE_WORKLOAD_ID ? 1 : 0;
+		// Not sure what this does. Possibly mark the SPU as idle/in use.
+		ctxt->spuIdling = wklSelectedId == CELL_SPURS_SYS_SERVICE_WORKLOAD_ID ? 1 : 0;
 
-			if (!isPoll || wklSelectedId == ctxt->wklCurrentId)
-			{
-				// Clear workload signal for the selected workload
-				spurs->wklSignal1.raw() &= ~(0x8000 >> wklSelectedId);
-				spurs->wklSignal2.raw() &= ~(0x80000000u >> wklSelectedId);
+		if (!isPoll || wklSelectedId == ctxt->wklCurrentId)
+		{
+			// Clear workload signal for the selected workload
+			spurs->wklSignal1.raw() &= ~(0x8000 >> wklSelectedId);
+			spurs->wklSignal2.raw() &= ~(0x80000000u >> wklSelectedId);
 
-				// If the selected workload is the wklFlag workload then pull the wklFlag to all 1s
-				if (wklSelectedId == spurs->wklFlagReceiver)
-				{
-					spurs->wklFlag.flag = -1;
-				}
+			// If the selected workload is the wklFlag workload then pull the wklFlag to all 1s
+			if (wklSelectedId == spurs->wklFlagReceiver)
+			{
+				spurs->wklFlag.flag = -1;
 			}
 		}
+	}
 
-		if (!isPoll)
+	if (!isPoll)
+	{
+		// Called by kernel
+		// Increment the contention for the selected workload
+		if (wklSelectedId != CELL_SPURS_SYS_SERVICE_WORKLOAD_ID)
 		{
-			// Called by kernel
-			// Increment the contention for the selected workload
-			if (wklSelectedId != CELL_SPURS_SYS_SERVICE_WORKLOAD_ID)
-			{
-				contention[wklSelectedId]++;
-			}
-
-			for (u32 i = 0; i < CELL_SPURS_MAX_WORKLOAD; i++)
-			{
-				spurs->wklCurrentContention[i] = contention[i];
-				spurs->wklPendingContention[i] = spurs->wklPendingContention[i] - ctxt->wklLocPendingContention[i];
-				ctxt->wklLocContention[i] = 0;
-				ctxt->wklLocPendingContention[i] = 0;
-			}
+			contention[wklSelectedId]++;
+		}
 
-			if (wklSelectedId != CELL_SPURS_SYS_SERVICE_WORKLOAD_ID)
-			{
-				ctxt->wklLocContention[wklSelectedId] = 1;
-			}
+		for (u32 i = 0; i < CELL_SPURS_MAX_WORKLOAD; i++)
+		{
+			spurs->wklCurrentContention[i] = contention[i];
+			spurs->wklPendingContention[i] = spurs->wklPendingContention[i] - ctxt->wklLocPendingContention[i];
+			ctxt->wklLocContention[i] = 0;
+			ctxt->wklLocPendingContention[i] = 0;
+		}
 
-			ctxt->wklCurrentId = wklSelectedId;
+		if (wklSelectedId != CELL_SPURS_SYS_SERVICE_WORKLOAD_ID)
+		{
+			ctxt->wklLocContention[wklSelectedId] = 1;
 		}
-		else if (wklSelectedId != ctxt->wklCurrentId)
+
+		ctxt->wklCurrentId = wklSelectedId;
+	}
+	else if (wklSelectedId != ctxt->wklCurrentId)
+	{
+		// Not called by kernel but a context switch is required
+		// Increment the pending contention for the selected workload
+		if (wklSelectedId != CELL_SPURS_SYS_SERVICE_WORKLOAD_ID)
 		{
-			// Not called by kernel but a context switch is required
-			// Increment the pending contention for the selected workload
-			if (wklSelectedId != CELL_SPURS_SYS_SERVICE_WORKLOAD_ID)
-			{
-				pendingContention[wklSelectedId]++;
-			}
+			pendingContention[wklSelectedId]++;
+		}
 
-			for (u32 i = 0; i < CELL_SPURS_MAX_WORKLOAD; i++)
-			{
-				spurs->wklPendingContention[i] = pendingContention[i];
-				ctxt->wklLocPendingContention[i] = 0;
-			}
+		for (u32 i = 0; i < CELL_SPURS_MAX_WORKLOAD; i++)
+		{
+			spurs->wklPendingContention[i] = pendingContention[i];
+			ctxt->wklLocPendingContention[i] = 0;
+		}
 
-			if (wklSelectedId != CELL_SPURS_SYS_SERVICE_WORKLOAD_ID)
-			{
-				ctxt->wklLocPendingContention[wklSelectedId] = 1;
-			}
+		if (wklSelectedId != CELL_SPURS_SYS_SERVICE_WORKLOAD_ID)
+		{
+			ctxt->wklLocPendingContention[wklSelectedId] = 1;
 		}
-		else
+	}
+	else
+	{
+		// Not called by kernel and no context switch is required
+		for (u32 i = 0; i < CELL_SPURS_MAX_WORKLOAD; i++)
 		{
-			// Not called by kernel and no context switch is required
-			for (u32 i = 0; i < CELL_SPURS_MAX_WORKLOAD; i++)
-			{
-				spurs->wklPendingContention[i] = spurs->wklPendingContention[i] - ctxt->wklLocPendingContention[i];
-				ctxt->wklLocPendingContention[i] = 0;
-			}
+			spurs->wklPendingContention[i] = spurs->wklPendingContention[i] - ctxt->wklLocPendingContention[i];
+			ctxt->wklLocPendingContention[i] = 0;
 		}
+	}
 
-		std::memcpy(ctxt, spurs, 128);
-	}//);
+	std::memcpy(ctxt, spurs, 128);
 
 	u64 result = u64{wklSelectedId} << 32;
 	result |= pollStatus;
-	spu.gpr[3]._u64[1] = result;
-	return true;
+	return result;
 }
 
-// Select a workload to run
-bool spursKernel2SelectWorkload(spu_thread& spu)
+// Select a workload to run, returns the workload id and the poll status.
+// Only the first 0x80 bytes of spurs are accessed, the caller is responsible for atomicity.
+u64 spursKernel2SelectWorkload(SpursKernelContext* ctxt, CellSpurs* spurs, u32 isPoll)
 {
-	const auto ctxt = spu._ptr<SpursKernelContext>(0x100);
-
-	// The first and only argument to this function is a boolean that is set to false if the function
-	// is called by the SPURS kernel and set to true if called by cellSpursModulePollStatus.
-	// If the first argument is true then the shared data is not updated with the result.
-	const auto isPoll = spu.gpr[3]._u32[3];
-
+	// isPoll is set to false if the function is called by the SPURS kernel and set to true if called by cellSpursModulePollStatus.
+	// If isPoll is true then the shared data is not updated with the result.
 	u32 wklSelectedId;
 	u32 pollStatus;
 
-	//vm::reservation_op(vm::cast(ctxt->spurs.addr()), 128, [&]()
+	// Calculate the contention (number of SPUs used) for each workload
+	u8 contention[CELL_SPURS_MAX_WORKLOAD2];
+	u8 pendingContention[CELL_SPURS_MAX_WORKLOAD2];
+	for (u32 i = 0; i < CELL_SPURS_MAX_WORKLOAD2; i++)
 	{
-		// lock the first 0x80 bytes of spurs
-		auto spurs = ctxt->spurs.get_ptr();
+		contention[i] = spurs->wklCurrentContention[i & 0x0F] - ctxt->wklLocContention[i & 0x0F];
+		contention[i] = i + 0u < CELL_SPURS_MAX_WORKLOAD ? contention[i] & 0x0F : contention[i] >> 4;
 
-		// Calculate the contention (number of SPUs used) for each workload
-		u8 contention[CELL_SPURS_MAX_WORKLOAD2];
-		u8 pendingContention[CELL_SPURS_MAX_WORKLOAD2];
-		for (u32 i = 0; i < CELL_SPURS_MAX_WORKLOAD2; i++)
+		// If this is a poll request then the number of SPUs pending to context switch is also added to the contention presumably
+		// to prevent unnecessary jumps to the kernel
+		if (isPoll)
 		{
-			contention[i] = spurs->wklCurrentContention[i & 0x0F] - ctxt->wklLocContention[i & 0x0F];
-			contention[i] = i + 0u < CELL_SPURS_MAX_WORKLOAD ? contention[i] & 0x0F : contention[i] >> 4;
-
-			// If this is a poll request then the number of SPUs pending to context switch is also added to the contention presumably
-			// to prevent unnecessary jumps to the kernel
-			if (isPoll)
+			pendingContention[i] = spurs->wklPendingContention[i & 0x0F] - ctxt->wklLocPendingContention[i & 0x0F];
+			pendingContention[i] = i + 0u < CELL_SPURS_MAX_WORKLOAD ? pendingContention[i] & 0x0F : pendingContention[i] >> 4;
+			if (i != ctxt->wklCurrentId)
 			{
-				pendingContention[i] = spurs->wklPendingContention[i & 0x0F] - ctxt->wklLocPendingContention[i & 0x0F];
-				pendingContention[i] = i + 0u < CELL_SPURS_MAX_WORKLOAD ? pendingContention[i] & 0x0F : pendingContention[i] >> 4;
-				if (i != ctxt->wklCurrentId)
-				{
-					contention[i] += pendingContention[i];
-				}
+				contention[i] += pendingContention[i];
 			}
 		}
+	}
 
-		wklSelectedId = CELL_SPURS_SYS_SERVICE_WORKLOAD_ID;
-		pollStatus = 0;
+	wklSelectedId = CELL_SPURS_SYS_SERVICE_WORKLOAD_ID;
+	pollStatus = 0;
 
-		// The system service has the highest priority. Select the system service if
-		// the system service message bit for this SPU is set.
-		if (spurs->sysSrvMessage & (1 << ctxt->spuNum))
+	// The system service has the highest priority. Select the system service if
+	// the system service message bit for this SPU is set.
+	if (spurs->sysSrvMessage & (1 << ctxt->spuNum))
+	{
+		// Not sure what this does. Possibly Mark the SPU as in use.
+		ctxt->spuIdling = 0;
+		if (!isPoll || ctxt->wklCurrentId == CELL_SPURS_SYS_SERVICE_WORKLOAD_ID)
 		{
-			// Not sure what this does. Possibly Mark the SPU as in use.
-			ctxt->spuIdling = 0;
-			if (!isPoll || ctxt->wklCurrentId == CELL_SPURS_SYS_SERVICE_WORKLOAD_ID)
-			{
-				// Clear the message bit
-				spurs->sysSrvMessage.raw() &= ~(1 << ctxt->spuNum);
-			}
+			// Clear the message bit
+			spurs->sysSrvMessage.raw() &= ~(1 << ctxt->spuNum);
 		}
-		else
+	}
+	else
+	{
+		// Caclulate the scheduling weight for each workload
+		u8 maxWeight = 0;
+		for (u32 i = 0; i < CELL_SPURS_MAX_WORKLOAD2; i++)
 		{
-			// Caclulate the scheduling weight for each workload
-			u8 maxWeight = 0;
-			for (u32 i = 0; i < CELL_SPURS_MAX_WORKLOAD2; i++)
+			u32 j = i & 0x0f;
+			u16 runnable = i < CELL_SPURS_MAX_WORKLOAD ? ctxt->wklRunnable1 & (0x8000 >> j) : ctxt->wklRunnable2 & (0x8000 >> j);
+			u8  priority = i < CELL_SPURS_MAX_WORKLOAD ? ctxt->priority[j] & 0x0F : ctxt->priority[j] >> 4;
+			u8  maxContention = i < CELL_SPURS_MAX_WORKLOAD ? spurs->wklMaxContention[j] & 0x0F : spurs->wklMaxContention[j] >> 4;
+			u16 wklSignal = i < CELL_SPURS_MAX_WORKLOAD ? spurs->wklSignal1.load() & (0x8000 >> j) : spurs->wklSignal2.load() & (0x8000 >> j);
+			u8  wklFlag = spurs->wklFlag.flag.load() == 0u ? spurs->wklFlagReceiver == i ? 1 : 0 : 0;
+			u8  readyCount = i < CELL_SPURS_MAX_WORKLOAD ? spurs->wklReadyCount1[j] : spurs->wklIdleSpuCountOrReadyCount2[j];
+
+			// For a workload to be considered for scheduling:
+			// 1. Its priority must be greater than 0
+			// 2. The number of SPUs used by it must be less than the max contention for that workload
+			// 3. The workload should be in runnable state
+			// 4. The number of SPUs allocated to it must be less than the number of SPUs requested (i.e. readyCount)
+			//    OR the workload must be signalled
+			//    OR the workload flag is 0 and the workload is configured as the wokload receiver
+			if (runnable && priority > 0 && maxContention > contention[i])
 			{
-				u32 j = i & 0x0f;
-				u16 runnable = i < CELL_SPURS_MAX_WORKLOAD ? ctxt->wklRunnable1 & (0x8000 >> j) : ctxt->wklRunnable2 & (0x8000 >> j);
-				u8  priority = i < CELL_SPURS_MAX_WORKLOAD ? ctxt->priority[j] & 0x0F : ctxt->priority[j] >> 4;
-				u8  maxContention = i < CELL_SPURS_MAX_WORKLOAD ? spurs->wklMaxContention[j] & 0x0F : spurs->wklMaxContention[j] >> 4;
-				u16 wklSignal = i < CELL_SPURS_MAX_WORKLOAD ? spurs->wklSignal1.load() & (0x8000 >> j) : spurs->wklSignal2.load() & (0x8000 >> j);
-				u8  wklFlag = spurs->wklFlag.flag.load() == 0u ? spurs->wklFlagReceiver == i ? 1 : 0 : 0;
-				u8  readyCount = i < CELL_SPURS_MAX_WORKLOAD ? spurs->wklReadyCount1[j] : spurs->wklIdleSpuCountOrReadyCount2[j];
-
-				// For a workload to be considered for scheduling:
-				// 1. Its priority must be greater than 0
-				// 2. The number of SPUs used by it must be less than the max contention for that workload
-				// 3. The workload should be in runnable state
-				// 4. The number of SPUs allocated to it must be less than the number of SPUs requested (i.e. readyCount)
-				//    OR the workload must be signalled
-				//    OR the workload flag is 0 and the workload is configured as the wokload receiver
-				if (runnable && priority > 0 && maxContention > contention[i])
+				if (wklFlag || wklSignal || readyCount > contention[i])
 				{
-					if (wklFlag || wklSignal || readyCount > contention[i])
+					// The scheduling weight of the workload is equal to the priority of the workload for the SPU.
+					// The current workload is given a sligtly higher weight presumably to reduce the number of context switches.
+					// In case of a tie the lower numbered workload is chosen.
+					u8 weight = priority << 4;
+					if (ctxt->wklCurrentId == i)
 					{
-						// The scheduling weight of the workload is equal to the priority of the workload for the SPU.
-						// The current workload is given a sligtly higher weight presumably to reduce the number of context switches.
-						// In case of a tie the lower numbered workload is chosen.
-						u8 weight = priority << 4;
-						if (ctxt->wklCurrentId == i)
-						{
-							weight |= 0x04;
-						}
+						weight |= 0x04;
+					}
 
-						if (weight > maxWeight)
-						{
-							wklSelectedId = i;
-							maxWeight = weight;
-							pollStatus = readyCount > contention[i] ? CELL_SPURS_MODULE_POLL_STATUS_READYCOUNT : 0;
-							pollStatus |= wklSignal ? CELL_SPURS_MODULE_POLL_STATUS_SIGNAL : 0;
-							pollStatus |= wklFlag ? CELL_SPURS_MODULE_POLL_STATUS_FLAG : 0;
-						}
+					if (weight > maxWeight)
+					{
+						wklSelectedId = i;
+						maxWeight = weight;
+						pollStatus = readyCount > contention[i] ? CELL_SPURS_MODULE_POLL_STATUS_READYCOUNT : 0;
+						pollStatus |= wklSignal ? CELL_SPURS_MODULE_POLL_STATUS_SIGNAL : 0;
+						pollStatus |= wklFlag ? CELL_SPURS_MODULE_POLL_STATUS_FLAG : 0;
 					}
 				}
 			}
+		}
 
-			// Not sure what this does. Possibly mark the SPU as idle/in use.
-			ctxt->spuIdling = wklSelectedId == CELL_SPURS_SYS_SERVICE_WORKLOAD_ID ? 1 : 0;
+		// Not sure what this does. Possibly mark the SPU as idle/in use.
+		ctxt->spuIdling = wklSelectedId == CELL_SPURS_SYS_SERVICE_WORKLOAD_ID ? 1 : 0;
 
-			if (!isPoll || wklSelectedId == ctxt->wklCurrentId)
-			{
-				// Clear workload signal for the selected workload
-				spurs->wklSignal1.raw() &= ~(0x8000 >> wklSelectedId);
-				spurs->wklSignal2.raw() &= ~(0x80000000u >> wklSelectedId);
+		if (!isPoll || wklSelectedId == ctxt->wklCurrentId)
+		{
+			// Clear workload signal for the selected workload
+			spurs->wklSignal1.raw() &= ~(0x8000 >> wklSelectedId);
+			spurs->wklSignal2.raw() &= ~(0x80000000u >> wklSelectedId);
 
-				// If the selected workload is the wklFlag workload then pull the wklFlag to all 1s
-				if (wklSelectedId == spurs->wklFlagReceiver)
-				{
-					spurs->wklFlag.flag = -1;
-				}
+			// If the selected workload is the wklFlag workload then pull the wklFlag to all 1s
+			if (wklSelectedId == spurs->wklFlagReceiver)
+			{
+				spurs->wklFlag.flag = -1;
 			}
 		}
+	}
 
-		if (!isPoll)
+	if (!isPoll)
+	{
+		// Called by kernel
+		// Increment the contention for the selected workload
+		if (wklSelectedId != CELL_SPURS_SYS_SERVICE_WORKLOAD_ID)
 		{
-			// Called by kernel
-			// Increment the contention for the selected workload
-			if (wklSelectedId != CELL_SPURS_SYS_SERVICE_WORKLOAD_ID)
-			{
-				contention[wklSelectedId]++;
-			}
+			contention[wklSelectedId]++;
+		}
 
-			for (u32 i = 0; i < (CELL_SPURS_MAX_WORKLOAD2 >> 1); i++)
-			{
-				spurs->wklCurrentContention[i] = contention[i] | (contention[i + 0x10] << 4);
-				spurs->wklPendingContention[i] = spurs->wklPendingContention[i] - ctxt->wklLocPendingContention[i];
-				ctxt->wklLocContention[i] = 0;
-				ctxt->wklLocPendingContention[i] = 0;
-			}
+		for (u32 i = 0; i < (CELL_SPURS_MAX_WORKLOAD2 >> 1); i++)
+		{
+			spurs->wklCurrentContention[i] = contention[i] | (contention[i + 0x10] << 4);
+			spurs->wklPendingContention[i] = spurs->wklPendingContention[i] - ctxt->wklLocPendingContention[i];
+			ctxt->wklLocContention[i] = 0;
+			ctxt->wklLocPendingContention[i] = 0;
+		}
 
-			ctxt->wklLocContention[wklSelectedId & 0x0F] = wklSelectedId < CELL_SPURS_MAX_WORKLOAD ? 0x01 : wklSelectedId < CELL_SPURS_MAX_WORKLOAD2 ? 0x10 : 0;
-			ctxt->wklCurrentId = wklSelectedId;
+		ctxt->wklLocContention[wklSelectedId & 0x0F] = wklSelectedId < CELL_SPURS_MAX_WORKLOAD ? 0x01 : wklSelectedId < CELL_SPURS_MAX_WORKLOAD2 ? 0x10 : 0;
+		ctxt->wklCurrentId = wklSelectedId;
+	}
+	else if (wklSelectedId != ctxt->wklCurrentId)
+	{
+		// Not called by kernel but a context switch is required
+		// Increment the pending contention for the selected workload
+		if (wklSelectedId != CELL_SPURS_SYS_SERVICE_WORKLOAD_ID)
+		{
+			pendingContention[wklSelectedId]++;
 		}
-		else if (wklSelectedId != ctxt->wklCurrentId)
+
+		for (u32 i = 0; i < (CELL_SPURS_MAX_WORKLOAD2 >> 1); i++)
 		{
-			// Not called by kernel but a context switch is required
-			// Increment the pending contention for the selected workload
-			if (wklSelectedId != CELL_SPURS_SYS_SERVICE_WORKLOAD_ID)
-			{
-				pendingContention[wklSelectedId]++;
-			}
+			spurs->wklPendingContention[i] = pendingContention[i] | (pendingContention[i + 0x10] << 4);
+			ctxt->wklLocPendingContention[i] = 0;
+		}
 
-			for (u32 i = 0; i < (CELL_SPURS_MAX_WORKLOAD2 >> 1); i++)
-			{
-				spurs->wklPendingContention[i] = pendingContention[i] | (pendingContention[i + 0x10] << 4);
-				ctxt->wklLocPendingContention[i] = 0;
-			}
+		ctxt->wklLocPendingContention[wklSelectedId & 0x0F] = wklSelectedId < CELL_SPURS_MAX_WORKLOAD ? 0x01 : wklSelectedId < CELL_SPURS_MAX_WORKLOAD2 ? 0x10 : 0;
+	}
+	else
+	{
+		// Not called by kernel and no context switch is required
+		for (u32 i = 0; i < CELL_SPURS_MAX_WORKLOAD; i++)
+		{
+			spurs->wklPendingContention[i] = spurs->wklPendingContention[i] - ctxt->wklLocPendingContention[i];
+			ctxt->wklLocPendingContention[i] = 0;
+		}
+	}
+
+	std::memcpy(ctxt, spurs, 128);
+
+	u64 result = u64{wklSelectedId} << 32;
+	result |= pollStatus;
+	return result;
+}
+
+// First 0x80 bytes of CellSpurs, updated by the kernel with GETLLAR/PUTLLC
+struct alignas(128) spurs_kernel_line
+{
+	u8 data[128];
+};
+
+// Select a workload to run, atomically like the guest kernel
+static u64 spursKernelSelectWorkloadAtomic(spu_thread& spu, SpursKernelContext* ctxt, u32 isPoll, bool isKernel2)
+{
+	u64 result = 0;
+
+	vm::reservation_op(spu, vm::ptr<spurs_kernel_line>::make(static_cast<u32>(ctxt->spurs.addr())), [&](spurs_kernel_line& line)
+	{
+		const auto spurs = reinterpret_cast<CellSpurs*>(&line);
+		result = isKernel2 ? spursKernel2SelectWorkload(ctxt, spurs, isPoll) : spursKernel1SelectWorkload(ctxt, spurs, isPoll);
+	});
+
+	// The reservation is lost by the guest routine
+	spu.raddr = 0;
+	return result;
+}
+
+// Select a workload to run
+bool spursKernel1SelectWorkload(spu_thread& spu)
+{
+	const auto ctxt = spu._ptr<SpursKernelContext>(0x100);
+	spu.gpr[3]._u64[1] = spursKernelSelectWorkloadAtomic(spu, ctxt, spu.gpr[3]._u32[3], false);
+	return true;
+}
+
+// Select a workload to run
+bool spursKernel2SelectWorkload(spu_thread& spu)
+{
+	const auto ctxt = spu._ptr<SpursKernelContext>(0x100);
+	spu.gpr[3]._u64[1] = spursKernelSelectWorkloadAtomic(spu, ctxt, spu.gpr[3]._u32[3], true);
+	return true;
+}
+
+struct spurs_native_kernel_stats
+{
+	atomic_t<u64> calls = 0;
+	atomic_t<u64> verified = 0;
+	atomic_t<u64> mismatches = 0;
+	atomic_t<u64> skipped = 0;
 
-			ctxt->wklLocPendingContention[wklSelectedId & 0x0F] = wklSelectedId < CELL_SPURS_MAX_WORKLOAD ? 0x01 : wklSelectedId < CELL_SPURS_MAX_WORKLOAD2 ? 0x10 : 0;
+	~spurs_native_kernel_stats()
+	{
+		if (calls)
+		{
+			cellSpurs.notice("Native kernel: %u workload selections (%u verified, %u mismatches, %u not comparable)", calls, verified, mismatches, skipped);
 		}
-		else
+	}
+};
+
+// Run the guest routine (at spu.pc) with the interpreter until it returns, returns false on failure
+static bool spursKernelRunGuest(spu_thread& spu, u32 ret)
+{
+	for (u32 steps = 0; spu.pc != ret; steps++)
+	{
+		if (steps >= 0x100000 || (spu.state && spu.check_state()))
+		{
+			return false;
+		}
+
+		const u32 op = spu._ref<u32>(spu.pc);
+
+		if (g_spu_interpreter_precise.decode(op)(spu, {op}))
+		{
+			spu.pc += 4;
+		}
+	}
+
+	return true;
+}
+
+// Replacement for the workload selection routine of the guest SPURS kernel, called by the SPU recompiler instead of compiling it.
+// Returns false if the code at the current address is not the routine of a known kernel.
+bool spursKernelNativeSelectWorkload(spu_thread& spu)
+{
+	if (spu.pc != CELL_SPURS_KERNEL1_SELECT_WORKLOAD_ADDR && spu.pc != CELL_SPURS_KERNEL2_SELECT_WORKLOAD_ADDR)
+	{
+		return false;
+	}
+
+	const auto ctxt = spu._ptr<SpursKernelContext>(0x100);
+
+	// Recognize the kernel by its context, the GUID is part of the kernel image
+	static constexpr u32 s_guid1[4]{0x423A3A02, 0x43F43A82, 0x43F26502, 0x420EB382};
+	static constexpr u32 s_guid2[4]{0x43A08402, 0x43FB0A82, 0x435E9302, 0x43A3C982};
+
+	const bool isKernel2 = ctxt->exitToKernelAddr == CELL_SPURS_KERNEL2_EXIT_ADDR;
+
+	if (!isKernel2 && ctxt->exitToKernelAddr != CELL_SPURS_KERNEL1_EXIT_ADDR)
+	{
+		return false;
+	}
+
+	const auto& guid = isKernel2 ? s_guid2 : s_guid1;
+
+	if (ctxt->selectWorkloadAddr != spu.pc || ctxt->guid[0] != guid[0] || ctxt->guid[1] != guid[1] || ctxt->guid[2] != guid[2] || ctxt->guid[3] != guid[3])
+	{
+		return false;
+	}
+
+	const u64 spurs_addr = ctxt->spurs.addr();
+
+	if (!spurs_addr || spurs_addr % 128 || spurs_addr >> 32 || !vm::check_addr(static_cast<u32>(spurs_addr), vm::page_readable + vm::page_writable, 128))
+	{
+		return false;
+	}
+
+	if (!(ctxt->spurs->flags1 & SF1_32_WORKLOADS) != !isKernel2)
+	{
+		return false;
+	}
+
+	const u32 isPoll = spu.gpr[3]._u32[3];
+	const u32 ret = spu.gpr[0]._u32[3] & 0x3fffc;
+
+	auto& stats = *g_fxo->get<spurs_native_kernel_stats>();
+	stats.calls++;
+
+	if (!g_cfg.core.spurs_native_kernel_verify)
+	{
+		spu.gpr[3]._u64[1] = spursKernelSelectWorkloadAtomic(spu, ctxt, isPoll, isKernel2);
+		spu.pc = ret;
+		return true;
+	}
+
+	// Differential mode: run the native code on a snapshot, then the guest code on the real state, and compare.
+	// The guest results are kept.
+	const u32 addr = static_cast<u32>(spurs_addr);
+	auto& res = vm::reservation_acquire(addr, 128);
+
+	spurs_kernel_line line;
+	u64 rtime;
+
+	do
+	{
+		rtime = res;
+		std::memcpy(&line, vm::base(addr), 128);
+	}
+	while (rtime & vm::rsrv_lock_mask || res != rtime);
+
+	SpursKernelContext ctxt_copy;
+	std::memcpy(&ctxt_copy, ctxt, sizeof(ctxt_copy));
+
+	const auto spurs_copy = reinterpret_cast<CellSpurs*>(&line);
+	const u64 result = isKernel2 ? spursKernel2SelectWorkload(&ctxt_copy, spurs_copy, isPoll) : spursKernel1SelectWorkload(&ctxt_copy, spurs_copy, isPoll);
+
+	if (!spursKernelRunGuest(spu, ret))
+	{
+		stats.skipped++;
+		return true;
+	}
+
+	// Other SPUs may have updated the line in between
+	if (res - rtime > 128)
+	{
+		stats.skipped++;
+		return true;
+	}
+
+	stats.verified++;
+
+	// Returns size if the data is equal
+	const auto first_diff = [](const void* a, const void* b, u32 size) -> u32
+	{
+		for (u32 i = 0; i < size; i++)
 		{
-			// Not called by kernel and no context switch is required
-			for (u32 i = 0; i < CELL_SPURS_MAX_WORKLOAD; i++)
+			if (static_cast<const u8*>(a)[i] != static_cast<const u8*>(b)[i])
 			{
-				spurs->wklPendingContention[i] = spurs->wklPendingContention[i] - ctxt->wklLocPendingContention[i];
-				ctxt->wklLocPendingContention[i] = 0;
+				return i;
 			}
 		}
 
-		std::memcpy(ctxt, spurs, 128);
-	}//);
+		return size;
+	};
+
+	const u32 diff_line = first_diff(&line, vm::base(addr), 128);
+	const u32 diff_ctxt = first_diff(&ctxt_copy, ctxt, sizeof(ctxt_copy));
+
+	if (result != spu.gpr[3]._u64[1] || diff_line != 128 || diff_ctxt != sizeof(ctxt_copy))
+	{
+		stats.mismatches++;
+		cellSpurs.error("Native kernel mismatch (spu=%u, kernel%u, poll=%u): result 0x%llx vs 0x%llx, CellSpurs+0x%x, LS:0x%x", ctxt->spuNum, isKernel2 ? 2 : 1, isPoll,
+			result, spu.gpr[3]._u64[1], diff_line, 0x100 + diff_ctxt);
+	}
 
-	u64 result = u64{wklSelectedId} << 32;
-	result |= pollStatus;
-	spu.gpr[3]._u64[1] = result;
 	return true;
 }
 
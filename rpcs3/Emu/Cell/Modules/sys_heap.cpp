@@ -3,23 +3,289 @@
 #include "Emu/Cell/PPUModule.h"
 
 #include "sysPrxForUser.h"
+#include "sys_heap.h"
+
+#include "util/asm.hpp"
+
+#include <algorithm>
 
 LOG_CHANNEL(sysPrxForUser);
 
+// Chunk sizes served from slabs, each slab holds chunks of one size
+static constexpr u32 s_size_classes[]
+{
+	16, 32, 48, 64, 80, 96, 112, 128,
+	160, 192, 224, 256, 320, 384, 448, 512,
+	640, 768, 896, 1024, 1280, 1536, 1792, 2048,
+	2560, 3072, 3584, 4096, 5120, 6144, 7168, 8192,
+	10240, 12288, 14336, 16384,
+};
+
+static_assert(std::size(s_size_classes) && s_size_classes[std::size(s_size_classes) - 1] == sys_heap_allocator::max_small_size);
+
+sys_heap_allocator::sys_heap_allocator(std::string name)
+	: name(std::move(name))
+	, m_partial(std::size(s_size_classes))
+{
+}
+
+sys_heap_allocator::~sys_heap_allocator()
+{
+	if (m_alloc_count)
+	{
+		log_stats();
+	}
+
+	for (const auto& [addr, size] : m_large)
+	{
+		vm::dealloc(addr, vm::main);
+	}
+
+	for (u32 addr : m_arenas)
+	{
+		vm::dealloc(addr, vm::main);
+	}
+}
+
+u32 sys_heap_allocator::alloc_slab(u32 class_index)
+{
+	if (m_free_slabs.empty())
+	{
+		// Map a new arena, fall back to a single slab when memory is short
+		u32 size = arena_size;
+		u32 addr = vm::alloc(size, vm::main, slab_size);
+
+		if (!addr)
+		{
+			size = slab_size;
+			addr = vm::alloc(size, vm::main, slab_size);
+		}
+
+		if (!addr)
+		{
+			return 0;
+		}
+
+		m_arenas.push_back(addr);
+		m_arena_bytes += size;
+
+		// Reversed so that slabs are used in address order
+		for (u32 i = size; i; i -= slab_size)
+		{
+			m_free_slabs.push_back(addr + i - slab_size);
+		}
+	}
+
+	const u32 addr = m_free_slabs.back();
+	m_free_slabs.pop_back();
+
+	auto& slab = m_slabs[addr];
+	slab.class_index = class_index;
+	slab.used = 0;
+	slab.bump = 0;
+	slab.free_list.clear();
+	slab.allocated.reset();
+
+	m_partial[class_index].push_back(addr);
+	return addr;
+}
+
+u32 sys_heap_allocator::alloc(u32 size, u32 align)
+{
+	size = std::max<u32>(size, 1);
+	align = std::max<u32>(align, 16);
+
+	std::lock_guard lock(m_mutex);
+
+	m_alloc_count++;
+
+	// Slabs are aligned to their size, a chunk is aligned to the largest power of 2 dividing the class size
+	const auto found = std::find_if(std::begin(s_size_classes), std::end(s_size_classes), [&](u32 csize)
+	{
+		return csize >= size && csize % align == 0;
+	});
+
+	if (found == std::end(s_size_classes))
+	{
+		const u32 addr = vm::alloc(size, vm::main, std::max<u32>(align, 0x10000));
+
+		if (addr)
+		{
+			const u32 mapped = utils::align(size, 0x10000);
+			m_large.emplace(addr, mapped);
+			m_large_bytes += mapped;
+			m_peak_bytes = std::max(m_peak_bytes, m_small_bytes + m_large_bytes);
+		}
+
+		return addr;
+	}
+
+	const u32 class_index = static_cast<u32>(found - std::begin(s_size_classes));
+	const u32 csize = *found;
+
+	auto& partial = m_partial[class_index];
+
+	const u32 slab_addr = partial.empty() ? alloc_slab(class_index) : partial.back();
+
+	if (!slab_addr)
+	{
+		return 0;
+	}
+
+	auto& slab = m_slabs.at(slab_addr);
+
+	u32 index;
+
+	if (!slab.free_list.empty())
+	{
+		index = slab.free_list.back();
+		slab.free_list.pop_back();
+	}
+	else
+	{
+		index = slab.bump++;
+	}
+
+	slab.allocated.set(index);
+
+	if (++slab.used == slab_size / csize)
+	{
+		partial.pop_back();
+	}
+
+	m_small_bytes += csize;
+	m_peak_bytes = std::max(m_peak_bytes, m_small_bytes + m_large_bytes);
+	return slab_addr + index * csize;
+}
+
+error_code sys_heap_allocator::free(u32 addr)
+{
+	if (!addr)
+	{
+		// Freeing a null pointer is a no-op
+		return CELL_OK;
+	}
+
+	std::lock_guard lock(m_mutex);
+
+	if (const auto found = m_slabs.find(addr & ~(slab_size - 1)); found != m_slabs.end())
+	{
+		auto& slab = found->second;
+		const u32 csize = s_size_classes[slab.class_index];
+		const u32 offset = addr - found->first;
+		const u32 index = offset / csize;
+
+		if (offset % csize || index >= slab.bump || !slab.allocated.test(index))
+		{
+			// Not a chunk start, never handed out or already freed
+			return CELL_EINVAL;
+		}
+
+		slab.allocated.reset(index);
+
+		auto& partial = m_partial[slab.class_index];
+
+		if (slab.used-- == slab_size / csize)
+		{
+			partial.push_back(found->first);
+		}
+
+		m_small_bytes -= csize;
+		m_free_count++;
+
+		if (slab.used == 0 && partial.size() > 1)
+		{
+			// Return the empty slab, one is kept per size class to avoid thrashing
+			partial.erase(std::find(partial.begin(), partial.end(), found->first));
+			m_free_slabs.push_back(found->first);
+			m_slabs.erase(found);
+			return CELL_OK;
+		}
+
+		slab.free_list.push_back(static_cast<u16>(index));
+		return CELL_OK;
+	}
+
+	if (const auto found = m_large.find(addr); found != m_large.end())
+	{
+		vm::dealloc(addr, vm::main);
+		m_large_bytes -= found->second;
+		m_large.erase(found);
+		m_free_count++;
+		return CELL_OK;
+	}
+
+	return CELL_EINVAL;
+}
+
+void sys_heap_allocator::get_mallinfo(sys_heap_mallinfo_t& info)
+{
+	std::lock_guard lock(m_mutex);
+
+	u32 free_chunks = 0;
+	u32 slab_bytes = 0;
+
+	for (const auto& [addr, slab] : m_slabs)
+	{
+		free_chunks += slab_size / s_size_classes[slab.class_index] - slab.used;
+		slab_bytes += slab_size;
+	}
+
+	const u32 unused_bytes = ::size32(m_free_slabs) * slab_size;
+
+	info.arena = m_arena_bytes + m_large_bytes;
+	info.ordblks = ::size32(m_large);
+	info.smblks = free_chunks;
+	info.hblks = ::size32(m_arenas) + ::size32(m_large);
+	info.hblkhd = m_large_bytes;
+	info.usmblks = m_peak_bytes;
+	info.fsmblks = slab_bytes - m_small_bytes;
+	info.uordblks = m_small_bytes + m_large_bytes;
+	info.fordblks = m_arena_bytes - m_small_bytes;
+	info.keepcost = unused_bytes;
+}
+
+u32 sys_heap_allocator::get_total_free_size()
+{
+	std::lock_guard lock(m_mutex);
+
+	return m_arena_bytes - m_small_bytes;
+}
+
+void sys_heap_allocator::log_stats()
+{
+	sys_heap_mallinfo_t info;
+	get_mallinfo(info);
+
+	sysPrxForUser.notice("Heap '%s': mapped=0x%x (%u mappings), allocated=0x%x (peak 0x%x), large=0x%x (%u), free small=0x%x (%u chunks), unused slabs=0x%x, %u allocs, %u frees",
+		name, info.arena, info.hblks, info.uordblks, info.usmblks, info.hblkhd, info.ordblks, info.fsmblks, info.smblks, info.keepcost, m_alloc_count, m_free_count);
+}
+
 struct HeapInfo
 {
 	static const u32 id_base = 1;
 	static const u32 id_step = 1;
 	static const u32 id_count = 1023;
 
-	const std::string name;
+	sys_heap_allocator heap;
 
 	HeapInfo(const char* name)
-		: name(name)
+		: heap(name)
 	{
 	}
 };
 
+// Heap used by _sys_malloc and friends
+struct sys_heap_default
+{
+	sys_heap_allocator heap;
+};
+
+sys_heap_allocator& sys_heap_get_default()
+{
+	return g_fxo->get<sys_heap_default>()->heap;
+}
+
 u32 _sys_heap_create_heap(vm::cptr<char> name, u32 arg2, u32 arg3, u32 arg4)
 {
 	sysPrxForUser.warning("_sys_heap_create_heap(name=%s, arg2=0x%x, arg3=0x%x, arg4=0x%x)", name, arg2, arg3, arg4);
@@ -40,21 +306,42 @@ u32 _sys_heap_malloc(u32 heap, u32 size)
 {
 	sysPrxForUser.warning("_sys_heap_malloc(heap=0x%x, size=0x%x)", heap, size);
 
-	return vm::alloc(size, vm::main);
+	if (const auto info = idm::get<HeapInfo>(heap))
+	{
+		return info->heap.alloc(size);
+	}
+
+	return sys_heap_get_default().alloc(size);
 }
 
 u32 _sys_heap_memalign(u32 heap, u32 align, u32 size)
 {
 	sysPrxForUser.warning("_sys_heap_memalign(heap=0x%x, align=0x%x, size=0x%x)", heap, align, size);
 
-	return vm::alloc(size, vm::main, std::max<u32>(align, 0x10000));
+	if (align & (align - 1))
+	{
+		return 0;
+	}
+
+	if (const auto info = idm::get<HeapInfo>(heap))
+	{
+		return info->heap.alloc(size, align);
+	}
+
+	return sys_heap_get_default().alloc(size, align);
 }
 
 error_code _sys_heap_free(u32 heap, u32 addr)
 {
 	sysPrxForUser.warning("_sys_heap_free(heap=0x%x, addr=0x%x)", heap, addr);
 
-	vm::dealloc(addr, vm::main);
+	const auto info = idm::get<HeapInfo>(heap);
+
+	if (const error_code err = (info ? info->heap : sys_heap_get_default()).free(addr))
+	{
+		sysPrxForUser.error("_sys_heap_free(heap=0x%x): invalid address 0x%x", heap, addr);
+		return err;
+	}
 
 	return CELL_OK;
 }
@@ -65,21 +352,45 @@ error_code _sys_heap_alloc_heap_memory()
 	return CELL_OK;
 }
 
-error_code _sys_heap_get_mallinfo()
+error_code _sys_heap_get_mallinfo(u32 heap, vm::ptr<sys_heap_mallinfo_t> info)
 {
-	sysPrxForUser.todo("_sys_heap_get_mallinfo()");
+	sysPrxForUser.warning("_sys_heap_get_mallinfo(heap=0x%x, info=*0x%x)", heap, info);
+
+	const auto hinfo = idm::get<HeapInfo>(heap);
+
+	if (!hinfo || !info)
+	{
+		return CELL_EINVAL;
+	}
+
+	hinfo->heap.get_mallinfo(*info);
 	return CELL_OK;
 }
 
-error_code _sys_heap_get_total_free_size()
+u32 _sys_heap_get_total_free_size(u32 heap)
 {
-	sysPrxForUser.todo("_sys_heap_get_total_free_size()");
-	return CELL_OK;
+	sysPrxForUser.warning("_sys_heap_get_total_free_size(heap=0x%x)", heap);
+
+	if (const auto info = idm::get<HeapInfo>(heap))
+	{
+		return info->heap.get_total_free_size();
+	}
+
+	return 0;
 }
 
-error_code _sys_heap_stats()
+error_code _sys_heap_stats(u32 heap)
 {
-	sysPrxForUser.todo("_sys_heap_stats()");
+	sysPrxForUser.warning("_sys_heap_stats(heap=0x%x)", heap);
+
+	const auto info = idm::get<HeapInfo>(heap);
+
+	if (!info)
+	{
+		return CELL_EINVAL;
+	}
+
+	info->heap.log_stats();
 	return CELL_OK;
 }
 
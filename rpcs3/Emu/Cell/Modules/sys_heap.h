@@ -0,0 +1,102 @@
+#pragma once
+
+#include "util/types.hpp"
+#include "util/endian.hpp"
+#include "Utilities/mutex.h"
+#include "Emu/Cell/ErrorCodes.h"
+
+#include <bitset>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct sys_heap_mallinfo_t
+{
+	be_t<u32> arena;    // Mapped guest memory
+	be_t<u32> ordblks;  // Number of large allocations
+	be_t<u32> smblks;   // Number of free small chunks
+	be_t<u32> hblks;    // Number of mappings
+	be_t<u32> hblkhd;   // Bytes in large allocations
+	be_t<u32> usmblks;  // Peak of allocated bytes
+	be_t<u32> fsmblks;  // Bytes in free small chunks
+	be_t<u32> uordblks; // Allocated bytes
+	be_t<u32> fordblks; // Free bytes in the mappings
+	be_t<u32> keepcost; // Bytes in unused slabs
+};
+
+// Guest heap carving allocations out of a few large mappings of the main memory area.
+// Small sizes are served from 64 KiB slabs dedicated to a size class, larger allocations are mapped directly.
+class sys_heap_allocator
+{
+public:
+	static constexpr u32 slab_size = 0x10000;
+
+	static constexpr u32 arena_size = 0x100000;
+
+	// Largest size served from slabs
+	static constexpr u32 max_small_size = 0x4000;
+
+	explicit sys_heap_allocator(std::string name = "_sys_malloc");
+
+	sys_heap_allocator(const sys_heap_allocator&) = delete;
+
+	sys_heap_allocator& operator=(const sys_heap_allocator&) = delete;
+
+	~sys_heap_allocator();
+
+	// Returns 0 on failure, align must be a power of 2
+	u32 alloc(u32 size, u32 align = 16);
+
+	// Returns CELL_EINVAL if the address isn't an allocation of the heap (including double free), freeing 0 does nothing
+	error_code free(u32 addr);
+
+	void get_mallinfo(sys_heap_mallinfo_t& info);
+
+	u32 get_total_free_size();
+
+	void log_stats();
+
+	const std::string name;
+
+private:
+	struct slab_t
+	{
+		u32 class_index;
+		u32 used = 0;
+		u32 bump = 0; // Number of chunks ever handed out, the rest was never touched
+		std::vector<u16> free_list;
+		std::bitset<slab_size / 16> allocated; // Chunks currently handed out
+	};
+
+	u32 alloc_slab(u32 class_index);
+
+	shared_mutex m_mutex;
+
+	// Slabs in use by their address
+	std::unordered_map<u32, slab_t> m_slabs;
+
+	// Slabs with free chunks per size class
+	std::vector<std::vector<u32>> m_partial;
+
+	// Unused slabs inside of the mappings
+	std::vector<u32> m_free_slabs;
+
+	// Mappings holding the slabs
+	std::vector<u32> m_arenas;
+	u32 m_arena_bytes = 0;
+
+	// Directly mapped allocations (address -> size)
+	std::unordered_map<u32, u32> m_large;
+	u32 m_large_bytes = 0;
+
+	// Bytes allocated from slabs (rounded to the size class)
+	u32 m_small_bytes = 0;
+	u32 m_peak_bytes = 0;
+
+	// Counters
+	u64 m_alloc_count = 0;
+	u64 m_free_count = 0;
+};
+
+// Heap used by _sys_malloc, _sys_memalign and _sys_free
+sys_heap_allocator& sys_heap_get_default();
@@ -2,6 +2,7 @@
 #include "Emu/Cell/lv2/sys_tty.h"
 #include "Emu/Cell/PPUModule.h"
 #include "Utilities/cfmt.h"
+#include "sys_heap.h"
 #include <string.h>
 #include <ctype.h>
 
@@ -373,21 +374,30 @@ u32 _sys_malloc(u32 size)
 {
 	sysPrxForUser.warning("_sys_malloc(size=0x%x)", size);
 
-	return vm::alloc(size, vm::main);
+	return sys_heap_get_default().alloc(size);
 }
 
 u32 _sys_memalign(u32 align, u32 size)
 {
 	sysPrxForUser.warning("_sys_memalign(align=0x%x, size=0x%x)", align, size);
 
-	return vm::alloc(size, vm::main, std::max<u32>(align, 0x10000));
+	if (align & (align - 1))
+	{
+		return 0;
+	}
+
+	return sys_heap_get_default().alloc(size, align);
 }
 
 error_code _sys_free(u32 addr)
 {
 	sysPrxForUser.warning("_sys_free(addr=0x%x)", addr);
 
-	vm::dealloc(addr, vm::main);
+	if (const error_code err = sys_heap_get_default().free(addr))
+	{
+		sysPrxForUser.error("_sys_free(): invalid address 0x%x", addr);
+		return err;
+	}
 
 	return CELL_OK;
 }
@@ -37,6 +37,14 @@ struct ppu_function
 	std::string name; // Function name
 };
 
+// PPU function symbol (used by the profiler)
+struct ppu_symbol
+{
+	u32 size = 0; // Zero if unknown
+	std::string name;
+	std::string module;
+};
+
 // PPU Relocation Information
 struct ppu_reloc
 {
@@ -0,0 +1,212 @@
+#include "stdafx.h"
+#include "PPUBaselineRecompiler.h"
+
+#include "Emu/Memory/vm.h"
+#include "PPUThread.h"
+#include "PPUAnalyser.h"
+
+#include <mutex>
+
+const ppu_decoder<ppu_itype> s_ppu_itype;
+
+// Longest block, in instructions
+constexpr u32 s_max_block_size = 256;
+
+ppu_baseline_recompiler::~ppu_baseline_recompiler()
+{
+	if (m_block_count)
+	{
+		ppu_log.notice("PPU Baseline: compiled %u blocks (%u instructions, %u inlined)", m_block_count, m_inst_count, m_inline_count);
+	}
+}
+
+ppu_baseline_recompiler::block_t ppu_baseline_recompiler::get(u32 addr, const table_t& table)
+{
+	{
+		reader_lock lock(m_mutex);
+
+		// Validate the contents (code may be rewritten by reference patching or by the game itself)
+		if (const auto found = m_blocks.find(addr); found != m_blocks.end() &&
+			std::memcmp(found->second.code.data(), vm::base(addr), found->second.code.size() * 4) == 0)
+		{
+			return found->second.func;
+		}
+	}
+
+	std::vector<be_t<u32>> code;
+	const block_t block = compile(addr, table, code);
+
+	std::lock_guard lock(m_mutex);
+
+	// Another thread may have compiled the same block, the latest one replaces it
+	m_blocks.insert_or_assign(addr, block_info{block, std::move(code)});
+	return block;
+}
+
+void ppu_baseline_recompiler::invalidate(u32 addr, u32 size)
+{
+	std::lock_guard lock(m_mutex);
+
+	for (auto it = m_blocks.begin(); it != m_blocks.end();)
+	{
+		if (it->first - addr < size)
+		{
+			it = m_blocks.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+
+ppu_baseline_recompiler::block_t ppu_baseline_recompiler::compile(u32 addr, const table_t& table, std::vector<be_t<u32>>& insts)
+{
+	using namespace asmjit;
+
+	const auto gpr = [](u32 reg)
+	{
+		return x86::qword_ptr(x86::rbp, ::offset32(&ppu_thread::gpr) + reg * 8);
+	};
+
+	const auto cia = x86::dword_ptr(x86::rbp, ::offset32(&ppu_thread::cia));
+
+#ifdef _WIN32
+	const X86Gp arg0 = x86::rcx;
+	const X86Gp arg1 = x86::edx;
+#else
+	const X86Gp arg0 = x86::rdi;
+	const X86Gp arg1 = x86::esi;
+#endif
+
+	CodeHolder code;
+	code.init(m_asmrt.getCodeInfo());
+	code._globalHints = asmjit::CodeEmitter::kHintOptimizedAlign;
+
+	X86Assembler c(&code);
+
+	Label label_exit = c.newLabel();
+
+	// Keep ppu_thread pointer in a callee-saved register, the stack is aligned and has shadow space for calls
+	c.push(x86::rbp);
+	c.sub(x86::rsp, 0x20);
+	c.mov(x86::rbp, arg0);
+
+	u32 pos = addr;
+	u32 size = 0;
+	u32 inlined = 0;
+
+	for (; size < s_max_block_size; size++, pos += 4)
+	{
+		if (pos != addr && pos % 4096 == 0 && !vm::check_addr(pos, vm::page_executable))
+		{
+			break;
+		}
+
+		const u32 op = vm::read32(pos);
+		const ppu_opcode_t _op{op};
+
+		// Invalid instructions are recorded as well, the block is rebuilt if they are patched
+		insts.emplace_back(op);
+		const auto type = s_ppu_itype.decode(op);
+
+		if (type == ppu_itype::UNK)
+		{
+			// Leave invalid instructions to the interpreter
+			break;
+		}
+
+		switch (type)
+		{
+		case ppu_itype::ADDI:
+		case ppu_itype::ADDIS:
+		{
+			const s32 imm = type == ppu_itype::ADDI ? _op.simm16 : _op.simm16 * 65536;
+
+			if (_op.ra)
+			{
+				c.mov(x86::rax, gpr(_op.ra));
+				c.add(x86::rax, imm);
+			}
+			else
+			{
+				c.mov(x86::rax, imm);
+			}
+
+			c.mov(gpr(_op.rd), x86::rax);
+			inlined++;
+			continue;
+		}
+		case ppu_itype::ORI:
+		case ppu_itype::ORIS:
+		case ppu_itype::XORI:
+		case ppu_itype::XORIS:
+		{
+			const u32 imm = (type == ppu_itype::ORI || type == ppu_itype::XORI) ? _op.uimm16 : _op.uimm16 << 16;
+
+			// 32-bit move zero-extends the immediate
+			c.mov(x86::rax, gpr(_op.rs));
+			c.mov(x86::ecx, imm);
+
+			if (type == ppu_itype::ORI || type == ppu_itype::ORIS)
+				c.or_(x86::rax, x86::rcx);
+			else
+				c.xor_(x86::rax, x86::rcx);
+
+			c.mov(gpr(_op.ra), x86::rax);
+			inlined++;
+			continue;
+		}
+		default:
+		{
+			break;
+		}
+		}
+
+		// Call the interpreter function, it may read the current address and returns false if it changed it
+		c.mov(cia, pos);
+		c.mov(arg0, x86::rbp);
+		c.mov(arg1, op);
+		c.call(imm_ptr(table[ppu_decode(op)]));
+		c.test(x86::al, x86::al);
+		c.jz(label_exit);
+
+		if (type == ppu_itype::B || type == ppu_itype::BC || type == ppu_itype::BCLR || type == ppu_itype::BCCTR ||
+			type == ppu_itype::SC || type == ppu_itype::TD || type == ppu_itype::TW || type == ppu_itype::TDI || type == ppu_itype::TWI)
+		{
+			// Branch not taken, end of the block
+			size++, pos += 4;
+			break;
+		}
+	}
+
+	if (!size)
+	{
+		return nullptr;
+	}
+
+	c.mov(cia, pos);
+	c.bind(label_exit);
+	c.add(x86::rsp, 0x20);
+	c.pop(x86::rbp);
+	c.ret();
+
+	block_t fn;
+
+	if (auto err = m_asmrt.add(&fn, &code))
+	{
+		if (err == asmjit::ErrorCode::kErrorNoVirtualMemory)
+		{
+			return nullptr;
+		}
+
+		ppu_log.fatal("PPU Baseline: failed to build a block at 0x%x", addr);
+		return nullptr;
+	}
+
+	std::lock_guard lock(m_mutex);
+	m_block_count++;
+	m_inst_count += size;
+	m_inline_count += inlined;
+	return fn;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Utilities/JIT.h"
+#include "Utilities/mutex.h"
+#include "PPUInterpreter.h"
+
+#include <unordered_map>
+#include <vector>
+
+// PPU baseline recompiler, the fast tier used for code not covered by LLVM objects, including all code while they are built at boot.
+// Basic blocks are translated into sequences of interpreter calls with the decoding done at compile time,
+// a few trivial integer instructions are emitted inline. Compilation of a block takes microseconds.
+class ppu_baseline_recompiler
+{
+public:
+	using block_t = void(*)(ppu_thread&);
+
+	using table_t = std::array<ppu_inter_func_t, 0x20000>;
+
+	ppu_baseline_recompiler() = default;
+
+	ppu_baseline_recompiler(const ppu_baseline_recompiler&) = delete;
+
+	ppu_baseline_recompiler& operator=(const ppu_baseline_recompiler&) = delete;
+
+	~ppu_baseline_recompiler();
+
+	// Get the block starting at addr, compile it if necessary or if its code was modified. Returns nullptr if the first instruction must be interpreted.
+	// The block updates ppu.cia before returning.
+	block_t get(u32 addr, const table_t& table);
+
+	// Forget the blocks starting in the range (the code is not freed, it may still be executing)
+	void invalidate(u32 addr, u32 size);
+
+private:
+	struct block_info
+	{
+		block_t func;
+
+		// Instructions the block was compiled from, checked before each use (code may be patched in place)
+		std::vector<be_t<u32>> code;
+	};
+
+	block_t compile(u32 addr, const table_t& table, std::vector<be_t<u32>>& insts);
+
+	// ASMJIT runtime
+	::jit_runtime m_asmrt;
+
+	shared_mutex m_mutex;
+
+	std::unordered_map<u32, block_info> m_blocks;
+
+	// Statistics
+	u32 m_block_count = 0;
+	u64 m_inst_count = 0;
+	u64 m_inline_count = 0;
+};
@@ -122,11 +122,16 @@ struct ppu_linkage_info
 
 	// Module map
 	std::unordered_map<std::string, module_data> modules;
+
+	// Protects the module map from the readers outside of the loader (profiler)
+	shared_mutex mutex;
 };
 
 // Initialize static modules.
 static void ppu_initialize_modules(ppu_linkage_info* link)
 {
+	std::lock_guard lock(link->mutex);
+
 	if (!link->modules.empty())
 	{
 		return;
@@ -426,6 +431,91 @@ static void ppu_patch_refs(std::vector<ppu_reloc>* out_relocs, u32 fref, u32 fad
 	}
 }
 
+// Collect names of all known PPU functions: entry address -> symbol
+std::map<u32, ppu_symbol> ppu_get_symbols()
+{
+	std::map<u32, ppu_symbol> result;
+
+	const auto add_module = [&](const ppu_module& _module)
+	{
+		for (const auto& func : _module.funcs)
+		{
+			auto& sym = result[func.addr];
+			sym.size = func.size;
+			sym.name = func.name.empty() ? fmt::format("sub_%x", func.addr) : func.name;
+			sym.module = _module.name;
+		}
+	};
+
+	if (const auto _main = g_fxo->get<ppu_module>())
+	{
+		add_module(*_main);
+	}
+
+	idm::select<lv2_obj, lv2_prx>([&](u32, lv2_prx& prx)
+	{
+		add_module(prx);
+	});
+
+	// HLE functions (CIA points to the second word of the entry)
+	for (u32 index = 0; index < g_ppu_function_names.size(); index++)
+	{
+		if (const u32 addr = ppu_function_manager::func_addr(index))
+		{
+			result[addr] = {8, g_ppu_function_names[index], "HLE"};
+		}
+	}
+
+	// Exported LLE functions override the names found by the analyser
+	if (const auto link = g_fxo->get<ppu_linkage_info>())
+	{
+		// Snapshot of the exports (module name, FNID, export address)
+		std::vector<std::tuple<std::string, u32, u32>> exports;
+
+		{
+			reader_lock lock(link->mutex);
+
+			for (const auto& [module_name, mdata] : link->modules)
+			{
+				for (const auto& [fnid, flink] : mdata.functions)
+				{
+					// Export address points to the function descriptor
+					const u32 opd = flink.export_addr;
+
+					if (!opd || (flink.static_func && opd == ppu_function_manager::func_addr(flink.static_func->index)))
+					{
+						continue;
+					}
+
+					exports.emplace_back(module_name, fnid, opd);
+				}
+			}
+		}
+
+		for (const auto& [module_name, fnid, opd] : exports)
+		{
+			if (!vm::check_addr(opd))
+			{
+				continue;
+			}
+
+			const u32 addr = vm::read32(opd);
+
+			if (addr == opd + 4)
+			{
+				// Forced HLE function
+				continue;
+			}
+
+			auto& sym = result[addr];
+			sym.name = ppu_get_function_name(module_name, fnid);
+			sym.module = module_name;
+		}
+	}
+
+	return result;
+}
+
 // Export or import module struct
 struct ppu_prx_module_info
 {
@@ -453,6 +543,8 @@ static auto ppu_load_exports(ppu_linkage_info* link, u32 exports_start, u32 expo
 {
 	std::unordered_map<u32, u32> result;
 
+	std::lock_guard lock(link->mutex);
+
 	for (u32 addr = exports_start; addr < exports_end;)
 	{
 		const auto& lib = vm::_ref<const ppu_prx_module_info>(addr);
@@ -613,6 +705,8 @@ static auto ppu_load_imports(std::vector<ppu_reloc>& relocs, ppu_linkage_info* l
 {
 	std::unordered_map<u32, void*> result;
 
+	std::lock_guard lock(link->mutex);
+
 	for (u32 addr = imports_start; addr < imports_end;)
 	{
 		const auto& lib = vm::_ref<const ppu_prx_module_info>(addr);
@@ -1108,6 +1202,13 @@ std::shared_ptr<lv2_prx> ppu_load_prx(const ppu_prx_object& elf, const std::stri
 
 void ppu_unload_prx(const lv2_prx& prx)
 {
+	std::unique_lock lock(g_fxo->get<ppu_linkage_info>()->mutex, std::defer_lock);
+
+	if (!prx.imports.empty())
+	{
+		lock.lock();
+	}
+
 	// Clean linkage info
 	for (auto& imp : prx.imports)
 	{
@@ -1310,11 +1411,7 @@ bool ppu_load_exec(const ppu_exec_object& elf)
 	{
 		auto shle = g_fxo->init<statichle_handler>(0);
 
-		for (u32 i = _main->segs[0].addr; i < (_main->segs[0].addr + _main->segs[0].size); i += 4)
-		{
-			vm::cptr<u8> _ptr = vm::cast(i);
-			shle->check_against_patterns(_ptr, (_main->segs[0].addr + _main->segs[0].size) - i, i);
-		}
+		shle->scan(_main->segs[0].addr, _main->segs[0].size);
 	}
 
 	// Read control flags (0 if doesn't exist)
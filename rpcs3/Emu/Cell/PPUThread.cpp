@@ -12,6 +12,7 @@
 #include "Emu/VFS.h"
 #include "PPUThread.h"
 #include "PPUInterpreter.h"
+#include "PPUBaselineRecompiler.h"
 #include "PPUAnalyser.h"
 #include "PPUModule.h"
 #include "PPUDisAsm.h"
@@ -295,12 +296,20 @@ void ppu_recompiler_fallback(ppu_thread& ppu)
 
 	const auto& table = g_ppu_interpreter_fast.get_table();
 
+	// Breakpoints are not checked inside of compiled blocks
+	const auto baseline = g_cfg.core.ppu_baseline_jit && !g_cfg.core.ppu_debug ? g_fxo->get<ppu_baseline_recompiler>() : nullptr;
+
 	u64 ctr = 0;
 
 	while (true)
 	{
+		if (const auto block = baseline ? baseline->get(ppu.cia, table) : nullptr)
+		{
+			// Run compiled block, it stops at branches
+			ctr++, block(ppu);
+		}
 		// Run instructions in interpreter
-		if (const u32 op = vm::read32(ppu.cia); ctr++, table[ppu_decode(op)](ppu, {op})) [[likely]]
+		else if (const u32 op = vm::read32(ppu.cia); ctr++, table[ppu_decode(op)](ppu, {op})) [[likely]]
 		{
 			ppu.cia += 4;
 			continue;
@@ -393,6 +402,12 @@ extern void ppu_register_range(u32 addr, u32 size)
 	const u64 fallback = reinterpret_cast<uptr>(ppu_fallback);
 	const u64 seg_base = addr;
 
+	if (const auto baseline = g_fxo->get<ppu_baseline_recompiler>(); baseline && g_cfg.core.ppu_baseline_jit)
+	{
+		// Code may be loaded over a previously executed range
+		baseline->invalidate(addr, size);
+	}
+
 	size &= ~3; // Loop assumes `size = n * 4`, enforce that by rounding down
 
 	while (size)
@@ -2498,6 +2513,46 @@ extern void ppu_precompile(std::vector<std::string>& dir_queue, std::vector<lv2_
 	g_ps3_process_info.ppc_seg = ppc_seg;
 }
 
+// Set on the thread building the LLVM objects in the background, it installs the functions like a PPU thread would
+static thread_local bool s_tls_ppu_async_init = false;
+
+#ifdef LLVM_AVAILABLE
+// Functions can only be installed from a PPU thread or from the background build
+static bool ppu_can_install()
+{
+	return get_current_cpu_thread() || s_tls_ppu_async_init;
+}
+#endif
+
+// Initialize the main module and the preloaded libraries
+static void ppu_initialize_loaded(const std::vector<std::pair<u32, std::shared_ptr<lv2_prx>>>& prx_list)
+{
+	const auto _main = g_fxo->get<ppu_module>();
+
+	// Initialize main module cache
+	if (!_main->segs.empty())
+	{
+		ppu_initialize(*_main);
+	}
+
+	// Initialize preloaded libraries
+	for (const auto& [id, prx] : prx_list)
+	{
+		if (Emu.IsStopped())
+		{
+			return;
+		}
+
+		if (idm::check<lv2_obj, lv2_prx>(id) != prx.get())
+		{
+			// Unloaded meanwhile, its range may already be reused
+			continue;
+		}
+
+		ppu_initialize(*prx);
+	}
+}
+
 extern void ppu_initialize()
 {
 	const auto _main = g_fxo->get<ppu_module>();
@@ -2512,6 +2567,38 @@ extern void ppu_initialize()
 		return;
 	}
 
+	// Keep the libraries alive, they may be unloaded while the objects are built in the background
+	std::vector<std::pair<u32, std::shared_ptr<lv2_prx>>> prx_refs;
+
+	idm::select<lv2_obj, lv2_prx>([&](u32 id, lv2_prx&)
+	{
+		if (auto prx = idm::get<lv2_obj, lv2_prx>(id))
+		{
+			prx_refs.emplace_back(id, std::move(prx));
+		}
+	});
+
+	if (g_cfg.core.ppu_decoder == ppu_decoder_type::llvm && g_cfg.core.ppu_baseline_jit && !g_cfg.core.ppu_debug)
+	{
+		// Start executing right away: until a function is installed, its entry in ppu_ref() points to
+		// ppu_recompiler_fallback which runs the baseline tier, and which leaves as soon as the entry is replaced.
+		// Firmware and game directories are not precompiled, it loads every module into guest memory which is
+		// only safe before the game runs. Libraries loaded later are compiled when they are loaded.
+		g_fxo->init<named_thread>("PPU Loader"sv, [prx_refs = std::move(prx_refs)]
+		{
+			s_tls_ppu_async_init = true;
+
+			ppu_initialize_loaded(prx_refs);
+
+			if (!Emu.IsStopped())
+			{
+				ppu_log.success("LLVM: Background build finished, compiled functions are installed");
+			}
+		});
+
+		return;
+	}
+
 	bool compile_main = false;
 
 	// Check main module cache
@@ -2522,10 +2609,10 @@ extern void ppu_initialize()
 
 	std::vector<lv2_prx*> prx_list;
 
-	idm::select<lv2_obj, lv2_prx>([&](u32, lv2_prx& prx)
+	for (const auto& prx : prx_refs)
 	{
-		prx_list.emplace_back(&prx);
-	});
+		prx_list.emplace_back(prx.second.get());
+	}
 
 	// If empty we have no indication for cache state, check everything
 	bool compile_fw = prx_list.empty();
@@ -2559,22 +2646,7 @@ extern void ppu_initialize()
 		return;
 	}
 
-	// Initialize main module cache
-	if (!_main->segs.empty())
-	{
-		ppu_initialize(*_main);
-	}
-
-	// Initialize preloaded libraries
-	for (auto ptr : prx_list)
-	{
-		if (Emu.IsStopped())
-		{
-			return;
-		}
-
-		ppu_initialize(*ptr);
-	}
+	ppu_initialize_loaded(prx_refs);
 }
 
 bool ppu_initialize(const ppu_module& info, bool check_only)
@@ -2719,7 +2791,7 @@ bool ppu_initialize(const ppu_module& info, bool check_only)
 	while (!jit_mod.init && fpos < info.funcs.size())
 	{
 		// Initialize compiler instance
-		if (!jit && get_current_cpu_thread())
+		if (!jit && ppu_can_install())
 		{
 			jit = std::make_shared<jit_compiler>(s_link_table, g_cfg.core.llvm_cpu);
 		}
@@ -2993,7 +3065,7 @@ bool ppu_initialize(const ppu_module& info, bool check_only)
 
 		g_watchdog_hold_ctr--;
 
-		if (Emu.IsStopped() || !get_current_cpu_thread())
+		if (Emu.IsStopped() || !ppu_can_install())
 		{
 			return compiled_new;
 		}
@@ -3014,7 +3086,7 @@ bool ppu_initialize(const ppu_module& info, bool check_only)
 		}
 	}
 
-	if (Emu.IsStopped() || !get_current_cpu_thread())
+	if (Emu.IsStopped() || !ppu_can_install())
 	{
 		return compiled_new;
 	}
@@ -30,12 +30,13 @@ const spu_decoder<spu_recompiler> s_spu_decoder;
 
 extern u64 get_timebased_time();
 
-std::unique_ptr<spu_recompiler_base> spu_recompiler_base::make_asmjit_recompiler()
+std::unique_ptr<spu_recompiler_base> spu_recompiler_base::make_asmjit_recompiler(bool tier)
 {
-	return std::make_unique<spu_recompiler>();
+	return std::make_unique<spu_recompiler>(tier);
 }
 
-spu_recompiler::spu_recompiler()
+spu_recompiler::spu_recompiler(bool tier)
+	: m_tier(tier)
 {
 }
 
@@ -59,7 +60,15 @@ spu_function_t spu_recompiler::compile(spu_program&& _func)
 		return nullptr;
 	}
 
-	if (add_loc->compiled)
+	// Function to replace (intermediate tier), must be an unpatched spu_fast function
+	const spu_function_t old_fn = m_tier ? add_loc->compiled.load() : nullptr;
+
+	if (m_tier && (!old_fn || add_loc->intermediate || atomic_storage<u64>::load(*reinterpret_cast<const u64*>(old_fn)) != 0x841f0f))
+	{
+		return nullptr;
+	}
+
+	if (add_loc->compiled && !m_tier)
 	{
 		return add_loc->compiled;
 	}
@@ -186,6 +195,12 @@ spu_function_t spu_recompiler::compile(spu_program&& _func)
 		}
 	}
 
+	if (m_tier)
+	{
+		// 8-byte instruction for patching (long NOP), replaced with a jump to LLVM code later
+		c->dq(0x841f0f);
+	}
+
 	// Load actual PC and check status
 	c->sub(x86::rsp, 0x28);
 	c->mov(pc0->r32(), SPU_OFF_32(pc));
@@ -907,8 +922,21 @@ spu_function_t spu_recompiler::compile(spu_program&& _func)
 		spu_log.fatal("Failed to build a function");
 	}
 
+	if (m_tier)
+	{
+		// Publish before installing, so the LLVM worker patches it if it replaces the function in between
+		add_loc->intermediate = fn;
+	}
+
 	// Install compiled function pointer
-	const bool added = !add_loc->compiled && add_loc->compiled.compare_and_swap_test(nullptr, fn);
+	bool added = m_tier ? add_loc->compiled.compare_and_swap_test(old_fn, fn) : !add_loc->compiled && add_loc->compiled.compare_and_swap_test(nullptr, fn);
+
+	if (m_tier && added && atomic_storage<u64>::load(*reinterpret_cast<const u64*>(old_fn)) != 0x841f0f)
+	{
+		// LLVM worker patched the old function before it could see the new one, restore it (it jumps to LLVM code now)
+		add_loc->compiled.compare_and_swap_test(fn, old_fn);
+		added = false;
+	}
 
 	// Rebuild trampoline if necessary
 	if (!m_spurt->rebuild_ubertrampoline(func.data[0]))
@@ -932,6 +960,12 @@ spu_function_t spu_recompiler::compile(spu_program&& _func)
 		fs::file(m_spurt->get_cache_path() + "spu-ir.log", fs::write + fs::append).write(log);
 	}
 
+	if (m_tier && !added)
+	{
+		// Already replaced by LLVM
+		return nullptr;
+	}
+
 	return fn;
 }
 
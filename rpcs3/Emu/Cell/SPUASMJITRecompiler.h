@@ -11,7 +11,7 @@ union v128;
 class spu_recompiler : public spu_recompiler_base
 {
 public:
-	spu_recompiler();
+	explicit spu_recompiler(bool tier = false);
 
 	virtual void init() override;
 
@@ -21,6 +21,9 @@ private:
 	// ASMJIT runtime
 	::jit_runtime m_asmrt;
 
+	// Intermediate tier mode (LLVM decoder): replace the installed spu_fast function instead of reusing it
+	const bool m_tier;
+
 	u32 m_base;
 
 	// emitter:
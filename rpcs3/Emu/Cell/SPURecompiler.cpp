@@ -35,6 +35,8 @@ extern const spu_decoder<spu_interpreter_fast> g_spu_interpreter_fast;
 
 extern u64 get_timebased_time();
 
+extern bool spursKernelNativeSelectWorkload(spu_thread& spu);
+
 // Move 4 args for calling native function from a GHC calling convention function
 static u8* move_args_ghc_to_native(u8* raw)
 {
@@ -359,6 +361,64 @@ void spu_cache::add(const spu_program& func)
 	m_file.write_gather(gather, 3);
 }
 
+std::string spu_cache::get_samples_path()
+{
+	const std::string ppu_cache = Emu.PPUCache();
+
+	if (ppu_cache.empty())
+	{
+		return {};
+	}
+
+	return ppu_cache + "spu-" + fmt::to_lower(g_cfg.core.spu_block_size.to_string()) + "-v1-samples.dat";
+}
+
+std::unordered_map<u64, u64, value_hash<u64>> spu_cache::load_samples(const std::string& path)
+{
+	std::unordered_map<u64, u64, value_hash<u64>> result;
+
+	if (path.empty())
+	{
+		return result;
+	}
+
+	if (fs::file file{path})
+	{
+		// Pairs of hash and number of samples
+		const auto data = file.to_vector<be_t<u64>>();
+
+		for (usz i = 0; i + 1 < data.size(); i += 2)
+		{
+			result.emplace(data[i], data[i + 1]);
+		}
+	}
+
+	return result;
+}
+
+void spu_cache::save_samples(const std::string& path, const std::unordered_map<u64, u64, value_hash<u64>>& samples)
+{
+	if (path.empty())
+	{
+		return;
+	}
+
+	std::vector<be_t<u64>> data;
+	data.reserve(samples.size() * 2);
+
+	// Zero counts are saved as well, they mark the programs which stayed cold
+	for (const auto& [hash, count] : samples)
+	{
+		data.emplace_back(hash);
+		data.emplace_back(count);
+	}
+
+	if (!fs::write_file(path, fs::rewrite, data))
+	{
+		spu_log.error("Failed to save SPU samples to %s (%s)", path, fs::g_tls_error);
+	}
+}
+
 void spu_cache::initialize()
 {
 	spu_runtime::g_interpreter = spu_runtime::g_gateway;
@@ -394,6 +454,44 @@ void spu_cache::initialize()
 	atomic_t<usz> fnext{};
 	atomic_t<u8> fail_flag{0};
 
+	if (g_cfg.core.spu_decoder == spu_decoder_type::llvm)
+	{
+		// Build the programs which were hot in the previous runs first
+		if (const auto samples = load_samples(get_samples_path()); !samples.empty())
+		{
+			std::vector<std::pair<u64, spu_program>> sorted;
+			sorted.reserve(func_list.size());
+
+			for (auto& func : func_list)
+			{
+				sha1_context ctx;
+				u8 output[20];
+
+				sha1_starts(&ctx);
+				sha1_update(&ctx, reinterpret_cast<const u8*>(func.data.data()), func.data.size() * 4);
+				sha1_finish(&ctx, output);
+
+				be_t<u64> hash_start;
+				std::memcpy(&hash_start, output, sizeof(hash_start));
+
+				const auto found = samples.find(hash_start);
+				sorted.emplace_back(found != samples.end() ? found->second : 0, std::move(func));
+			}
+
+			std::stable_sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b)
+			{
+				return a.first > b.first;
+			});
+
+			func_list.clear();
+
+			for (auto& [count, func] : sorted)
+			{
+				func_list.emplace_back(std::move(func));
+			}
+		}
+	}
+
 	if (g_cfg.core.spu_decoder == spu_decoder_type::fast || g_cfg.core.spu_decoder == spu_decoder_type::llvm)
 	{
 		if (auto compiler = spu_recompiler_base::make_llvm_recompiler(11))
@@ -467,6 +565,12 @@ void spu_cache::initialize()
 				continue;
 			}
 
+			if (g_cfg.core.spurs_native_kernel && func.entry_point == 0x290)
+			{
+				// Possibly the workload selection routine of the SPURS kernel, replaced by native code
+				continue;
+			}
+
 			// Get data start
 			const u32 start = func.lower_bound;
 			const u32 size0 = ::size32(func.data);
@@ -586,8 +690,17 @@ bool spu_program::operator<(const spu_program& rhs) const noexcept
 	return lhs_offs < rhs_offs;
 }
 
+// Runtime available to the threads which don't own it (for rebalancing), cleared on destruction
+static shared_mutex s_spurt_mutex;
+static spu_runtime* s_spurt = nullptr;
+
 spu_runtime::spu_runtime()
 {
+	{
+		std::lock_guard lock(s_spurt_mutex);
+		s_spurt = this;
+	}
+
 	// Clear LLVM output
 	m_cache_path = Emu.PPUCache();
 
@@ -636,21 +749,90 @@ spu_item* spu_runtime::add_empty(spu_program&& data)
 	return prev;
 }
 
-spu_function_t spu_runtime::rebuild_ubertrampoline(u32 id_inst)
+spu_runtime::~spu_runtime()
+{
+	{
+		// Wait for the rebalancing in progress
+		std::lock_guard lock(s_spurt_mutex);
+		s_spurt = nullptr;
+	}
+
+	if (m_tr_stats.empty() || m_cache_path.empty())
+	{
+		return;
+	}
+
+	// Sort by the number of calls
+	std::vector<std::pair<u32, const trampoline_stats*>> sorted;
+	sorted.reserve(m_tr_stats.size());
+
+	for (const auto& [id, stats] : m_tr_stats)
+	{
+		sorted.emplace_back(id, &stats);
+	}
+
+	std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b)
+	{
+		return a.second->hits + a.second->misses > b.second->hits + b.second->misses;
+	});
+
+	std::string out = "# id     | functions | rebuilds | hits | misses | max depth | avg depth\n";
+
+	for (const auto& [id, stats] : sorted)
+	{
+		fmt::append(out, "0x%05x | %u | %u | %u | %u | %u | %.2f\n", id, stats->functions, stats->rebuilds, stats->hits.load(), stats->misses.load(), stats->max_depth, stats->avg_depth);
+	}
+
+	const std::string path = m_cache_path + "spu-trampolines.log";
+
+	if (!fs::write_file(path, fs::rewrite, out))
+	{
+		spu_log.error("Failed to write ubertrampoline stats to %s (%s)", path, fs::g_tls_error);
+		return;
+	}
+
+	spu_log.notice("Ubertrampoline stats written to %s (%u trampolines)", path, sorted.size());
+}
+
+spu_function_t spu_runtime::rebuild_ubertrampoline(u32 id_inst, bool rebalance)
 {
 	// Prepare sorted list
 	static thread_local std::vector<std::pair<std::basic_string_view<u32>, spu_function_t>> m_flat_list;
 
+	struct item_info
+	{
+		// Snapshot of spu_item::hits used as the weight
+		u64 hits;
+		spu_item* item;
+
+		// Counting stub (generated on first use)
+		u8* stub;
+	};
+
+	// Additional info for profiling
+	static thread_local std::unordered_map<spu_function_t, item_info> m_items;
+
+	const bool profile = g_cfg.core.spu_prof.get();
+
+	// Trampoline to replace (if rebalancing)
+	const spu_function_t current = rebalance ? g_dispatcher->at(id_inst >> 12).load() : nullptr;
+
+	if (rebalance && current == tr_dispatch)
+	{
+		return current;
+	}
+
 	// Remember top position
 	auto stuff_it = m_stuff.at(id_inst >> 12).begin();
 	auto stuff_end = m_stuff.at(id_inst >> 12).end();
 	{
-		if (stuff_it->trampoline)
+		if (stuff_it->trampoline && !rebalance)
 		{
 			return stuff_it->trampoline;
 		}
 
 		m_flat_list.clear();
+		m_items.clear();
 
 		for (auto it = stuff_it; it != stuff_end; ++it)
 		{
@@ -659,6 +841,11 @@ spu_function_t spu_runtime::rebuild_ubertrampoline(u32 id_inst)
 				std::basic_string_view<u32> range{it->data.data.data(), it->data.data.size()};
 				range.remove_prefix((it->data.entry_point - it->data.lower_bound) / 4);
 				m_flat_list.emplace_back(range, ptr);
+
+				if (profile)
+				{
+					m_items.emplace(ptr, item_info{it->hits.load(), &*it, nullptr});
+				}
 			}
 			else
 			{
@@ -680,6 +867,7 @@ spu_function_t spu_runtime::rebuild_ubertrampoline(u32 id_inst)
 		u32 size;
 		u16 from;
 		u16 level;
+		u16 depth;
 		u8* rel32;
 		decltype(m_flat_list)::iterator beg;
 		decltype(m_flat_list)::iterator end;
@@ -695,10 +883,36 @@ spu_function_t spu_runtime::rebuild_ubertrampoline(u32 id_inst)
 
 	auto result = beg->second;
 
+	// Stats of this bunch (node addresses are stable)
+	trampoline_stats* stats = nullptr;
+
+	if (profile)
+	{
+		std::lock_guard lock(m_tr_mutex);
+		stats = &m_tr_stats[id_inst >> 12];
+	}
+
+	// Total weight of all functions (zero if there is no profile data yet)
+	u64 total_hits = 0;
+
+	for (const auto& [ptr, info] : m_items)
+	{
+		total_hits += info.hits;
+	}
+
+	// Depth info for stats
+	u32 max_depth = 0;
+	f64 sum_depth = 0;
+
 	if (size0 != 1)
 	{
-		// Allocate some writable executable memory
-		u8* const wxptr = jit_runtime::alloc(size0 * 22 + 14, 16);
+		// Code size: search tree (+ entry counter) and counting stubs for leaves
+		const u32 tree_size = size0 * 22 + 14 + (profile ? 14 : 0);
+		const u32 stub_size = profile ? size0 * 19 : 0;
+
+		// Allocate some writable executable memory (dispatchers are always hot)
+		jit_placement_scope placement(jit_placement::hot);
+		u8* const wxptr = jit_runtime::alloc(tree_size + stub_size, 16);
 
 		if (!wxptr)
 		{
@@ -708,10 +922,32 @@ spu_function_t spu_runtime::rebuild_ubertrampoline(u32 id_inst)
 		// Raw assembly pointer
 		u8* raw = wxptr;
 
+		// Counting stubs are placed after the tree
+		u8* stub_raw = wxptr + tree_size;
+
+		// Emit counter increment: mov rax, imm64; lock inc qword [rax] (rax is free here)
+		auto make_counter = [](u8*& raw, atomic_t<u64>* counter)
+		{
+			const u64 addr = reinterpret_cast<u64>(counter);
+			*raw++ = 0x48;
+			*raw++ = 0xb8;
+			std::memcpy(raw, &addr, 8);
+			raw += 8;
+			*raw++ = 0xf0;
+			*raw++ = 0x48;
+			*raw++ = 0xff;
+			*raw++ = 0x00;
+		};
+
+		if (profile)
+		{
+			make_counter(raw, &stats->hits);
+		}
+
 		// Write jump instruction with rel32 immediate
 		auto make_jump = [&](u8 op, auto target)
 		{
-			ensure(raw + 8 <= wxptr + size0 * 22 + 16);
+			ensure(raw + 8 <= wxptr + tree_size + 2);
 
 			// Fallback to dispatch if no target
 			const u64 taddr = target ? reinterpret_cast<u64>(target) : reinterpret_cast<u64>(tr_dispatch);
@@ -736,11 +972,47 @@ spu_function_t spu_runtime::rebuild_ubertrampoline(u32 id_inst)
 			raw += 4;
 		};
 
+		// Write jump to the function found (leaf of the search tree)
+		auto make_leaf = [&](u8 op, spu_function_t target, u32 depth)
+		{
+			const auto found = m_items.find(target);
+
+			if (found == m_items.end())
+			{
+				make_jump(op, target);
+				return;
+			}
+
+			auto& info = found->second;
+
+			max_depth = std::max(max_depth, depth);
+			sum_depth += (info.hits + 1.) * depth;
+
+			if (!info.stub)
+			{
+				// Generate stub counting calls of the function: ...; jmp rel32
+				ensure(stub_raw + 19 <= wxptr + tree_size + stub_size);
+				info.stub = stub_raw;
+				make_counter(stub_raw, &info.item->hits);
+
+				const s64 rel = reinterpret_cast<u64>(target) - reinterpret_cast<u64>(stub_raw) - 5;
+				ensure(rel >= INT32_MIN && rel <= INT32_MAX);
+
+				const s32 r32 = static_cast<s32>(rel);
+				*stub_raw++ = 0xe9;
+				std::memcpy(stub_raw, &r32, 4);
+				stub_raw += 4;
+			}
+
+			make_jump(op, info.stub);
+		};
+
 		workload.clear();
 		workload.reserve(size0);
 		workload.emplace_back();
 		workload.back().size  = size0;
 		workload.back().level = 0;
+		workload.back().depth = 0;
 		workload.back().from  = -1;
 		workload.back().rel32 = 0;
 		workload.back().beg   = beg;
@@ -757,8 +1029,29 @@ spu_function_t spu_runtime::rebuild_ubertrampoline(u32 id_inst)
 			auto it = w.beg;
 			auto it2 = w.beg;
 			u32 size1 = w.size / 2;
+
+			if (total_hits)
+			{
+				// Split at the weighted median so that frequently called functions end up closer to the root
+				u64 total = 0;
+
+				for (auto i = w.beg; i != w.end; i++)
+				{
+					total += m_items.at(i->second).hits + 1;
+				}
+
+				u64 sum = m_items.at(w.beg->second).hits + 1;
+				size1 = 1;
+
+				for (auto i = std::next(w.beg); size1 < w.size - 1 && sum * 2 < total; i++)
+				{
+					sum += m_items.at(i->second).hits + 1;
+					size1++;
+				}
+			}
+
 			u32 size2 = w.size - size1;
-			std::advance(it2, w.size / 2);
+			std::advance(it2, size1);
 
 			while (ensure(w.level < UINT16_MAX))
 			{
@@ -823,7 +1116,7 @@ spu_function_t spu_runtime::rebuild_ubertrampoline(u32 id_inst)
 			{
 				// If functions cannot be compared, assume smallest function
 				spu_log.error("Trampoline simplified at ??? (level=%u)", w.level);
-				make_jump(0xe9, w.beg->second); // jmp rel32
+				make_leaf(0xe9, w.beg->second, w.depth); // jmp rel32
 				continue;
 			}
 
@@ -855,12 +1148,12 @@ spu_function_t spu_runtime::rebuild_ubertrampoline(u32 id_inst)
 			if (it == m_flat_list.end())
 			{
 				spu_log.error("Trampoline simplified (II) at ??? (level=%u)", w.level);
-				make_jump(0xe9, w.beg->second); // jmp rel32
+				make_leaf(0xe9, w.beg->second, w.depth); // jmp rel32
 				continue;
 			}
 
 			// Emit 32-bit comparison
-			ensure(raw + 12 <= wxptr + size0 * 22 + 16); // "Asm overflow"
+			ensure(raw + 12 <= wxptr + tree_size + 2); // "Asm overflow"
 
 			if (w.from != w.level)
 			{
@@ -890,7 +1183,7 @@ spu_function_t spu_runtime::rebuild_ubertrampoline(u32 id_inst)
 			// Low subrange target
 			if (size1 == 1)
 			{
-				make_jump(0x82, w.beg->second); // jb rel32
+				make_leaf(0x82, w.beg->second, w.depth + 1); // jb rel32
 			}
 			else
 			{
@@ -900,12 +1193,13 @@ spu_function_t spu_runtime::rebuild_ubertrampoline(u32 id_inst)
 				to.size  = size1;
 				to.rel32 = raw;
 				to.from  = w.level;
+				to.depth = w.depth + 1;
 			}
 
 			// Second subrange target
 			if (size2 == 1)
 			{
-				make_jump(0xe9, it->second); // jmp rel32
+				make_leaf(0xe9, it->second, w.depth + 1); // jmp rel32
 			}
 			else
 			{
@@ -923,7 +1217,7 @@ spu_function_t spu_runtime::rebuild_ubertrampoline(u32 id_inst)
 					// High subrange target
 					if (size2 == 1)
 					{
-						make_jump(0x87, it2->second); // ja rel32
+						make_leaf(0x87, it2->second, w.depth + 1); // ja rel32
 					}
 					else
 					{
@@ -933,13 +1227,14 @@ spu_function_t spu_runtime::rebuild_ubertrampoline(u32 id_inst)
 						to.size  = size2;
 						to.rel32 = raw;
 						to.from  = w.level;
+						to.depth = w.depth + 1;
 					}
 
 					const u32 size3 = w.size - size1 - size2;
 
 					if (size3 == 1)
 					{
-						make_jump(0xe9, it->second); // jmp rel32
+						make_leaf(0xe9, it->second, w.depth + 1); // jmp rel32
 					}
 					else
 					{
@@ -950,6 +1245,7 @@ spu_function_t spu_runtime::rebuild_ubertrampoline(u32 id_inst)
 						to.size  = size3;
 						to.rel32 = raw;
 						to.from  = w.level;
+						to.depth = w.depth + 1;
 					}
 				}
 				else
@@ -960,6 +1256,7 @@ spu_function_t spu_runtime::rebuild_ubertrampoline(u32 id_inst)
 					to.size  = w.size - size1;
 					to.rel32 = raw;
 					to.from  = w.level;
+					to.depth = w.depth + 1;
 				}
 			}
 		}
@@ -968,6 +1265,31 @@ spu_function_t spu_runtime::rebuild_ubertrampoline(u32 id_inst)
 		result = reinterpret_cast<spu_function_t>(reinterpret_cast<u64>(wxptr));
 	}
 
+	if (stats)
+	{
+		std::lock_guard lock(m_tr_mutex);
+		stats->hits_at_build = stats->hits;
+		stats->rebuilds++;
+		stats->functions = size0;
+		stats->max_depth = max_depth;
+		stats->avg_depth = sum_depth / (total_hits + size0);
+	}
+
+	if (rebalance)
+	{
+		// Replace the trampoline only if no newer one was installed meanwhile
+		for (auto it = stuff_it; it != stuff_end; ++it)
+		{
+			if (it->trampoline.compare_and_swap_test(current, result))
+			{
+				spu_runtime::g_dispatcher->at(id_inst >> 12).compare_and_swap(current, result);
+				return result;
+			}
+		}
+
+		return current;
+	}
+
 	if (auto _old = stuff_it->trampoline.compare_and_swap(nullptr, result))
 	{
 		return _old;
@@ -1005,6 +1327,45 @@ spu_function_t spu_runtime::rebuild_ubertrampoline(u32 id_inst)
 	return result;
 }
 
+void spu_runtime::rebalance_ubertrampolines()
+{
+	// Keep the runtime alive until finished
+	reader_lock rlock(s_spurt_mutex);
+
+	if (!s_spurt)
+	{
+		return;
+	}
+
+	std::vector<u32> ids;
+
+	{
+		std::lock_guard lock(s_spurt->m_tr_mutex);
+
+		for (const auto& [id, stats] : s_spurt->m_tr_stats)
+		{
+			// Rebuild when the number of calls doubled since the last build (trivial trampolines are skipped)
+			const u64 hits = stats.hits;
+
+			if (stats.functions > 2 && hits >= 0x10000 && hits >= stats.hits_at_build * 2)
+			{
+				ids.emplace_back(id);
+			}
+		}
+	}
+
+	for (u32 id : ids)
+	{
+		s_spurt->rebuild_ubertrampoline(id << 12, true);
+	}
+}
+
+void spu_runtime::add_trampoline_miss(u32 id_inst)
+{
+	std::lock_guard lock(m_tr_mutex);
+	m_tr_stats[id_inst >> 12].misses++;
+}
+
 spu_function_t spu_runtime::find(const u32* ls, u32 addr) const
 {
 	for (auto& item : m_stuff.at(ls[addr / 4] >> 12))
@@ -1031,6 +1392,7 @@ spu_function_t spu_runtime::find(const u32* ls, u32 addr) const
 
 spu_function_t spu_runtime::make_branch_patchpoint(u16 data) const
 {
+	jit_placement_scope placement(jit_placement::hot);
 	u8* const raw = jit_runtime::alloc(16, 16);
 
 	if (!raw)
@@ -1091,6 +1453,13 @@ void spu_recompiler_base::dispatch(spu_thread& spu, void*, u8* rip)
 		atomic_storage<u64>::release(*reinterpret_cast<u64*>(rip - 8), result);
 	}
 
+	// Workload selection routine of the SPURS kernel (branch() also ends up here because it is never compiled)
+	if (g_cfg.core.spurs_native_kernel && spursKernelNativeSelectWorkload(spu))
+	{
+		spu_runtime::g_tail_escape(&spu, spu_runtime::tr_all, nullptr);
+		return;
+	}
+
 	// Second attempt (recover from the recursion after repeated unsuccessful trampoline call)
 	if (spu.block_counter != spu.block_recover && &dispatch != spu_runtime::g_dispatcher->at(spu._ref<nse_t<u32>>(spu.pc) >> 12))
 	{
@@ -1107,6 +1476,11 @@ void spu_recompiler_base::dispatch(spu_thread& spu, void*, u8* rip)
 		return;
 	}
 
+	if (g_cfg.core.spu_prof)
+	{
+		g_fxo->get<spu_runtime>()->add_trampoline_miss(spu._ref<nse_t<u32>>(spu.pc));
+	}
+
 	const auto func = spu.jit->compile(spu.jit->analyse(spu._ptr<u32>(0), spu.pc));
 
 	if (!func)
@@ -5396,7 +5770,21 @@ public:
 
 	static u32 exec_read_in_mbox(spu_thread* _spu)
 	{
-		// TODO
+		// Fast path: the mailbox is not empty
+		u32 out = 0;
+
+		if (const uint old_count = _spu->ch_in_mbox.try_pop(out)) [[likely]]
+		{
+			if (old_count == 4 /* SPU_IN_MBOX_THRESHOLD */)
+			{
+				_spu->int_ctrl[2].set(SPU_INT2_STAT_SPU_MAILBOX_THRESHOLD_INT);
+			}
+
+			_spu->ch_fast_count[spu_thread::ch_stat_in_mbox]++;
+			return out;
+		}
+
+		_spu->ch_slow_count[spu_thread::ch_stat_in_mbox]++;
 		return exec_rdch(_spu, SPU_RdInMbox);
 	}
 
@@ -5421,10 +5809,27 @@ public:
 
 	static u32 exec_read_events(spu_thread* _spu)
 	{
-		// TODO
+		// Fast path: events are already pending
+		const u32 mask1 = _spu->ch_events.load().mask;
+
+		if (const auto events = _spu->get_events(mask1, false, true); events.count)
+		{
+			_spu->ch_fast_count[spu_thread::ch_stat_events]++;
+			return events.events & mask1;
+		}
+
+		_spu->ch_slow_count[spu_thread::ch_stat_events]++;
 		return exec_rdch(_spu, SPU_RdEventStat);
 	}
 
+	// Increment channel statistics counter
+	void ch_stat(u32 index, bool fast)
+	{
+		const u32 off = (fast ? ::offset32(&spu_thread::ch_fast_count) : ::offset32(&spu_thread::ch_slow_count)) + index * 8;
+		const auto ptr = _ptr<u64>(m_thread, off);
+		m_ir->CreateStore(m_ir->CreateAdd(m_ir->CreateLoad(ptr), m_ir->getInt64(1)), ptr);
+	}
+
 	llvm::Value* get_rdch(spu_opcode_t op, u32 off, bool atomic)
 	{
 		const auto ptr = _ptr<u64>(m_thread, off);
@@ -5731,13 +6136,34 @@ public:
 		}
 		case SPU_WrOutIntrMbox:
 		{
-			// TODO
+			// Always handled by the syscall emulation for threaded SPUs
+			ch_stat(spu_thread::ch_stat_out_intr_mbox, false);
 			break;
 		}
 		case SPU_WrOutMbox:
 		{
-			// TODO
-			break;
+			// Fast path: the mailbox is empty, push the value (same as spu_channel::push_wait)
+			const auto ptr = _ptr<u64>(m_thread, ::offset32(&spu_thread::ch_out_mbox));
+			const auto old = m_ir->CreateLoad(ptr, true);
+			const auto _new = m_ir->CreateOr(m_ir->CreateZExt(val.value, get_type<u64>()), m_ir->getInt64(spu_channel::bit_count));
+			const auto next = llvm::BasicBlock::Create(m_context, "", m_function);
+			const auto _cas = llvm::BasicBlock::Create(m_context, "", m_function);
+			const auto done = llvm::BasicBlock::Create(m_context, "", m_function);
+			const auto wait = llvm::BasicBlock::Create(m_context, "", m_function);
+			m_ir->CreateCondBr(m_ir->CreateICmpSLT(old, m_ir->getInt64(0)), wait, _cas, m_md_unlikely);
+			m_ir->SetInsertPoint(_cas);
+			const auto cas = m_ir->CreateAtomicCmpXchg(ptr, old, _new, llvm::AtomicOrdering::SequentiallyConsistent, llvm::AtomicOrdering::SequentiallyConsistent);
+			m_ir->CreateCondBr(m_ir->CreateExtractValue(cas, 1), done, wait, m_md_likely);
+			m_ir->SetInsertPoint(done);
+			ch_stat(spu_thread::ch_stat_out_mbox, true);
+			m_ir->CreateBr(next);
+			m_ir->SetInsertPoint(wait);
+			ch_stat(spu_thread::ch_stat_out_mbox, false);
+			update_pc();
+			call("spu_write_channel", &exec_wrch, m_thread, m_ir->getInt32(op.ra), val.value);
+			m_ir->CreateBr(next);
+			m_ir->SetInsertPoint(next);
+			return;
 		}
 		case MFC_WrTagMask:
 		{
@@ -5898,6 +6324,7 @@ public:
 					m_ir->CreateUnreachable();
 					m_ir->SetInsertPoint(next);
 					m_ir->CreateStore(ci, spu_ptr<u8>(&spu_thread::ch_mfc_cmd, &spu_mfc_cmd::cmd));
+					ch_stat(spu_thread::ch_stat_mfc_cmd, false);
 					update_pc();
 					call("spu_exec_mfc_cmd", &exec_mfc_cmd, m_thread);
 					return;
@@ -5952,6 +6379,7 @@ public:
 					m_ir->CreateCondBr(m_ir->CreateICmpUGE(eal.value, m_ir->getInt32(0xe0000000)), mmio, copy, m_md_unlikely);
 					m_ir->SetInsertPoint(mmio);
 					m_ir->CreateStore(ci, spu_ptr<u8>(&spu_thread::ch_mfc_cmd, &spu_mfc_cmd::cmd));
+					ch_stat(spu_thread::ch_stat_mfc_cmd, false);
 					call("spu_exec_mfc_cmd", &exec_mfc_cmd, m_thread);
 					m_ir->CreateBr(next);
 					m_ir->SetInsertPoint(copy);
@@ -6021,6 +6449,7 @@ public:
 
 					// Disable certain thing
 					m_ir->CreateStore(m_ir->getInt32(0), spu_ptr<u32>(&spu_thread::last_faddr));
+					ch_stat(spu_thread::ch_stat_mfc_cmd, true);
 					m_ir->CreateBr(next);
 					break;
 				}
@@ -6032,6 +6461,7 @@ public:
 					m_ir->CreateCondBr(cond, exec, fail, m_md_likely);
 					m_ir->SetInsertPoint(exec);
 					m_ir->CreateFence(llvm::AtomicOrdering::SequentiallyConsistent);
+					ch_stat(spu_thread::ch_stat_mfc_cmd, true);
 					m_ir->CreateBr(next);
 					break;
 				}
@@ -6048,6 +6478,7 @@ public:
 
 				// Fallback: enqueue the command
 				m_ir->SetInsertPoint(fail);
+				ch_stat(spu_thread::ch_stat_mfc_cmd, false);
 
 				// Get MFC slot, redirect to invalid memory address
 				const auto slot = m_ir->CreateLoad(spu_ptr<u32>(&spu_thread::mfc_size));
@@ -6160,6 +6591,11 @@ public:
 		}
 		}
 
+		if (op.ra == MFC_Cmd)
+		{
+			ch_stat(spu_thread::ch_stat_mfc_cmd, false);
+		}
+
 		update_pc();
 		call("spu_write_channel", &exec_wrch, m_thread, m_ir->getInt32(op.ra), val.value);
 	}
@@ -8889,9 +9325,130 @@ std::unique_ptr<spu_recompiler_base> spu_recompiler_base::make_llvm_recompiler(u
 
 #endif
 
+// Make 8-byte patch for the long NOP at the start of spu_fast function: jump to the new function
+static u64 spu_make_jump_patch(u64 from, spu_function_t to)
+{
+	const s64 rel = reinterpret_cast<u64>(to) - from - 5;
+
+	union
+	{
+		u8 bytes[8];
+		u64 result;
+	};
+
+	bytes[0] = 0xe9; // jmp rel32
+	std::memcpy(bytes + 1, &rel, 4);
+	bytes[5] = 0x90;
+	bytes[6] = 0x90;
+	bytes[7] = 0x90;
+
+	return result;
+}
+
+// Intermediate tier: compile programs waiting for LLVM with ASMJIT
+struct spu_asmjit_tier
+{
+	lf_queue<spu_item*> registered;
+
+	u64 compiled = 0;
+	u64 skipped = 0;
+
+	void operator()()
+	{
+		const auto compiler = spu_recompiler_base::make_asmjit_recompiler(true);
+		compiler->init();
+
+		// Fake LS
+		std::vector<be_t<u32>> ls(0x10000);
+
+		while (thread_ctrl::state() != thread_state::aborting)
+		{
+			auto slice = registered.pop_all();
+
+			if (!slice)
+			{
+				thread_ctrl::wait_on(registered, nullptr);
+				continue;
+			}
+
+			for (; slice; slice.pop_front())
+			{
+				spu_item* const item = *slice;
+
+				if (!item)
+				{
+					return;
+				}
+
+				const auto& func = item->data;
+
+				// Get current spu_fast function, skip if LLVM has already replaced it
+				const u64 old_func = reinterpret_cast<u64>(item->compiled.load());
+
+				if (!old_func || atomic_storage<u64>::load(*reinterpret_cast<u64*>(old_func)) != 0x841f0f || thread_ctrl::state() == thread_state::aborting)
+				{
+					skipped++;
+					continue;
+				}
+
+				// Initialize LS with function data only
+				for (u32 i = 0, pos = func.lower_bound; i < func.data.size(); i++, pos += 4)
+				{
+					ls[pos / 4] = std::bit_cast<be_t<u32>>(func.data[i]);
+				}
+
+				spu_program func2 = compiler->analyse(ls.data(), func.entry_point);
+
+				if (func2 != func)
+				{
+					spu_log.error("[0x%05x] SPU Analyser failed, %u vs %u", func2.entry_point, func2.data.size(), func.data.size());
+				}
+				else if (const auto target = compiler->compile(std::move(func2)))
+				{
+					// Redirect spu_fast function unless LLVM did it first
+					u64 nop = 0x841f0f;
+					atomic_storage<u64>::compare_exchange(*reinterpret_cast<u64*>(old_func), nop, spu_make_jump_patch(old_func, target));
+					compiled++;
+				}
+				else
+				{
+					skipped++;
+				}
+
+				// Clear fake LS
+				std::memset(ls.data() + func.lower_bound / 4, 0, 4 * func.data.size());
+			}
+		}
+	}
+
+	~spu_asmjit_tier()
+	{
+		if (compiled || skipped)
+		{
+			spu_log.notice("SPU ASMJIT Tier: compiled %u programs (%u skipped)", compiled, skipped);
+		}
+	}
+
+	static constexpr auto thread_name = "SPU ASMJIT Tier"sv;
+};
+
 struct spu_llvm_worker
 {
-	lf_queue<std::pair<u64, const spu_program*>> registered;
+	struct work_item
+	{
+		u64 old_func;
+		spu_item* item;
+		jit_placement placement;
+
+		work_item(u64 old_func, spu_item* item, jit_placement placement = jit_placement::hot)
+			: old_func(old_func)
+			, item(item)
+			, placement(placement)
+		{
+		}
+	};
+
+	lf_queue<work_item> registered;
 
 	void operator()()
 	{
@@ -8932,12 +9489,15 @@ struct spu_llvm_worker
 				continue;
 			}
 
-			if (!prog->second)
+			if (!prog->item)
 			{
 				break;
 			}
 
-			const auto& func = *prog->second;
+			const auto& func = prog->item->data;
+
+			// Place code of programs which were never sampled away from the hot ones
+			jit_placement_scope placement(prog->placement);
 
 			// Get data start
 			const u32 start = func.lower_bound;
@@ -8959,21 +9519,14 @@ struct spu_llvm_worker
 			else if (const auto target = compiler->compile(std::move(func2)))
 			{
 				// Redirect old function (TODO: patch in multiple places)
-				const s64 rel = reinterpret_cast<u64>(target) - prog->first - 5;
+				// Full barrier: the intermediate tier checks this patch after publishing its function, one of the sides must see the other
+				atomic_storage<u64>::exchange(*reinterpret_cast<u64*>(prog->old_func), spu_make_jump_patch(prog->old_func, target));
 
-				union
+				// Redirect the function of the intermediate tier, it may have been installed after scheduling
+				if (const u64 inter = reinterpret_cast<u64>(prog->item->intermediate.load()); inter && inter != prog->old_func)
 				{
-					u8 bytes[8];
-					u64 result;
-				};
-
-				bytes[0] = 0xe9; // jmp rel32
-				std::memcpy(bytes + 1, &rel, 4);
-				bytes[5] = 0x90;
-				bytes[6] = 0x90;
-				bytes[7] = 0x90;
-
-				atomic_storage<u64>::release(*reinterpret_cast<u64*>(prog->first), result);
+					atomic_storage<u64>::release(*reinterpret_cast<u64*>(inter), spu_make_jump_patch(inter, target));
+				}
 			}
 			else
 			{
@@ -9059,12 +9612,29 @@ struct spu_llvm
 
 		named_thread_group<spu_llvm_worker> workers("SPUW.", worker_count);
 
+		// Samples of the previous runs
+		const std::string samples_path = spu_cache::get_samples_path();
+		auto old_samples = spu_cache::load_samples(samples_path);
+
+		// Intermediate tier
+		std::unique_ptr<named_thread<spu_asmjit_tier>> tier;
+
+		if (g_cfg.core.spu_asmjit_tier)
+		{
+			tier = std::make_unique<named_thread<spu_asmjit_tier>>();
+		}
+
 		while (thread_ctrl::state() != thread_state::aborting)
 		{
 			for (const auto& pair : registered.pop_all())
 			{
 				enqueued.emplace(pair);
 
+				if (tier)
+				{
+					tier->registered.push(pair.second);
+				}
+
 				// Interrupt and kick profiler thread
 				const auto lock = prof_mutex.init_always([&]{});
 
@@ -9086,7 +9656,9 @@ struct spu_llvm
 
 			for (auto it = enqueued.begin(), end = enqueued.end(); it != end; ++it)
 			{
-				const u64 cur = std::as_const(samples).at(it->first);
+				// Hot programs of the previous runs go first
+				const auto seed = std::as_const(old_samples).find(it->first);
+				const u64 cur = std::as_const(samples).at(it->first) + (seed != old_samples.cend() ? seed->second : 0);
 
 				if (cur > sample_max)
 				{
@@ -9096,22 +9668,60 @@ struct spu_llvm
 			}
 
 			// Start compiling
-			const spu_program& func = found_it->second->data;
+			spu_item* const item = found_it->second;
 
 			// Old function pointer (pre-recompiled)
-			const spu_function_t _old = found_it->second->compiled;
+			const spu_function_t _old = item->compiled;
+
+			// Programs are usually picked before receiving samples: new programs default to hot,
+			// only the programs which stayed unsampled during the previous runs are placed in the cold region
+			const auto seed = std::as_const(old_samples).find(found_it->first);
+			const bool cold = seed != old_samples.cend() && !seed->second && !std::as_const(samples).at(found_it->first);
 
 			// Remove item from the queue
 			enqueued.erase(found_it);
 
 			// Push the workload
-			(workers.begin() + (worker_index++ % worker_count))->registered.push(reinterpret_cast<u64>(_old), &func);
+			(workers.begin() + (worker_index++ % worker_count))->registered.push(reinterpret_cast<u64>(_old), item, cold ? jit_placement::cold : jit_placement::hot);
 		}
 
 		for (u32 i = 0; i < worker_count; i++)
 		{
 			(workers.begin() + i)->registered.push(0, nullptr);
 		}
+
+		if (tier)
+		{
+			tier->registered.push(nullptr);
+		}
+
+		// Save samples (the map is not modified anymore): average with this run, programs not seen in this run decay
+		for (auto it = old_samples.begin(); it != old_samples.end();)
+		{
+			const auto found = std::as_const(samples).find(it->first);
+
+			if (found != samples.cend())
+			{
+				// Kept even if it drops to zero, the program is known to be cold
+				it->second = (it->second + found->second.load()) / 2;
+			}
+			else if (!(it->second /= 2))
+			{
+				// Stale programs are forgotten
+				it = old_samples.erase(it);
+				continue;
+			}
+
+			++it;
+		}
+
+		for (const auto& [hash, count] : samples)
+		{
+			// New programs (zero counts are kept for the programs seen in this run)
+			old_samples.try_emplace(hash, count.load() / 2);
+		}
+
+		spu_cache::save_samples(samples_path, old_samples);
 	}
 
 	static constexpr auto thread_name = "SPU LLVM"sv;
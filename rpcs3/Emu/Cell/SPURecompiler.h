@@ -9,6 +9,7 @@
 #include <memory>
 #include <string>
 #include <deque>
+#include <unordered_map>
 
 // Helper class
 class spu_cache
@@ -36,6 +37,13 @@ public:
 	void add(const struct spu_program& func);
 
 	static void initialize();
+
+	// Profiling samples of SPU LLVM thread kept between runs (hash -> count)
+	static std::string get_samples_path();
+
+	static std::unordered_map<u64, u64, value_hash<u64>> load_samples(const std::string& path);
+
+	static void save_samples(const std::string& path, const std::unordered_map<u64, u64, value_hash<u64>>& samples);
 };
 
 struct spu_program
@@ -68,12 +76,18 @@ public:
 	// Compiled function pointer
 	atomic_t<spu_function_t> compiled = nullptr;
 
+	// Function compiled by the intermediate tier (ASMJIT, LLVM decoder only)
+	atomic_t<spu_function_t> intermediate = nullptr;
+
 	// Ubertrampoline generated for this item when it was latest
 	atomic_t<spu_function_t> trampoline = nullptr;
 
 	atomic_t<u8> cached = false;
 	atomic_t<u8> logged = false;
 
+	// Number of calls through the ubertrampoline (only counted with SPU Profiler)
+	atomic_t<u64> hits = 0;
+
 	spu_item(spu_program&& data)
 		: data(std::move(data))
 	{
@@ -93,6 +107,31 @@ class spu_runtime
 	// Debug module output location
 	std::string m_cache_path;
 
+	// Ubertrampoline statistics (only collected with SPU Profiler)
+	struct trampoline_stats
+	{
+		// Calls through the latest trampoline (incremented by generated code)
+		atomic_t<u64> hits = 0;
+
+		// Fallbacks to spu_recompiler_base::dispatch
+		atomic_t<u64> misses = 0;
+
+		// Value of hits when the trampoline was built
+		u64 hits_at_build = 0;
+
+		u32 rebuilds = 0;
+		u32 functions = 0;
+		u32 max_depth = 0;
+
+		// Average number of comparisons weighted by hits
+		f64 avg_depth = 0;
+	};
+
+	// Stats per bunch (first instruction >> 12)
+	std::unordered_map<u32, trampoline_stats> m_tr_stats;
+
+	mutable shared_mutex m_tr_mutex;
+
 public:
 	// Trampoline to spu_recompiler_base::dispatch
 	static const spu_function_t tr_dispatch;
@@ -113,13 +152,21 @@ public:
 
 	spu_runtime& operator=(const spu_runtime&) = delete;
 
+	~spu_runtime();
+
 	const std::string& get_cache_path() const
 	{
 		return m_cache_path;
 	}
 
-	// Rebuild ubertrampoline for given identifier (first instruction)
-	spu_function_t rebuild_ubertrampoline(u32 id_inst);
+	// Rebuild ubertrampoline for given identifier (first instruction), optionally replacing the installed one
+	spu_function_t rebuild_ubertrampoline(u32 id_inst, bool rebalance = false);
+
+	// Rebuild ubertrampolines whose call frequencies changed significantly since they were built (no-op if the runtime doesn't exist)
+	static void rebalance_ubertrampolines();
+
+	// Count dispatcher fallback for given identifier (first instruction)
+	void add_trampoline_miss(u32 id_inst);
 
 private:
 	friend class spu_cache;
@@ -337,8 +384,8 @@ public:
 		return *m_spurt;
 	}
 
-	// Create recompiler instance (ASMJIT)
-	static std::unique_ptr<spu_recompiler_base> make_asmjit_recompiler();
+	// Create recompiler instance (ASMJIT), optionally as the intermediate tier of LLVM decoder
+	static std::unique_ptr<spu_recompiler_base> make_asmjit_recompiler(bool tier = false);
 
 	// Create recompiler instance (LLVM)
 	static std::unique_ptr<spu_recompiler_base> make_llvm_recompiler(u8 magn = 0);
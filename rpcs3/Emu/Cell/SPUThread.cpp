@@ -1700,6 +1700,16 @@ spu_thread::~spu_thread()
 
 	perf_log.notice("Perf stats for transactions: success %u, failure %u", stx, ftx);
 	perf_log.notice("Perf stats for PUTLLC reload: successs %u, failure %u", last_succ, last_fail);
+
+	if (g_cfg.core.spu_decoder == spu_decoder_type::llvm)
+	{
+		perf_log.notice("Perf stats for channels (fast/slow): Out_MBox %u/%u, Out_IntrMBox %u/%u, In_MBox %u/%u, Events %u/%u, MFC_Cmd %u/%u",
+			ch_fast_count[ch_stat_out_mbox], ch_slow_count[ch_stat_out_mbox],
+			ch_fast_count[ch_stat_out_intr_mbox], ch_slow_count[ch_stat_out_intr_mbox],
+			ch_fast_count[ch_stat_in_mbox], ch_slow_count[ch_stat_in_mbox],
+			ch_fast_count[ch_stat_events], ch_slow_count[ch_stat_events],
+			ch_fast_count[ch_stat_mfc_cmd], ch_slow_count[ch_stat_mfc_cmd]);
+	}
 }
 
 spu_thread::spu_thread(lv2_spu_group* group, u32 index, std::string_view name, u32 lv2_id, bool is_isolated, u32 option)
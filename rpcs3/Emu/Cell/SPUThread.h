@@ -762,6 +762,20 @@ public:
 	u64 ftx = 0; // Failed transactions
 	u64 stx = 0; // Succeeded transactions (pure counters)
 
+	// Channel statistics indices
+	enum : u32
+	{
+		ch_stat_out_mbox,
+		ch_stat_out_intr_mbox,
+		ch_stat_in_mbox,
+		ch_stat_events,
+		ch_stat_mfc_cmd,
+		ch_stat_max
+	};
+
+	std::array<u64, ch_stat_max> ch_fast_count{}; // Channel operations completed by the fast paths of LLVM recompiler
+	std::array<u64, ch_stat_max> ch_slow_count{}; // Channel operations passed to the generic handlers (pure counters)
+
 	u64 last_ftsc = 0;
 	u64 last_ftime = 0;
 	u32 last_faddr = 0;
@@ -6,6 +6,10 @@ shared_mutex id_manager::g_mutex;
 
 thread_local DECLARE(idm::g_id);
 DECLARE(idm::g_map);
+DECLARE(idm::g_slots);
+
+// All slot tables, replaced tables are kept until the next init() since they may still be read
+static std::vector<std::unique_ptr<id_manager::id_slot_table>> s_slot_tables;
 
 id_manager::id_map::pointer idm::allocate_id(const id_manager::id_key& info, u32 base, u32 step, u32 count, std::pair<u32, u32> invl_range)
 {
@@ -44,15 +48,72 @@ id_manager::id_map::pointer idm::allocate_id(const id_manager::id_key& info, u32
 	return nullptr;
 }
 
+void idm::publish(u32 type, id_manager::id_map::pointer entry)
+{
+	const auto& vec = g_map[type];
+	const u32 index = static_cast<u32>(entry - vec.data());
+
+	auto table = g_slots[type].load();
+
+	if (!table || index >= table->size)
+	{
+		// Make a new table big enough for the whole map
+		auto& new_table = s_slot_tables.emplace_back(std::make_unique<id_manager::id_slot_table>(static_cast<u32>(vec.capacity())));
+
+		for (u32 i = 0; i < vec.size(); i++)
+		{
+			auto& slot = new_table->slots[i];
+			slot.value = vec[i].first.value();
+			slot.type = vec[i].first.type();
+			slot.ptr = vec[i].second.get();
+		}
+
+		g_slots[type] = new_table.get();
+		return;
+	}
+
+	auto& slot = table->slots[index];
+	slot.seq++;
+	slot.value = entry->first.value();
+	slot.type = entry->first.type();
+	slot.ptr = entry->second.get();
+	slot.seq++;
+}
+
+void idm::unpublish_all(u32 type)
+{
+	if (const auto table = g_slots[type].load())
+	{
+		for (u32 i = 0; i < table->size; i++)
+		{
+			auto& slot = table->slots[i];
+
+			if (slot.ptr)
+			{
+				slot.seq++;
+				slot.ptr = nullptr;
+				slot.seq++;
+			}
+		}
+	}
+}
+
 void idm::init()
 {
 	// Allocate
 	g_map.resize(id_manager::typeinfo::get_count());
+	g_slots = std::make_unique<atomic_t<id_manager::id_slot_table*>[]>(g_map.size());
+	s_slot_tables.clear();
 	idm::clear();
 }
 
 void idm::clear()
 {
+	for (u32 i = 0; g_slots && i < g_map.size(); i++)
+	{
+		unpublish_all(i);
+	}
+
 	// Call recorded finalization functions for all IDs
 	for (auto& map : g_map)
 	{
@@ -133,6 +133,28 @@ namespace id_manager
 	};
 
 	using id_map = std::vector<std::pair<id_key, std::shared_ptr<void>>>;
+
+	// Copy of an id_map entry readable without locking, only written under the global mutex
+	struct id_slot
+	{
+		atomic_t<u32> seq{0}; // Odd while being written
+		atomic_t<u32> value{0};
+		atomic_t<u32> type{0};
+		atomic_t<void*> ptr{nullptr};
+	};
+
+	// Fixed capacity table of slots indexed like id_map, replaced by a bigger one when the id_map grows past it
+	struct id_slot_table
+	{
+		const u32 size;
+		const std::unique_ptr<id_slot[]> slots;
+
+		explicit id_slot_table(u32 size)
+			: size(size)
+			, slots(std::make_unique<id_slot[]>(size))
+		{
+		}
+	};
 }
 
 // Object manager for emulated process. Multiple objects of specified arbitrary type are given unique IDs.
@@ -144,6 +166,15 @@ class idm
 	// Type Index -> ID -> Object. Use global since only one process is supported atm.
 	static std::vector<id_manager::id_map> g_map;
 
+	// Type Index -> lock-free copy of g_map entries (for check())
+	static std::unique_ptr<atomic_t<id_manager::id_slot_table*>[]> g_slots;
+
+	// Update the lock-free copy of the entry, must be called under the writer lock
+	static void publish(u32 type, id_manager::id_map::pointer entry);
+
+	// Clear the lock-free copy of all entries of the type, must be called under the writer lock
+	static void unpublish_all(u32 type);
+
 	template <typename T>
 	static inline u32 get_type()
 	{
@@ -309,6 +340,7 @@ class idm
 
 			if (place->second)
 			{
+				publish(info.value(), place);
 				return place;
 			}
 		}
@@ -328,7 +360,8 @@ public:
 	static inline void clear()
 	{
 		std::lock_guard lock(id_manager::g_mutex);
-		g_map[id_manager::typeinfo::get_index<T>()].clear();
+		unpublish_all(get_type<T>());
+		g_map[get_type<T>()].clear();
 	}
 
 	// Get last ID (updated in create_id/allocate_id)
@@ -404,10 +437,40 @@ public:
 		return nullptr;
 	}
 
-	// Check the ID
+	// Check the ID (the object is not protected from removal in either case)
 	template <typename T, typename Get = T>
 	static inline Get* check(u32 id)
 	{
+		static_assert(id_manager::id_verify<T, Get>::value, "Invalid ID type combination");
+
+		const u32 index = get_index<Get>(id);
+
+		if (index >= id_manager::id_traits<Get>::count)
+		{
+			return nullptr;
+		}
+
+		if (const auto table = g_slots[get_type<T>()].load(); table && index < table->size)
+		{
+			auto& slot = table->slots[index];
+
+			const u32 seq = slot.seq;
+			const u32 value = slot.value;
+			const u32 type = slot.type;
+			const auto ptr = static_cast<Get*>(slot.ptr.load());
+
+			// Snapshot is consistent if no write happened in between
+			if (!(seq & 1) && slot.seq == seq) [[likely]]
+			{
+				if (ptr && (std::is_same_v<T, Get> || type == get_type<Get>()) && (!id_manager::id_traits<Get>::invl_range.second || value == id))
+				{
+					return ptr;
+				}
+
+				return nullptr;
+			}
+		}
+
 		reader_lock lock(id_manager::g_mutex);
 
 		return check_unlocked<T, Get>(id);
@@ -562,6 +625,7 @@ public:
 			if (const auto found = find_id<T, Get>(id))
 			{
 				ptr = std::move(found->second);
+				publish(get_type<T>(), found);
 			}
 			else
 			{
@@ -584,6 +648,7 @@ public:
 				(!found->second.owner_before(sptr) && !sptr.owner_before(found->second)))
 			{
 				ptr = std::move(found->second);
+				publish(get_type<T>(), found);
 			}
 			else
 			{
@@ -605,6 +670,7 @@ public:
 			if (const auto found = find_id<T, Get>(id))
 			{
 				ptr = std::static_pointer_cast<Get>(::as_rvalue(std::move(found->second)));
+				publish(get_type<T>(), found);
 			}
 		}
 
@@ -624,7 +690,9 @@ public:
 			if constexpr (std::is_void_v<FRT>)
 			{
 				func(*_ptr);
-				return std::static_pointer_cast<Get>(::as_rvalue(std::move(found->second)));
+				auto ptr = std::static_pointer_cast<Get>(::as_rvalue(std::move(found->second)));
+				publish(get_type<T>(), found);
+				return ptr;
 			}
 			else
 			{
@@ -636,7 +704,9 @@ public:
 					return {{found->second, _ptr}, std::move(ret)};
 				}
 
-				return {std::static_pointer_cast<Get>(::as_rvalue(std::move(found->second))), std::move(ret)};
+				auto ptr = std::static_pointer_cast<Get>(::as_rvalue(std::move(found->second)));
+				publish(get_type<T>(), found);
+				return {std::move(ptr), std::move(ret)};
 			}
 		}
 
@@ -15,6 +15,7 @@
 #include "Emu/perf_meter.hpp"
 #include <thread>
 #include <deque>
+#include <set>
 #include <shared_mutex>
 
 #include "util/vm.hpp"
@@ -1052,6 +1053,93 @@ namespace vm
 	// Mapped regions: addr -> shm handle
 	constexpr auto block_map = &auto_typemap<block_t>::get<std::map<u32, std::pair<u32, std::shared_ptr<utils::shm>>>>;
 
+	// Free extents of a block, indexed both by address and by size
+	struct block_free_extents
+	{
+		std::map<u32, u32> by_addr; // addr -> size
+		std::set<std::pair<u32, u32>> by_size; // (size, addr)
+
+		void emplace(u32 addr, u32 size)
+		{
+			by_addr.emplace(addr, size);
+			by_size.emplace(size, addr);
+		}
+
+		std::map<u32, u32>::iterator erase(std::map<u32, u32>::iterator it)
+		{
+			by_size.erase({it->second, it->first});
+			return by_addr.erase(it);
+		}
+
+		// Mark range as free, merging with adjacent extents
+		void insert(u32 addr, u32 size)
+		{
+			const auto next = by_addr.lower_bound(addr);
+
+			if (next != by_addr.end() && next->first == addr + u64{size})
+			{
+				size += next->second;
+				erase(next);
+			}
+
+			if (const auto prev = by_addr.lower_bound(addr); prev != by_addr.begin())
+			{
+				if (const auto it = std::prev(prev); it->first + u64{it->second} == addr)
+				{
+					addr = it->first;
+					size += it->second;
+					erase(it);
+				}
+			}
+
+			emplace(addr, size);
+		}
+
+		// Mark range as used, splitting the extents it overlaps
+		void remove(u32 addr, u32 size)
+		{
+			const u64 end = addr + u64{size};
+
+			auto it = by_addr.upper_bound(addr);
+
+			if (it != by_addr.begin())
+			{
+				it--;
+			}
+
+			while (it != by_addr.end() && it->first < end)
+			{
+				const u32 ext_addr = it->first;
+				const u64 ext_end = ext_addr + u64{it->second};
+
+				if (ext_end <= addr)
+				{
+					it++;
+					continue;
+				}
+
+				it = erase(it);
+
+				if (ext_addr < addr)
+				{
+					emplace(ext_addr, addr - ext_addr);
+				}
+
+				if (ext_end > end)
+				{
+					emplace(static_cast<u32>(end), static_cast<u32>(ext_end - end));
+				}
+			}
+		}
+
+		u32 largest() const
+		{
+			return by_size.empty() ? 0 : by_size.rbegin()->first;
+		}
+	};
+
+	constexpr auto block_free = &auto_typemap<block_t>::get<block_free_extents>;
+
 	bool block_t::try_alloc(u32 addr, u8 flags, u32 size, std::shared_ptr<utils::shm>&& shm)
 	{
 		// Check if memory area is already mapped
@@ -1120,6 +1208,7 @@ namespace vm
 
 		// Add entry
 		(m.*block_map)()[addr] = std::make_pair(size, std::move(shm));
+		(m.*block_free)().remove(addr, size);
 
 		return true;
 	}
@@ -1129,6 +1218,8 @@ namespace vm
 		, size(size)
 		, flags(flags)
 	{
+		(m.*block_free)().insert(addr, size);
+
 		if (flags & 0x100 || flags & 0x20)
 		{
 			// Special path for whole-allocated areas allowing 4k granularity
@@ -1213,12 +1304,29 @@ namespace vm
 
 		vm::writer_lock lock(0);
 
-		// Search for an appropriate place (unoptimized)
-		for (u32 addr = utils::align(this->addr, align); u64{addr} + size <= u64{this->addr} + this->size; addr += align)
+		const auto& extents = (m.*block_free)();
+
+		if (extents.largest() < size)
+		{
+			return 0;
+		}
+
+		// Search for the lowest appropriate place, the pages are still checked since they may be mapped outside of the block's bookkeeping
+		for (const auto& [ext_addr, ext_size] : extents.by_addr)
 		{
-			if (try_alloc(addr, pflags, size, std::move(shm)))
+			if (ext_size < size)
 			{
-				return addr + (flags & 0x10 ? 0x1000 : 0);
+				continue;
+			}
+
+			const u64 ext_end = ext_addr + u64{ext_size};
+
+			for (u64 addr = utils::align<u64>(ext_addr, align); addr + size <= ext_end; addr += align)
+			{
+				if (try_alloc(static_cast<u32>(addr), pflags, size, std::move(shm)))
+				{
+					return static_cast<u32>(addr) + (flags & 0x10 ? 0x1000 : 0);
+				}
 			}
 		}
 
@@ -1317,6 +1425,7 @@ namespace vm
 			}
 
 			// Remove entry
+			(m.*block_free)().insert(found->first, found->second.first);
 			m_map.erase(found);
 
 			return size;
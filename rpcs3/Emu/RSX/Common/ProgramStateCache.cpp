@@ -7,6 +7,20 @@
 
 using namespace program_hash_util;
 
+namespace
+{
+	// Number of leading instructions hashed for the program cache lookups, the compare functions check the full ucode
+	constexpr u32 fingerprint_instruction_count = 8;
+
+	inline usz fingerprint_mix(usz hash, const v128& inst)
+	{
+		// Both halves are multiplied independently, keeping the serial dependency short
+		const u64 lo = inst._u64[0] * 0x9E3779B97F4A7C15ull;
+		const u64 hi = inst._u64[1] * 0xC2B2AE3D27D4EB4Full;
+		return std::rotl(hash ^ lo, 27) + hi;
+	}
+}
+
 usz vertex_program_utils::get_vertex_program_ucode_hash(const RSXVertexProgram &program)
 {
 	// 64-bit Fowler/Noll/Vo FNV-1a hash code
@@ -250,7 +264,29 @@ vertex_program_utils::vertex_program_metadata vertex_program_utils::analyse_vert
 
 usz vertex_program_storage_hash::operator()(const RSXVertexProgram &program) const
 {
-	usz hash = vertex_program_utils::get_vertex_program_ucode_hash(program);
+	// Fingerprint of the program: length, first instructions and the last instruction
+	usz hash = program.data.size();
+	const void* instbuffer = program.data.data();
+	const u32 instruction_count = ::size32(program.data) / 4;
+
+	for (u32 i = 0, hashed = 0; i < instruction_count && hashed < fingerprint_instruction_count; i++)
+	{
+		if (program.instruction_mask[i])
+		{
+			hash = fingerprint_mix(hash, v128::loadu(instbuffer, i));
+			hashed++;
+		}
+	}
+
+	for (u32 i = instruction_count; i-- > 0;)
+	{
+		if (program.instruction_mask[i])
+		{
+			hash = fingerprint_mix(hash, v128::loadu(instbuffer, i));
+			break;
+		}
+	}
+
 	hash ^= program.output_mask;
 	hash ^= program.texture_dimensions;
 	return hash;
@@ -449,7 +485,27 @@ usz fragment_program_utils::get_fragment_program_ucode_hash(const RSXFragmentPro
 
 usz fragment_program_storage_hash::operator()(const RSXFragmentProgram& program) const
 {
-	usz hash = fragment_program_utils::get_fragment_program_ucode_hash(program);
+	// Fingerprint of the program: length and first instructions, constants excluded
+	usz hash = program.ucode_length;
+	const void* instbuffer = program.get_data();
+	usz instIndex = 0;
+
+	for (u32 i = 0; i < fingerprint_instruction_count; i++)
+	{
+		const auto inst = v128::loadu(instbuffer, instIndex);
+		hash = fingerprint_mix(hash, inst);
+		instIndex++;
+
+		// Skip constants
+		if (fragment_program_utils::is_constant(inst._u32[1]) ||
+			fragment_program_utils::is_constant(inst._u32[2]) ||
+			fragment_program_utils::is_constant(inst._u32[3]))
+			instIndex++;
+
+		if ((inst._u32[0] >> 8) & 0x1)
+			break;
+	}
+
 	hash ^= program.ctrl;
 	hash ^= program.texture_dimensions;
 	hash ^= program.unnormalized_coords;
@@ -464,7 +520,8 @@ bool fragment_program_compare::operator()(const RSXFragmentProgram& binary1, con
 {
 	if (binary1.ctrl != binary2.ctrl || binary1.texture_dimensions != binary2.texture_dimensions || binary1.unnormalized_coords != binary2.unnormalized_coords ||
 		binary1.two_sided_lighting != binary2.two_sided_lighting ||
-		binary1.shadow_textures != binary2.shadow_textures || binary1.redirected_textures != binary2.redirected_textures)
+		binary1.shadow_textures != binary2.shadow_textures || binary1.redirected_textures != binary2.redirected_textures ||
+		binary1.ucode_length != binary2.ucode_length)
 		return false;
 
 	const void* instBuffer1 = binary1.get_data();
@@ -490,3 +547,44 @@ bool fragment_program_compare::operator()(const RSXFragmentProgram& binary1, con
 			return true;
 	}
 }
+
+const fragment_program_utils::fragment_program_metadata& fragment_program_analysis_cache::analyse(u32 address, const void* ptr)
+{
+	if (const auto found = m_entries.find(address); found != m_entries.end())
+	{
+		const auto& ucode = found->second.ucode;
+
+		if (std::memcmp(ucode.data(), ptr, ucode.size()) == 0)
+		{
+			return found->second.metadata;
+		}
+	}
+	else if (m_entries.size() >= 4096)
+	{
+		// Programs are usually uploaded once, anything else is likely streamed data
+		m_entries.clear();
+	}
+
+	auto& result = m_entries[address];
+	result.metadata = fragment_program_utils::analyse_fragment_program(ptr);
+
+	const u32 length = result.metadata.program_start_offset + result.metadata.program_ucode_length;
+	result.ucode.resize(length);
+	std::memcpy(result.ucode.data(), ptr, length);
+	return result.metadata;
+}
+
+void fragment_program_analysis_cache::invalidate(const utils::address_range& range)
+{
+	for (auto it = m_entries.begin(); it != m_entries.end();)
+	{
+		if (range.overlaps(utils::address_range::start_length(it->first, ::size32(it->second.ucode))))
+		{
+			it = m_entries.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
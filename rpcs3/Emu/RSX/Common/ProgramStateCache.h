@@ -7,9 +7,11 @@
 #include "Utilities/mutex.h"
 #include "util/logs.hpp"
 #include "Utilities/span.h"
+#include "Utilities/address_range.h"
 
 #include <deque>
 #include <unordered_map>
+#include <unordered_set>
 
 enum class SHADER_TYPE
 {
@@ -78,6 +80,25 @@ namespace program_hash_util
 	{
 		bool operator()(const RSXFragmentProgram &binary1, const RSXFragmentProgram &binary2) const;
 	};
+
+	// Remembers the analysis of the fragment programs found at each address.
+	// Entries keep a copy of the analysed ucode; CPU writes are not tracked so it is compared against memory on every lookup.
+	class fragment_program_analysis_cache
+	{
+		struct entry
+		{
+			fragment_program_utils::fragment_program_metadata metadata;
+			std::vector<u8> ucode;
+		};
+
+		std::unordered_map<u32, entry> m_entries;
+
+	public:
+		const fragment_program_utils::fragment_program_metadata& analyse(u32 address, const void* ptr);
+
+		// Drops the entries of unmapped memory
+		void invalidate(const utils::address_range& range);
+	};
 }
 
 
@@ -146,6 +167,12 @@ protected:
 	atomic_t<usz> m_next_id = 0;
 	bool m_cache_miss_flag; // Set if last lookup did not find any usable cached programs
 
+	// Programs inserted in the caches but still being decompiled, guarded by m_decompiler_mutex.
+	// Decompilation runs outside of the cache locks; threads requesting the same program wait for the first one instead.
+	std::unordered_set<const void*> m_pending_programs;
+	atomic_t<u32> m_pending_count = 0;
+	atomic_t<u32> m_decompiled_signal = 0;
+
 	binary_to_vertex_program m_vertex_shader_cache;
 	binary_to_fragment_program m_fragment_shader_cache;
 	std::unordered_map<pipeline_key, pipeline_storage_type, pipeline_key_hash, pipeline_key_compare> m_storage;
@@ -156,10 +183,61 @@ protected:
 	fragment_program_type __null_fragment_program;
 	pipeline_storage_type __null_pipeline_handle;
 
+	void begin_decompile(const void* program)
+	{
+		std::lock_guard lock(m_decompiler_mutex);
+		m_pending_programs.insert(program);
+		m_pending_count++;
+	}
+
+	void end_decompile(const void* program)
+	{
+		{
+			std::lock_guard lock(m_decompiler_mutex);
+			m_pending_programs.erase(program);
+			m_pending_count--;
+		}
+
+		m_decompiled_signal++;
+		m_decompiled_signal.notify_all();
+	}
+
+	// Ends decompilation on scope exit, waiters must be released even if the backend throws
+	struct decompile_scope
+	{
+		program_state_cache& cache;
+		const void* program;
+
+		~decompile_scope()
+		{
+			cache.end_decompile(program);
+		}
+	};
+
+	void wait_for_decompiler(const void* program)
+	{
+		// Fast path, nothing is being decompiled
+		while (m_pending_count)
+		{
+			const u32 signal = m_decompiled_signal;
+			{
+				reader_lock lock(m_decompiler_mutex);
+
+				if (!m_pending_programs.contains(program))
+				{
+					return;
+				}
+			}
+
+			m_decompiled_signal.wait(signal);
+		}
+	}
+
 	/// bool here to inform that the program was preexisting.
 	std::tuple<const vertex_program_type&, bool> search_vertex_program(const RSXVertexProgram& rsx_vp, bool force_load = true)
 	{
 		bool recompile = false;
+		vertex_program_type* existing_shader = nullptr;
 		vertex_program_type* new_shader;
 		{
 			reader_lock lock(m_vertex_mutex);
@@ -167,26 +245,47 @@ protected:
 			const auto& I = m_vertex_shader_cache.find(rsx_vp);
 			if (I != m_vertex_shader_cache.end())
 			{
-				return std::forward_as_tuple(I->second, true);
+				existing_shader = &(I->second);
 			}
+		}
 
-			if (!force_load)
-			{
-				return std::forward_as_tuple(__null_vertex_program, false);
-			}
+		if (existing_shader)
+		{
+			// Waiting is done outside of the cache lock
+			wait_for_decompiler(existing_shader);
+			return std::forward_as_tuple(*existing_shader, true);
+		}
+
+		if (!force_load)
+		{
+			return std::forward_as_tuple(__null_vertex_program, false);
+		}
 
-			rsx_log.notice("VP not found in buffer!");
+		rsx_log.notice("VP not found in buffer!");
+
+		{
+			std::lock_guard lock(m_vertex_mutex);
 
-			lock.upgrade();
 			auto [it, inserted] = m_vertex_shader_cache.try_emplace(rsx_vp);
 			new_shader = &(it->second);
 			recompile = inserted;
+
+			if (inserted)
+			{
+				begin_decompile(new_shader);
+			}
 		}
 
 		if (recompile)
 		{
+			decompile_scope scope{*this, new_shader};
 			backend_traits::recompile_vertex_program(rsx_vp, *new_shader, m_next_id++);
 		}
+		else
+		{
+			// Inserted by another thread in the mean time
+			wait_for_decompiler(new_shader);
+		}
 
 		return std::forward_as_tuple(*new_shader, false);
 	}
@@ -195,6 +294,7 @@ protected:
 	std::tuple<const fragment_program_type&, bool> search_fragment_program(const RSXFragmentProgram& rsx_fp, bool force_load = true)
 	{
 		bool recompile = false;
+		fragment_program_type* existing_shader = nullptr;
 		fragment_program_type* new_shader;
 		{
 			reader_lock lock(m_fragment_mutex);
@@ -202,17 +302,27 @@ protected:
 			const auto& I = m_fragment_shader_cache.find(rsx_fp);
 			if (I != m_fragment_shader_cache.end())
 			{
-				return std::forward_as_tuple(I->second, true);
+				existing_shader = &(I->second);
 			}
+		}
 
-			if (!force_load)
-			{
-				return std::forward_as_tuple(__null_fragment_program, false);
-			}
+		if (existing_shader)
+		{
+			// Waiting is done outside of the cache lock
+			wait_for_decompiler(existing_shader);
+			return std::forward_as_tuple(*existing_shader, true);
+		}
 
-			rsx_log.notice("FP not found in buffer!");
+		if (!force_load)
+		{
+			return std::forward_as_tuple(__null_fragment_program, false);
+		}
+
+		rsx_log.notice("FP not found in buffer!");
+
+		{
+			std::lock_guard lock(m_fragment_mutex);
 
-			lock.upgrade();
 			auto [it, inserted] = m_fragment_shader_cache.try_emplace(rsx_fp);
 			new_shader = &(it->second);
 			recompile = inserted;
@@ -220,10 +330,20 @@ protected:
 			if (inserted)
 			{
 				it->first.clone_data();
-				backend_traits::recompile_fragment_program(rsx_fp, *new_shader, m_next_id++);
+				begin_decompile(new_shader);
 			}
 		}
 
+		if (recompile)
+		{
+			decompile_scope scope{*this, new_shader};
+			backend_traits::recompile_fragment_program(rsx_fp, *new_shader, m_next_id++);
+		}
+		else
+		{
+			wait_for_decompiler(new_shader);
+		}
+
 		return std::forward_as_tuple(*new_shader, false);
 	}
 
@@ -402,11 +522,24 @@ public:
 
 	void clear()
 	{
-		std::scoped_lock lock(m_vertex_mutex, m_fragment_mutex, m_decompiler_mutex, m_pipeline_mutex);
+		while (true)
+		{
+			const u32 signal = m_decompiled_signal;
+			{
+				std::scoped_lock lock(m_vertex_mutex, m_fragment_mutex, m_decompiler_mutex, m_pipeline_mutex);
 
-		notify_pipeline_compiled = {};
-		m_fragment_shader_cache.clear();
-		m_vertex_shader_cache.clear();
-		m_storage.clear();
+				// Decompilation runs outside of the locks and writes into the entries, new ones can't start while locked
+				if (m_pending_programs.empty())
+				{
+					notify_pipeline_compiled = {};
+					m_fragment_shader_cache.clear();
+					m_vertex_shader_cache.clear();
+					m_storage.clear();
+					return;
+				}
+			}
+
+			m_decompiled_signal.wait(signal);
+		}
 	}
 };
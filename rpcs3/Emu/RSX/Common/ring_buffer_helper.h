@@ -57,6 +57,7 @@ protected:
 	usz m_min_guard_size; //If an allocation touches the guard region, reset the heap to avoid going over budget
 	usz m_current_allocated_size;
 	usz m_largest_allocated_pool;
+	u64 m_lap = 0; // Incremented every time the put position wraps around
 
 	char* m_name;
 public:
@@ -75,6 +76,9 @@ public:
 		m_put_pos = 0;
 		m_get_pos = heap_size - 1;
 
+		// Skip a lap so that nothing allocated from the previous storage looks intact
+		m_lap += 2;
+
 		//allocation stats
 		m_min_guard_size = min_guard_size;
 		m_current_allocated_size = 0;
@@ -105,6 +109,7 @@ public:
 		else
 		{
 			m_put_pos = alloc_size;
+			m_lap++;
 			return 0;
 		}
 	}
@@ -147,4 +152,43 @@ public:
 	{
 		return m_size;
 	}
+
+	u64 get_lap() const
+	{
+		return m_lap;
+	}
+
+	/**
+	* Number of bytes allocated since offset, i.e how far behind put it is
+	*/
+	usz get_distance(usz offset) const
+	{
+		return (m_put_pos + m_size - offset) % m_size;
+	}
+
+	/**
+	* Checks if data allocated at offset during the given lap has not been overwritten yet
+	*/
+	bool is_intact(usz offset, u64 lap) const
+	{
+		if (lap == m_lap)
+		{
+			return offset < m_put_pos;
+		}
+
+		// Put position wrapped around but has not caught up yet
+		return (lap + 1 == m_lap) && offset > m_put_pos;
+	}
+
+	/**
+	* Moves get back to offset if needed so that intact data there is not overwritten by new allocations
+	*/
+	void reserve_from(usz offset)
+	{
+		if (m_get_pos >= m_size || get_distance(offset) > get_distance(m_get_pos))
+		{
+			m_get_pos = offset;
+			notify();
+		}
+	}
 };
@@ -333,6 +333,7 @@ namespace rsx
 		atomic_t<u32> m_flushes_this_frame = { 0 };
 		atomic_t<u32> m_misses_this_frame  = { 0 };
 		atomic_t<u32> m_speculations_this_frame = { 0 };
+		atomic_t<u32> m_speculative_hits_this_frame = { 0 };
 		atomic_t<u32> m_unavoidable_hard_faults_this_frame = { 0 };
 		atomic_t<u32> m_texture_upload_calls_this_frame = { 0 };
 		atomic_t<u32> m_texture_upload_misses_this_frame = { 0 };
@@ -952,19 +953,33 @@ namespace rsx
 
 	public:
 
-		texture_cache() : m_storage(this), m_predictor(this) {}
+		texture_cache() : m_storage(this), m_predictor(this)
+		{
+			if (const std::string cache_dir = Emu.PPUCache(); !cache_dir.empty())
+			{
+				m_predictor.load(cache_dir + fmt::format("texture_predictor_%s.dat", g_cfg.video.renderer.get()));
+			}
+		}
+
 		~texture_cache() = default;
 
 		void clear()
 		{
 			m_storage.clear();
+
+			// Keep what was learned for the next session
+			m_predictor.save();
 			m_predictor.clear();
 		}
 
 		virtual void on_frame_end()
 		{
 			m_temporary_subresource_cache.clear();
-			m_predictor.on_frame_end();
+			{
+				// Predictor entries may be evicted
+				std::lock_guard lock(m_cache_mutex);
+				m_predictor.on_frame_end();
+			}
 			reset_frame_statistics();
 		}
 
@@ -2968,6 +2983,7 @@ namespace rsx
 			m_flushes_this_frame.store(0u);
 			m_misses_this_frame.store(0u);
 			m_speculations_this_frame.store(0u);
+			m_speculative_hits_this_frame.store(0u);
 			m_unavoidable_hard_faults_this_frame.store(0u);
 			m_texture_upload_calls_this_frame.store(0u);
 			m_texture_upload_misses_this_frame.store(0u);
@@ -2983,6 +2999,11 @@ namespace rsx
 			m_speculations_this_frame++;
 		}
 
+		void on_speculative_hit()
+		{
+			m_speculative_hits_this_frame++;
+		}
+
 		void on_misprediction()
 		{
 			m_predictor.on_misprediction();
@@ -3023,6 +3044,11 @@ namespace rsx
 			return m_speculations_this_frame;
 		}
 
+		u32 get_num_cache_speculative_hits() const
+		{
+			return m_speculative_hits_this_frame;
+		}
+
 		u32 get_num_cache_misses() const
 		{
 			return m_misses_this_frame;
@@ -5,6 +5,7 @@
 #include "TextureUtils.h"
 
 #include <unordered_map>
+#include <algorithm>
 
 namespace rsx
 {
@@ -68,6 +69,21 @@ namespace rsx
 		}
 	};
 
+	/**
+	 * Predictor entry as stored in the on-disk profile
+	 */
+	struct texture_cache_predictor_persistent_entry
+	{
+		u32 start;
+		u32 end;
+		u32 format;
+		u32 context;
+		u32 confidence;
+		u32 activity;
+		u32 history_size;
+		u32 history[16];
+	};
+
 	/**
 	 * Predictor key
 	 */
@@ -138,6 +154,10 @@ namespace rsx
 
 		u32 confidence;
 
+		// Number of recent flushes and writes, halved periodically. Entries that decay to zero may be evicted.
+		static const u32 max_activity = 0xffff;
+		u32 m_activity = 0;
+
 	public:
 		texture_cache_predictor_entry(key_type _key)
 			: key(std::move(_key))
@@ -156,6 +176,16 @@ namespace rsx
 			return confidence >= confident_threshold;
 		}
 
+		u32 get_activity() const
+		{
+			return m_activity;
+		}
+
+		void decay()
+		{
+			m_activity >>= 1;
+		}
+
 		bool key_matches(const key_type& other_key) const
 		{
 			return key == other_key;
@@ -260,17 +290,62 @@ namespace rsx
 			}
 		}
 
+		void touch()
+		{
+			if (m_activity < max_activity)
+			{
+				m_activity++;
+			}
+		}
+
 	public:
 		void reset()
 		{
 			confidence                = starting_confidence;
 			m_writes_since_last_flush = 0;
 			m_guessed_writes          = UINT32_MAX;
+			m_activity                = 0;
 			write_history.clear();
 		}
 
+		// Persistence
+		void save(texture_cache_predictor_persistent_entry& out) const
+		{
+			static_assert(sizeof(out.history) / sizeof(u32) == max_write_history_size);
+
+			out.start        = key.cpu_range.start;
+			out.end          = key.cpu_range.end;
+			out.format       = static_cast<u32>(key.format);
+			out.context      = static_cast<u32>(key.context);
+			out.confidence   = confidence;
+			out.activity     = m_activity;
+			out.history_size = ::size32(write_history);
+
+			for (u32 i = 0; i < max_write_history_size; i++)
+			{
+				out.history[i] = i < out.history_size ? write_history[i] : 0;
+			}
+		}
+
+		void load(const texture_cache_predictor_persistent_entry& in)
+		{
+			reset();
+
+			// Whatever was learned in a previous session has to be confirmed once before it is acted upon again
+			confidence = std::min(in.confidence, confident_threshold - 1);
+			m_activity = std::min(in.activity, max_activity);
+
+			for (u32 i = std::min(in.history_size, max_write_history_size); i > 0; i--)
+			{
+				write_history.push(in.history[i - 1]);
+			}
+
+			calculate_next_guess(true);
+		}
+
 		void on_flush()
 		{
+			touch();
 			update_confidence(is_flush_likely() ? confidence_guessed_flush : confidence_incorrect_guess);
 
 			// Update history
@@ -282,6 +357,8 @@ namespace rsx
 
 		void on_write(bool mispredict)
 		{
+			touch();
+
 			if (mispredict || is_flush_likely())
 			{
 				update_confidence(mispredict ? confidence_mispredict : confidence_incorrect_guess);
@@ -333,10 +410,23 @@ namespace rsx
 		using const_iterator = typename map_type::const_iterator;
 
 	private:
+		static const u32 max_entries           = 16384; // Table size above which decayed entries are evicted
+		static const u32 max_persisted_entries = 4096;  // Most active entries kept in the on-disk profile
+		static const u32 decay_interval        = 600;   // Frames between two decay passes
+
+		static const u32 profile_magic   = "TCPP"_u32;
+		static const u32 profile_version = 1;
+
 		// Member variables
 		map_type m_entries;
 		texture_cache_type* m_tex_cache;
 
+		std::string m_profile_path;
+		u32 m_frames_since_decay = 0;
+
+		// Incremented whenever entries are evicted; sections must then look up their entry again
+		u32 m_generation = 0;
+
 	public:
 		// Per-frame statistics
 		atomic_t<u32> m_mispredictions_this_frame = {0};
@@ -355,7 +445,8 @@ namespace rsx
 		inline const_iterator at(size_type pos) const { return m_entries.at(pos); }
 		bool empty() const noexcept { return m_entries.empty(); }
 		size_type size() const noexcept { return m_entries.size(); }
-		void clear() { m_entries.clear(); }
+		void clear() { m_entries.clear(); m_generation++; }
+		u32 get_generation() const { return m_generation; }
 
 		mapped_type& operator[](const key_type& key)
 		{
@@ -372,6 +463,121 @@ namespace rsx
 		void on_frame_end()
 		{
 			m_mispredictions_this_frame = 0;
+
+			if (++m_frames_since_decay >= decay_interval)
+			{
+				m_frames_since_decay = 0;
+				decay();
+			}
+		}
+
+		void decay()
+		{
+			for (auto& entry : m_entries)
+			{
+				entry.second.decay();
+			}
+
+			if (m_entries.size() <= max_entries)
+			{
+				return;
+			}
+
+			const auto old_size = m_entries.size();
+			std::erase_if(m_entries, [](const value_type& entry) { return entry.second.get_activity() == 0; });
+
+			if (m_entries.size() != old_size)
+			{
+				m_generation++;
+				rsx_log.trace("Texture cache predictor: evicted %u idle entries", old_size - m_entries.size());
+			}
+		}
+
+		// Persistence
+		void load(const std::string& path)
+		{
+			m_profile_path = path;
+
+			fs::file profile(path);
+
+			if (!profile)
+			{
+				return;
+			}
+
+			u32 header[3]{};
+			std::vector<texture_cache_predictor_persistent_entry> entries;
+
+			if (!profile.read(header) || header[0] != profile_magic || header[1] != profile_version || !profile.read(entries, std::min(header[2], max_persisted_entries)))
+			{
+				rsx_log.warning("Texture cache predictor: ignoring invalid profile %s", path);
+				return;
+			}
+
+			for (const auto& data : entries)
+			{
+				// Halve the activity of every session old entry so that stale knowledge eventually goes away
+				if (data.activity < 2 || data.start > data.end)
+				{
+					continue;
+				}
+
+				const key_type key(address_range::start_end(data.start, data.end), static_cast<typename traits::texture_format>(data.format), static_cast<texture_upload_context>(data.context));
+				auto& entry = (*this)[key];
+				entry.load(data);
+				entry.decay();
+			}
+
+			rsx_log.notice("Texture cache predictor: loaded %u entries from %s", m_entries.size(), path);
+		}
+
+		void save() const
+		{
+			if (m_profile_path.empty())
+			{
+				return;
+			}
+
+			std::vector<const mapped_type*> active;
+
+			for (const auto& entry : m_entries)
+			{
+				if (entry.second.get_activity())
+				{
+					active.push_back(&entry.second);
+				}
+			}
+
+			if (active.size() > max_persisted_entries)
+			{
+				std::partial_sort(active.begin(), active.begin() + max_persisted_entries, active.end(), [](const mapped_type* a, const mapped_type* b)
+				{
+					return a->get_activity() > b->get_activity();
+				});
+
+				active.resize(max_persisted_entries);
+			}
+
+			std::vector<texture_cache_predictor_persistent_entry> entries(active.size());
+
+			for (usz i = 0; i < active.size(); i++)
+			{
+				active[i]->save(entries[i]);
+			}
+
+			const u32 header[3]{ profile_magic, profile_version, ::size32(entries) };
+
+			fs::file profile(m_profile_path, fs::rewrite);
+
+			if (!profile)
+			{
+				rsx_log.error("Texture cache predictor: failed to save profile %s (%s)", m_profile_path, fs::g_tls_error);
+				return;
+			}
+
+			profile.write(header);
+			profile.write(entries);
+			rsx_log.notice("Texture cache predictor: saved %u entries to %s", entries.size(), m_profile_path);
 		}
 
 		void on_misprediction()
@@ -919,6 +919,7 @@ namespace rsx
 		predictor_type *m_predictor = nullptr;
 		usz m_predictor_key_hash = 0;
 		predictor_entry_type *m_predictor_entry = nullptr;
+		u32 m_predictor_generation = 0;
 
 	public:
 		u64 cache_tag = 0;
@@ -1245,6 +1246,12 @@ namespace rsx
 
 		void on_flush()
 		{
+			if (speculatively_flushed)
+			{
+				// Data was read back ahead of time, this flush did not have to wait for the GPU
+				m_tex_cache->on_speculative_hit();
+			}
+
 			speculatively_flushed = false;
 
 			m_tex_cache->on_flush();
@@ -1440,10 +1447,11 @@ namespace rsx
 	public:
 		predictor_entry_type& get_predictor_entry()
 		{
-			// If we don't have a predictor entry, or the key has changed
-			if (m_predictor_entry == nullptr || !m_predictor_entry->key_matches(*derived()))
+			// If we don't have a predictor entry, the key has changed or the entry may have been evicted
+			if (m_predictor_entry == nullptr || m_predictor_generation != m_predictor->get_generation() || !m_predictor_entry->key_matches(*derived()))
 			{
 				m_predictor_entry = &((*m_predictor)[*derived()]);
+				m_predictor_generation = m_predictor->get_generation();
 			}
 			return *m_predictor_entry;
 		}
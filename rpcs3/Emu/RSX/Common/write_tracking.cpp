@@ -0,0 +1,418 @@
+#include "stdafx.h"
+#include "write_tracking.h"
+
+#include "Emu/Memory/vm.h"
+#include "Utilities/mutex.h"
+
+#include "util/logs.hpp"
+#include "util/atomic.hpp"
+
+#include <memory>
+#include <algorithm>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <linux/userfaultfd.h>
+#include <linux/fs.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+// Asynchronous write-protection and PAGEMAP_SCAN are required, older kernel headers lack them
+#if defined(UFFD_FEATURE_WP_ASYNC) && defined(PAGEMAP_SCAN)
+#define RSX_WRITE_TRACKING_UFFD
+#endif
+#endif
+
+namespace rsx::write_tracking
+{
+#ifdef RSX_WRITE_TRACKING_UFFD
+	static atomic_t<int> s_uffd = -1;
+	static int s_pagemap = -1;
+
+	// Serializes registration changes and owner bookkeeping
+	static shared_mutex s_mutex;
+
+	// Owner mask of every 4k page of the guest address space
+	static std::unique_ptr<u8[]> s_owners;
+
+	// Writes discovered while re-arming already tracked pages, reported by the next collect()
+	static std::vector<utils::address_range> s_pending;
+	static u32 s_pending_pages = 0;
+
+	// Bounds of the guest memory currently tracked, used to limit the scans
+	static atomic_t<u32> s_tracked_start = 0xffffffff;
+	static atomic_t<u32> s_tracked_end = 0;
+
+	static inline u64 host_address(u32 addr)
+	{
+		return reinterpret_cast<u64>(vm::base(addr));
+	}
+
+	// Reports the written pages of [start, end] and write-protects them again
+	static u32 scan_written(u32 start, u32 end, std::vector<utils::address_range>& out)
+	{
+		page_region regions[64];
+
+		pm_scan_arg arg{};
+		arg.size = sizeof(arg);
+		// Written pages are write-protected again atomically; unregistered mappings in between are skipped
+		arg.flags = PM_SCAN_WP_MATCHING;
+		arg.start = host_address(start);
+		arg.end = host_address(end) + 1;
+		arg.vec = reinterpret_cast<u64>(regions);
+		arg.vec_len = std::size(regions);
+		arg.category_mask = PAGE_IS_WRITTEN;
+		arg.return_mask = PAGE_IS_WRITTEN;
+
+		const u64 base = host_address(0);
+		u32 pages = 0;
+
+		while (true)
+		{
+			const int count = ::ioctl(s_pagemap, PAGEMAP_SCAN, &arg);
+
+			if (count < 0)
+			{
+				rsx_log.error("Write tracking: PAGEMAP_SCAN failed (errno=%d)", errno);
+				break;
+			}
+
+			for (int i = 0; i < count; i++)
+			{
+				const u32 region_start = static_cast<u32>(regions[i].start - base);
+				const u32 region_end = static_cast<u32>(regions[i].end - base);
+
+				out.push_back(utils::address_range::start_end(region_start, region_end - 1));
+				pages += (region_end - region_start) / 4096;
+			}
+
+			if (arg.walk_end >= arg.end)
+			{
+				break;
+			}
+
+			// Output vector was full
+			arg.start = arg.walk_end;
+		}
+
+		return pages;
+	}
+
+	// Removes the owner from the pages of [start, end] and unregisters the pages nobody is interested in anymore
+	static void release_pages(u32 start, u32 end, owner who)
+	{
+		// Page aligned, so it can't collide with a real run start
+		constexpr u32 no_run = 0xffffffff;
+		u32 run_start = no_run;
+
+		const auto unregister_run = [&](u64 run_end)
+		{
+			if (run_start != no_run)
+			{
+				uffdio_range unreg{};
+				unreg.start = host_address(run_start);
+				unreg.len = run_end - run_start;
+				::ioctl(s_uffd, UFFDIO_UNREGISTER, &unreg);
+				run_start = no_run;
+			}
+		};
+
+		for (u32 page = start / 4096; page <= end / 4096; page++)
+		{
+			u8& owners = s_owners[page];
+
+			if (owners && !(owners &= ~who))
+			{
+				if (run_start == no_run)
+				{
+					run_start = page * 4096;
+				}
+			}
+			else
+			{
+				unregister_run(page * 4096ull);
+			}
+		}
+
+		unregister_run((end / 4096 + 1) * 4096ull);
+
+		// Shrink the scanned span if its edges aren't tracked anymore
+		u32 first = s_tracked_start / 4096;
+		u32 last = s_tracked_end / 4096;
+
+		if (first > last || (start / 4096 > first && end / 4096 < last))
+		{
+			return;
+		}
+
+		while (first <= last && !s_owners[first])
+		{
+			first++;
+		}
+
+		while (last >= first && !s_owners[last])
+		{
+			last--;
+		}
+
+		if (first > last)
+		{
+			s_tracked_start = 0xffffffff;
+			s_tracked_end = 0;
+			return;
+		}
+
+		s_tracked_start = first * 4096;
+		s_tracked_end = last * 4096 + 4095;
+	}
+
+	// Sorts the ranges appended after the position and merges the adjacent ones
+	static void coalesce(std::vector<utils::address_range>& out, usz pos)
+	{
+		std::sort(out.begin() + pos, out.end(), [](const utils::address_range& a, const utils::address_range& b)
+		{
+			return a.start < b.start;
+		});
+
+		usz last = pos;
+
+		for (usz i = pos + 1; i < out.size(); i++)
+		{
+			if (out[i].start <= out[last].end + 1ull)
+			{
+				out[last].end = std::max(out[last].end, out[i].end);
+			}
+			else
+			{
+				out[++last] = out[i];
+			}
+		}
+
+		if (last + 1 < out.size())
+		{
+			out.resize(last + 1);
+		}
+	}
+#endif
+
+	bool init()
+	{
+#ifdef RSX_WRITE_TRACKING_UFFD
+		if (s_uffd >= 0)
+		{
+			return true;
+		}
+
+		// User mode only is sufficient since write faults are resolved by the kernel in async mode
+		const int uffd = static_cast<int>(::syscall(__NR_userfaultfd, O_CLOEXEC | O_NONBLOCK | UFFD_USER_MODE_ONLY));
+
+		if (uffd < 0)
+		{
+			rsx_log.error("Write tracking: userfaultfd() failed (errno=%d)", errno);
+			return false;
+		}
+
+		uffdio_api api{};
+		api.api = UFFD_API;
+		api.features = UFFD_FEATURE_WP_ASYNC | UFFD_FEATURE_WP_HUGETLBFS_SHMEM | UFFD_FEATURE_WP_UNPOPULATED;
+
+		if (::ioctl(uffd, UFFDIO_API, &api) != 0)
+		{
+			rsx_log.error("Write tracking: asynchronous write-protection is not supported by the kernel (errno=%d)", errno);
+			::close(uffd);
+			return false;
+		}
+
+		const int pagemap = ::open("/proc/self/pagemap", O_RDONLY | O_CLOEXEC);
+
+		if (pagemap < 0)
+		{
+			rsx_log.error("Write tracking: failed to open /proc/self/pagemap (errno=%d)", errno);
+			::close(uffd);
+			return false;
+		}
+
+		std::lock_guard lock(s_mutex);
+
+		s_pagemap = pagemap;
+		s_owners = std::make_unique<u8[]>(0x100000);
+		s_pending.clear();
+		s_pending_pages = 0;
+		s_tracked_start = 0xffffffff;
+		s_tracked_end = 0;
+		s_uffd = uffd;
+
+		rsx_log.notice("Write tracking: using asynchronous userfaultfd write-protection");
+		return true;
+#else
+		rsx_log.error("Write tracking: asynchronous write tracking is not supported on this platform");
+		return false;
+#endif
+	}
+
+	void shutdown()
+	{
+#ifdef RSX_WRITE_TRACKING_UFFD
+		std::lock_guard lock(s_mutex);
+
+		// Closing the descriptor unregisters every tracked range
+		if (const int uffd = s_uffd.exchange(-1); uffd >= 0)
+		{
+			::close(uffd);
+			::close(s_pagemap);
+			s_pagemap = -1;
+			s_owners.reset();
+			s_pending.clear();
+		}
+#endif
+	}
+
+	bool is_active()
+	{
+#ifdef RSX_WRITE_TRACKING_UFFD
+		return s_uffd >= 0;
+#else
+		return false;
+#endif
+	}
+
+	bool protect(const utils::address_range& range, owner who)
+	{
+#ifdef RSX_WRITE_TRACKING_UFFD
+		if (s_uffd < 0)
+		{
+			return false;
+		}
+
+		std::lock_guard lock(s_mutex);
+
+		const int uffd = s_uffd;
+
+		if (uffd < 0)
+		{
+			return false;
+		}
+
+		// Pages already tracked for someone may have been written since the last scan; keep those writes
+		if (range.start <= s_tracked_end && range.end >= s_tracked_start)
+		{
+			s_pending_pages += scan_written(range.start, range.end, s_pending);
+		}
+
+		uffdio_register reg{};
+		reg.range.start = host_address(range.start);
+		reg.range.len = range.length();
+		reg.mode = UFFDIO_REGISTER_MODE_WP;
+
+		// Mappings may have been replaced since the last time, so the range is always registered again
+		if (::ioctl(uffd, UFFDIO_REGISTER, &reg) != 0)
+		{
+			rsx_log.trace("Write tracking: failed to register range [0x%x, 0x%x] (errno=%d)", range.start, range.end, errno);
+			return false;
+		}
+
+		for (u32 page = range.start / 4096; page <= range.end / 4096; page++)
+		{
+			s_owners[page] |= who;
+		}
+
+		uffdio_writeprotect wp{};
+		wp.range = reg.range;
+		wp.mode = UFFDIO_WRITEPROTECT_MODE_WP;
+
+		if (::ioctl(uffd, UFFDIO_WRITEPROTECT, &wp) != 0)
+		{
+			rsx_log.trace("Write tracking: failed to write-protect range [0x%x, 0x%x] (errno=%d)", range.start, range.end, errno);
+
+			// Pages of other owners have to stay registered
+			release_pages(range.start, range.end, who);
+			return false;
+		}
+
+		s_tracked_start.fetch_op([&](u32& v) { v = std::min(v, range.start); });
+		s_tracked_end.fetch_op([&](u32& v) { v = std::max(v, range.end); });
+		return true;
+#else
+		static_cast<void>(range);
+		static_cast<void>(who);
+		return false;
+#endif
+	}
+
+	void unprotect(const utils::address_range& range, owner who)
+	{
+#ifdef RSX_WRITE_TRACKING_UFFD
+		if (s_uffd < 0 || range.end < s_tracked_start || range.start > s_tracked_end)
+		{
+			return;
+		}
+
+		std::lock_guard lock(s_mutex);
+
+		if (s_uffd < 0)
+		{
+			return;
+		}
+
+		release_pages(std::max<u32>(range.start, s_tracked_start), std::min<u32>(range.end, s_tracked_end), who);
+#else
+		static_cast<void>(range);
+		static_cast<void>(who);
+#endif
+	}
+
+	void unprotect_all(owner who)
+	{
+#ifdef RSX_WRITE_TRACKING_UFFD
+		std::lock_guard lock(s_mutex);
+
+		if (s_uffd < 0 || s_tracked_start > s_tracked_end)
+		{
+			return;
+		}
+
+		release_pages(s_tracked_start, s_tracked_end, who);
+#else
+		static_cast<void>(who);
+#endif
+	}
+
+	u32 collect(std::vector<utils::address_range>& out)
+	{
+#ifdef RSX_WRITE_TRACKING_UFFD
+		if (s_uffd < 0)
+		{
+			return 0;
+		}
+
+		std::lock_guard lock(s_mutex);
+
+		const u32 start = s_tracked_start;
+		const u32 end = s_tracked_end;
+
+		if (s_uffd < 0 || start > end)
+		{
+			return 0;
+		}
+
+		const usz pos = out.size();
+		const u32 pending_pages = std::exchange(s_pending_pages, 0);
+		out.insert(out.end(), s_pending.begin(), s_pending.end());
+		s_pending.clear();
+
+		const u32 pages = pending_pages + scan_written(start, end, out);
+
+		if (out.size() > pos + 1)
+		{
+			coalesce(out, pos);
+		}
+
+		return pages;
+#else
+		static_cast<void>(out);
+		return 0;
+#endif
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "Utilities/address_range.h"
+
+#include <vector>
+
+namespace rsx
+{
+	// Alternative to page protection for write-only guarded ranges of the texture and vertex caches.
+	// Guest writes to tracked pages do not fault; the written pages are collected in batches at sync points instead.
+	// Currently implemented with asynchronous userfaultfd write-protection (Linux 6.7+), unavailable elsewhere.
+	namespace write_tracking
+	{
+		// Pages stay tracked as long as any owner is interested in them
+		enum owner : u8
+		{
+			owner_texture_cache = 1,
+			owner_vertex_cache = 2,
+		};
+
+		// Returns false if the backend is not supported by the host
+		bool init();
+		void shutdown();
+
+		bool is_active();
+
+		// Starts tracking writes to the page range. Returns false if the range must be protected by other means
+		bool protect(const utils::address_range& range, owner who = owner_texture_cache);
+
+		// Stops tracking writes to the page range on behalf of the owner
+		void unprotect(const utils::address_range& range, owner who = owner_texture_cache);
+		void unprotect_all(owner who);
+
+		// Appends the page ranges written since the last call and re-arms tracking for them. Returns the number of pages.
+		u32 collect(std::vector<utils::address_range>& out);
+	}
+}
@@ -953,6 +953,18 @@ void GLGSRender::on_invalidate_memory_range(const utils::address_range &range, r
 	}
 }
 
+void GLGSRender::on_tracked_write(const utils::address_range &range)
+{
+	gl::command_context cmd{ gl_state };
+	auto data = std::move(m_gl_texture_cache.invalidate_range(cmd, range, rsx::invalidation_cause::write));
+
+	if (data.violation_handled)
+	{
+		std::lock_guard lock(m_sampler_mutex);
+		m_samplers_dirty.store(true);
+	}
+}
+
 void GLGSRender::on_semaphore_acquire_wait()
 {
 	if (!work_queue.empty() ||
@@ -305,9 +305,9 @@ void GLGSRender::flip(const rsx::display_flip_info_t& info)
 		glViewport(0, 0, m_frame->client_width(), m_frame->client_height());
 
 		m_text_printer.print_text(0,  0, m_frame->client_width(), m_frame->client_height(), fmt::format("RSX Load:                %3d%%", get_load()));
-		m_text_printer.print_text(0, 18, m_frame->client_width(), m_frame->client_height(), fmt::format("draw calls: %16d", info.stats.draw_calls));
+		m_text_printer.print_text(0, 18, m_frame->client_width(), m_frame->client_height(), fmt::format("draw calls: %16d (%u pipeline reuses)", info.stats.draw_calls, info.stats.pipeline_reuses));
 		m_text_printer.print_text(0, 36, m_frame->client_width(), m_frame->client_height(), fmt::format("draw call setup: %11dus", info.stats.setup_time));
-		m_text_printer.print_text(0, 54, m_frame->client_width(), m_frame->client_height(), fmt::format("vertex upload time: %8dus", info.stats.vertex_upload_time));
+		m_text_printer.print_text(0, 54, m_frame->client_width(), m_frame->client_height(), fmt::format("vertex upload time: %8dus (%u KiB uploaded, %u KiB reused)", info.stats.vertex_upload_time, info.stats.vertex_upload_bytes / 1024, info.stats.vertex_reused_bytes / 1024));
 		m_text_printer.print_text(0, 72, m_frame->client_width(), m_frame->client_height(), fmt::format("textures upload time: %6dus", info.stats.textures_upload_time));
 		m_text_printer.print_text(0, 90, m_frame->client_width(), m_frame->client_height(), fmt::format("draw call execution: %7dus", info.stats.draw_exec_time));
 
@@ -316,6 +316,7 @@ void GLGSRender::flip(const rsx::display_flip_info_t& info)
 		const auto num_flushes = m_gl_texture_cache.get_num_flush_requests();
 		const auto num_mispredict = m_gl_texture_cache.get_num_cache_mispredictions();
 		const auto num_speculate = m_gl_texture_cache.get_num_cache_speculative_writes();
+		const auto num_speculate_hits = m_gl_texture_cache.get_num_cache_speculative_hits();
 		const auto num_misses = m_gl_texture_cache.get_num_cache_misses();
 		const auto num_unavoidable = m_gl_texture_cache.get_num_unavoidable_hard_faults();
 		const auto cache_miss_ratio = static_cast<u32>(ceil(m_gl_texture_cache.get_cache_miss_ratio() * 100));
@@ -324,8 +325,10 @@ void GLGSRender::flip(const rsx::display_flip_info_t& info)
 		const auto texture_upload_miss_ratio = m_gl_texture_cache.get_texture_upload_miss_percentage();
 		m_text_printer.print_text(0, 126, m_frame->client_width(), m_frame->client_height(), fmt::format("Unreleased textures: %7d", num_dirty_textures));
 		m_text_printer.print_text(0, 144, m_frame->client_width(), m_frame->client_height(), fmt::format("Texture memory: %12dM", texture_memory_size));
-		m_text_printer.print_text(0, 162, m_frame->client_width(), m_frame->client_height(), fmt::format("Flush requests: %12d  = %2d (%3d%%) hard faults, %2d unavoidable, %2d misprediction(s), %2d speculation(s)", num_flushes, num_misses, cache_miss_ratio, num_unavoidable, num_mispredict, num_speculate));
+		m_text_printer.print_text(0, 162, m_frame->client_width(), m_frame->client_height(), fmt::format("Flush requests: %12d  = %2d (%3d%%) hard faults, %2d unavoidable, %2d misprediction(s), %2d speculation(s) (%2d hit)", num_flushes, num_misses, cache_miss_ratio, num_unavoidable, num_mispredict, num_speculate, num_speculate_hits));
 		m_text_printer.print_text(0, 180, m_frame->client_width(), m_frame->client_height(), fmt::format("Texture uploads: %15u (%u from CPU - %02u%%)", num_texture_upload, num_texture_upload_miss, texture_upload_miss_ratio));
+		m_text_printer.print_text(0, 198, m_frame->client_width(), m_frame->client_height(), fmt::format("Write faults: %18u (%dus), %u tracked page(s) (%dus)", info.stats.write_faults, info.stats.write_fault_time, info.stats.tracked_dirty_pages, info.stats.write_tracking_time));
+		m_text_printer.print_text(0, 216, m_frame->client_width(), m_frame->client_height(), fmt::format("DMA queue depth: %15u (%uus average latency)", info.stats.dma_queue_depth, info.stats.dma_queue_latency));
 	}
 
 	m_frame->flip(m_context);
@@ -219,10 +219,15 @@ gl::vertex_upload_info GLGSRender::set_vertex_buffer()
 			if (to_store)
 			{
 				//store ref in vertex cache
-				m_vertex_cache->store_range(storage_address, GL_R8UI, required.first, persistent_mapping.second);
+				m_vertex_cache->store_range(storage_address, GL_R8UI, required.first, persistent_mapping.second, 0);
 			}
 		}
 
+		if (in_cache)
+			m_frame_stats.vertex_reused_bytes += required.first;
+		else
+			m_frame_stats.vertex_upload_bytes += required.first;
+
 		if (!m_persistent_stream_view.in_range(upload_info.persistent_mapping_offset, required.first, upload_info.persistent_mapping_offset))
 		{
 			ensure(m_max_texbuffer_size < m_attrib_ring_buffer->size());
@@ -237,6 +242,8 @@ gl::vertex_upload_info GLGSRender::set_vertex_buffer()
 
 	if (required.second > 0)
 	{
+		m_frame_stats.vertex_upload_bytes += required.second;
+
 		volatile_mapping = m_attrib_ring_buffer->alloc_from_heap(required.second, m_min_texbuffer_alignment);
 		upload_info.volatile_mapping_offset = volatile_mapping.second;
 
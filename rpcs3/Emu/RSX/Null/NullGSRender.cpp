@@ -1,6 +1,183 @@
 #include "stdafx.h"
 #include "NullGSRender.h"
 
+#include "Emu/RSX/Common/BufferUtils.h"
+#include "Emu/RSX/Common/TextureUtils.h"
+#include "Emu/RSX/Common/surface_store.h"
+#include "Emu/RSX/RSXOffload.h"
+#include "Emu/RSX/rsx_methods.h"
+#include "Emu/system_config.h"
+
+#include "util/sysinfo.hpp"
+
+namespace
+{
+	constexpr u32 restart_marker = 0xffffffff;
+
+	// Upper bound of the vertices shaded per sub-draw, larger index ranges are most likely garbage
+	constexpr u32 max_shaded_vertices = 0x100000;
+
+	bool is_supported_color_format(rsx::surface_color_format format)
+	{
+		switch (format)
+		{
+		case rsx::surface_color_format::r5g6b5:
+		case rsx::surface_color_format::x8r8g8b8_z8r8g8b8:
+		case rsx::surface_color_format::x8r8g8b8_o8r8g8b8:
+		case rsx::surface_color_format::a8r8g8b8:
+		case rsx::surface_color_format::x8b8g8r8_z8b8g8r8:
+		case rsx::surface_color_format::x8b8g8r8_o8b8g8r8:
+		case rsx::surface_color_format::a8b8g8r8:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	// Describes one fragment texture unit for the shader interpreter, unsupported textures read as zero
+	void init_texture(rsx::sw::texture_env& env, const rsx::fragment_texture& tex)
+	{
+		env = {};
+
+		if (!tex.enabled() || tex.get_extended_texture_dimension() > rsx::texture_dimension_extended::texture_dimension_2d)
+		{
+			return;
+		}
+
+		const u32 format = tex.format() & ~(CELL_GCM_TEXTURE_LN | CELL_GCM_TEXTURE_UN);
+		const u16 width = tex.width();
+		const u16 height = tex.height();
+		u32 bpp = 0;
+
+		switch (format)
+		{
+		case CELL_GCM_TEXTURE_B8:
+			bpp = 1;
+			break;
+		case CELL_GCM_TEXTURE_A1R5G5B5:
+		case CELL_GCM_TEXTURE_A4R4G4B4:
+		case CELL_GCM_TEXTURE_R5G6B5:
+		case CELL_GCM_TEXTURE_R5G5B5A1:
+		case CELL_GCM_TEXTURE_D1R5G5B5:
+			bpp = 2;
+			break;
+		case CELL_GCM_TEXTURE_A8R8G8B8:
+		case CELL_GCM_TEXTURE_D8R8G8B8:
+			bpp = 4;
+			break;
+		case CELL_GCM_TEXTURE_COMPRESSED_DXT1:
+		case CELL_GCM_TEXTURE_COMPRESSED_DXT23:
+		case CELL_GCM_TEXTURE_COMPRESSED_DXT45:
+			break;
+		default:
+			// Not implemented
+			return;
+		}
+
+		if (!width || !height)
+		{
+			return;
+		}
+
+		u32 size = 0;
+
+		if (!bpp)
+		{
+			// Compressed textures are never swizzled and their rows of blocks are tightly packed
+			env.pitch = utils::aligned_div<u32>(width, 4) * (format == CELL_GCM_TEXTURE_COMPRESSED_DXT1 ? 8 : 16);
+			size = env.pitch * utils::aligned_div<u32>(height, 4);
+		}
+		else if (!(tex.format() & CELL_GCM_TEXTURE_LN))
+		{
+			env.swizzled = true;
+			env.log2_width = static_cast<u8>(rsx::ceil_log2(width));
+			env.log2_height = static_cast<u8>(rsx::ceil_log2(height));
+			size = bpp << (env.log2_width + env.log2_height);
+		}
+		else
+		{
+			env.pitch = tex.pitch() ? tex.pitch() : width * bpp;
+			size = env.pitch * (height - 1) + width * bpp;
+		}
+
+		const u32 address = rsx::get_address(tex.offset(), tex.location());
+
+		if (!address || !vm::check_addr(address, vm::page_readable, size))
+		{
+			return;
+		}
+
+		env.data = vm::get_super_ptr<u8>(address);
+		env.format = format;
+		env.width = width;
+		env.height = height;
+		env.normalized = !(tex.format() & CELL_GCM_TEXTURE_UN);
+		env.linear_filter = tex.mag_filter() != rsx::texture_magnify_filter::nearest;
+		env.wrap_s = tex.wrap_s();
+		env.wrap_t = tex.wrap_t();
+		std::tie(env.remap_source, env.remap_control) = tex.decoded_remap();
+		env.sign_expand = { tex.r_signed(), tex.g_signed(), tex.b_signed(), tex.a_signed() };
+
+		const auto border = rsx::decode_border_color(tex.border_color());
+		env.border_color = { border.a, border.r, border.g, border.b };
+	}
+
+	// Converts one run of vertex ids without restarts into a triangle list of shaded vertex slots
+	void assemble_triangles(rsx::primitive_type primitive, const u32* ids, u32 count, u32 index_base, u32 vertex_count, std::vector<u32>& out)
+	{
+		const auto emit = [&](u32 a, u32 b, u32 c)
+		{
+			const u32 v0 = ids[a] - index_base;
+			const u32 v1 = ids[b] - index_base;
+			const u32 v2 = ids[c] - index_base;
+
+			if (v0 < vertex_count && v1 < vertex_count && v2 < vertex_count)
+			{
+				out.push_back(v0);
+				out.push_back(v1);
+				out.push_back(v2);
+			}
+		};
+
+		switch (primitive)
+		{
+		case rsx::primitive_type::triangles:
+			for (u32 i = 0; i + 2 < count; i += 3)
+			{
+				emit(i, i + 1, i + 2);
+			}
+			break;
+		case rsx::primitive_type::triangle_strip:
+		case rsx::primitive_type::quad_strip:
+			for (u32 i = 0; i + 2 < count; ++i)
+			{
+				if (i & 1)
+					emit(i + 1, i, i + 2);
+				else
+					emit(i, i + 1, i + 2);
+			}
+			break;
+		case rsx::primitive_type::triangle_fan:
+		case rsx::primitive_type::polygon:
+			for (u32 i = 1; i + 1 < count; ++i)
+			{
+				emit(0, i, i + 1);
+			}
+			break;
+		case rsx::primitive_type::quads:
+			for (u32 i = 0; i + 3 < count; i += 4)
+			{
+				emit(i, i + 1, i + 2);
+				emit(i, i + 2, i + 3);
+			}
+			break;
+		default:
+			// Points and lines are not rasterized
+			break;
+		}
+	}
+}
+
 u64 NullGSRender::get_cycles()
 {
 	return thread_ctrl::get_cycles(static_cast<named_thread<NullGSRender>&>(*this));
@@ -10,8 +187,500 @@ NullGSRender::NullGSRender() : GSRender()
 {
 }
 
+void NullGSRender::on_init_thread()
+{
+	GSRender::on_init_thread();
+
+	if (g_cfg.video.null_software_rasterizer)
+	{
+		const u32 thread_count = std::max<u32>(utils::get_thread_count() / 2, 1);
+		m_rasterizer = std::make_unique<rsx::sw::rasterizer>(thread_count);
+
+		rsx_log.notice("Null renderer: software rasterizer enabled with %u threads", thread_count);
+	}
+}
+
+void NullGSRender::on_exit()
+{
+	m_rasterizer.reset();
+
+	GSRender::on_exit();
+}
+
+bool NullGSRender::init_render_target(rsx::sw::render_target& target)
+{
+	const auto& layout = m_framebuffer_layout;
+
+	if (layout.raster_type == rsx::surface_raster_type::swizzle || layout.aa_mode != rsx::surface_antialiasing::center_1_sample)
+	{
+		// Not implemented
+		return false;
+	}
+
+	target = {};
+	target.width = layout.width;
+	target.height = layout.height;
+	target.color_format = layout.color_format;
+	target.depth_format = layout.depth_format;
+
+	const u32 color_bpp = (layout.color_format == rsx::surface_color_format::r5g6b5) ? 2 : 4;
+	const auto rtt_indexes = rsx::utility::get_rtt_indexes(layout.target);
+	bool has_target = false;
+
+	for (u32 i = 0; i < rtt_indexes.size(); ++i)
+	{
+		const u8 index = rtt_indexes[i];
+		const u32 address = layout.color_addresses[index];
+		const u32 pitch = layout.actual_color_pitch[index];
+
+		if (!address || !is_supported_color_format(layout.color_format) || pitch < layout.width * color_bpp ||
+			!vm::check_addr(address, vm::page_writable, pitch * layout.height))
+		{
+			continue;
+		}
+
+		target.color[i] = vm::get_super_ptr<u8>(address);
+		target.color_pitch[i] = pitch;
+		has_target = true;
+	}
+
+	// Float depth is not implemented
+	if (const u32 address = layout.zeta_address; address &&
+		(layout.depth_format == rsx::surface_depth_format2::z16_uint || layout.depth_format == rsx::surface_depth_format2::z24s8_uint))
+	{
+		const u32 bpp = (layout.depth_format == rsx::surface_depth_format2::z16_uint) ? 2 : 4;
+		const u32 pitch = layout.actual_zeta_pitch;
+
+		if (pitch >= layout.width * bpp && vm::check_addr(address, vm::page_writable, pitch * layout.height))
+		{
+			target.zeta = vm::get_super_ptr<u8>(address);
+			target.zeta_pitch = pitch;
+			has_target = true;
+		}
+	}
+
+	const u16 scissor_x = rsx::method_registers.scissor_origin_x();
+	const u16 scissor_y = rsx::method_registers.scissor_origin_y();
+	target.x0 = std::min(scissor_x, target.width);
+	target.y0 = std::min(scissor_y, target.height);
+	target.x1 = static_cast<u16>(std::min<u32>(scissor_x + rsx::method_registers.scissor_width(), target.width));
+	target.y1 = static_cast<u16>(std::min<u32>(scissor_y + rsx::method_registers.scissor_height(), target.height));
+
+	return has_target;
+}
+
+bool NullGSRender::init_draw_state()
+{
+	auto& state = m_draw_state;
+
+	if (!current_fragment_program.valid || !init_render_target(state.target))
+	{
+		return false;
+	}
+
+	auto& env = state.fragment_env;
+	env.ucode = static_cast<const u32*>(current_fragment_program.get_data());
+	env.ucode_length = current_fragment_program.ucode_length;
+	env.shader_control = rsx::method_registers.shader_control();
+	env.fog_param0 = rsx::method_registers.fog_params_0();
+	env.fog_param1 = rsx::method_registers.fog_params_1();
+	env.fog_mode = static_cast<u32>(rsx::method_registers.fog_equation());
+
+	const bool origin_top = rsx::method_registers.shader_window_origin() == rsx::window_origin::top;
+	env.wpos_scale = origin_top ? 1.f : -1.f;
+	env.wpos_bias = origin_top ? 0.f : rsx::method_registers.shader_window_height();
+
+	env.alpha_test = rsx::method_registers.alpha_test_enabled();
+	env.alpha_func = rsx::method_registers.alpha_func();
+	env.alpha_ref = rsx::method_registers.alpha_ref();
+
+	for (u32 i = 0; i < env.textures.size(); ++i)
+	{
+		init_texture(env.textures[i], rsx::method_registers.fragment_textures[i]);
+	}
+
+	state.depth_test = rsx::method_registers.depth_test_enabled();
+	state.depth_write = rsx::method_registers.depth_write_enabled();
+	state.depth_func = rsx::method_registers.depth_func();
+
+	state.stencil_test = rsx::method_registers.stencil_test_enabled();
+	state.stencil[0] =
+	{
+		rsx::method_registers.stencil_func(),
+		rsx::method_registers.stencil_func_ref(),
+		rsx::method_registers.stencil_func_mask(),
+		rsx::method_registers.stencil_mask(),
+		rsx::method_registers.stencil_op_fail(),
+		rsx::method_registers.stencil_op_zfail(),
+		rsx::method_registers.stencil_op_zpass()
+	};
+
+	if (rsx::method_registers.two_sided_stencil_test_enabled())
+	{
+		state.stencil[1] =
+		{
+			rsx::method_registers.back_stencil_func(),
+			rsx::method_registers.back_stencil_func_ref(),
+			rsx::method_registers.back_stencil_func_mask(),
+			rsx::method_registers.back_stencil_mask(),
+			rsx::method_registers.back_stencil_op_fail(),
+			rsx::method_registers.back_stencil_op_zfail(),
+			rsx::method_registers.back_stencil_op_zpass()
+		};
+	}
+	else
+	{
+		state.stencil[1] = state.stencil[0];
+	}
+
+	const auto rtt_indexes = rsx::utility::get_rtt_indexes(m_framebuffer_layout.target);
+
+	for (u32 i = 0; i < rtt_indexes.size(); ++i)
+	{
+		const int index = rtt_indexes[i];
+		state.color_mask[i] =
+		{
+			rsx::method_registers.color_mask_r(index),
+			rsx::method_registers.color_mask_g(index),
+			rsx::method_registers.color_mask_b(index),
+			rsx::method_registers.color_mask_a(index)
+		};
+	}
+
+	const std::array<bool, 4> blend_enabled =
+	{
+		rsx::method_registers.blend_enabled(),
+		rsx::method_registers.blend_enabled_surface_1(),
+		rsx::method_registers.blend_enabled_surface_2(),
+		rsx::method_registers.blend_enabled_surface_3()
+	};
+
+	state.blend_enabled = {};
+
+	for (u32 i = 0; i < rtt_indexes.size(); ++i)
+	{
+		state.blend_enabled[i] = blend_enabled[rtt_indexes[i]];
+	}
+
+	state.blend_sfactor_rgb = rsx::method_registers.blend_func_sfactor_rgb();
+	state.blend_sfactor_a = rsx::method_registers.blend_func_sfactor_a();
+	state.blend_dfactor_rgb = rsx::method_registers.blend_func_dfactor_rgb();
+	state.blend_dfactor_a = rsx::method_registers.blend_func_dfactor_a();
+	state.blend_equation_rgb = rsx::method_registers.blend_equation_rgb();
+	state.blend_equation_a = rsx::method_registers.blend_equation_a();
+	state.blend_color = rsx::get_constant_blend_colors();
+
+	state.cull_enabled = rsx::method_registers.cull_face_enabled();
+	state.cull_mode = rsx::method_registers.cull_face_mode();
+	state.front_ccw = rsx::method_registers.front_face_mode() == rsx::front_face::ccw;
+
+	state.viewport_scale = { rsx::method_registers.viewport_scale_x(), rsx::method_registers.viewport_scale_y(), rsx::method_registers.viewport_scale_z() };
+	state.viewport_offset = { rsx::method_registers.viewport_offset_x(), rsx::method_registers.viewport_offset_y(), rsx::method_registers.viewport_offset_z() };
+	state.depth_clamp = rsx::method_registers.depth_clamp_enabled();
+	state.depth_clip = rsx::method_registers.depth_clip_enabled();
+
+	return true;
+}
+
 void NullGSRender::end()
 {
-	execute_nop_draw();
+	if (!m_rasterizer || skip_current_frame || cond_render_ctrl.disable_rendering())
+	{
+		execute_nop_draw();
+		rsx::thread::end();
+		return;
+	}
+
+	get_framebuffer_layout(rsx::framebuffer_creation_context::context_draw, m_framebuffer_layout);
+	analyse_current_rsx_pipeline();
+
+	if (!framebuffer_status_valid || !init_draw_state())
+	{
+		execute_nop_draw();
+		rsx::thread::end();
+		return;
+	}
+
+	rsx::method_registers.current_draw_clause.begin();
+	u32 subdraw = 0u;
+	do
+	{
+		emit_geometry(subdraw++);
+	}
+	while (rsx::method_registers.current_draw_clause.next());
+
 	rsx::thread::end();
 }
+
+void NullGSRender::emit_geometry(u32 sub_index)
+{
+	auto& draw_clause = rsx::method_registers.current_draw_clause;
+
+	if (!sub_index)
+	{
+		analyse_inputs_interleaved(m_vertex_layout);
+		if (!m_vertex_layout.validate())
+		{
+			// Execute remainining pipeline barriers with NOP draw
+			do
+			{
+				draw_clause.execute_pipeline_dependencies();
+			}
+			while (draw_clause.next());
+
+			draw_clause.end();
+			return;
+		}
+	}
+	else
+	{
+		if (draw_clause.execute_pipeline_dependencies() & rsx::vertex_base_changed)
+		{
+			for (auto &info : m_vertex_layout.interleaved_blocks)
+			{
+				const auto vertex_base_offset = rsx::method_registers.vertex_data_base_offset();
+				info.real_offset_address = rsx::get_address(rsx::get_vertex_offset_from_base(vertex_base_offset, info.base_offset), info.memory_location);
+			}
+		}
+	}
+
+	// Collect the vertex ids of the draw, separate primitive runs are split by restart markers
+	u32 min_index = 0;
+	u32 max_index = 0;
+	bool index_rebase = false;
+	m_vertex_ids.clear();
+
+	const auto append_sequence = [&](u32 first, u32 count)
+	{
+		if (!m_vertex_ids.empty())
+		{
+			m_vertex_ids.push_back(restart_marker);
+		}
+
+		for (u32 i = 0; i < count; ++i)
+		{
+			m_vertex_ids.push_back(first + i);
+		}
+	};
+
+	switch (draw_clause.command)
+	{
+	case rsx::draw_command::array:
+	{
+		const u32 vertex_count = draw_clause.get_elements_count();
+		min_index = draw_clause.min_index();
+		max_index = min_index + vertex_count - 1;
+
+		if (draw_clause.is_single_draw())
+		{
+			append_sequence(0, vertex_count);
+		}
+		else
+		{
+			u32 first = 0;
+			for (const auto& range : draw_clause.get_subranges())
+			{
+				append_sequence(first, range.count);
+				first += range.count;
+			}
+		}
+		break;
+	}
+	case rsx::draw_command::indexed:
+	{
+		const auto command = std::get<rsx::draw_indexed_array_command>(get_draw_command(rsx::method_registers));
+		const rsx::index_array_type type = draw_clause.is_immediate_draw ? rsx::index_array_type::u32 : rsx::method_registers.index_type();
+		const u32 index_count = draw_clause.get_elements_count();
+		const bool restart_enabled = rsx::method_registers.restart_index_enabled();
+
+		m_index_data.resize(index_count);
+
+		// Primitives are assembled here, so the indices are only byteswapped
+		u32 written = 0;
+		std::tie(min_index, max_index, written) = write_index_array_data_to_buffer(
+			{ reinterpret_cast<std::byte*>(m_index_data.data()), index_count * get_index_type_size(type) },
+			command.raw_index_buffer, type, draw_clause.primitive, restart_enabled, rsx::method_registers.restart_index(),
+			[](auto) { return false; });
+
+		if (min_index >= max_index)
+		{
+			// Empty set, do not draw
+			return;
+		}
+
+		const auto get_index = [&](u32 i) -> u32
+		{
+			if (type == rsx::index_array_type::u32)
+			{
+				return m_index_data[i];
+			}
+
+			const u16 value = reinterpret_cast<const u16*>(m_index_data.data())[i];
+			return (restart_enabled && value == 0xffff) ? restart_marker : value;
+		};
+
+		u32 offset = 0;
+		const auto append_indices = [&](u32 count)
+		{
+			if (!m_vertex_ids.empty())
+			{
+				m_vertex_ids.push_back(restart_marker);
+			}
+
+			for (u32 i = 0; i < count && offset < index_count; ++i)
+			{
+				m_vertex_ids.push_back(get_index(offset++));
+			}
+		};
+
+		if (draw_clause.is_single_draw())
+		{
+			append_indices(index_count);
+		}
+		else
+		{
+			for (const auto& range : draw_clause.get_subranges())
+			{
+				append_indices(range.count);
+			}
+		}
+
+		index_rebase = true;
+		break;
+	}
+	case rsx::draw_command::inlined_array:
+	{
+		const auto stream_length = draw_clause.inline_vertex_array.size();
+		const u32 vertex_count = u32(stream_length * sizeof(u32)) / m_vertex_layout.interleaved_blocks[0].attribute_stride;
+
+		if (!vertex_count)
+		{
+			return;
+		}
+
+		append_sequence(0, vertex_count);
+		min_index = 0;
+		max_index = vertex_count - 1;
+		break;
+	}
+	default:
+		return;
+	}
+
+	const u32 vertex_count = (max_index - min_index) + 1;
+	u32 vertex_base = min_index;
+	u32 index_base = 0;
+
+	if (index_rebase)
+	{
+		vertex_base = rsx::get_index_from_base(vertex_base, rsx::method_registers.vertex_data_base_index());
+		index_base = min_index;
+	}
+
+	if (vertex_count > max_shaded_vertices)
+	{
+		rsx_log.warning("Null renderer: skipping draw referencing %u vertices", vertex_count);
+		return;
+	}
+
+	// Assemble the triangles first, their vertices are the only ones worth shading
+	m_triangle_indices.clear();
+
+	for (u32 begin = 0, end = 0; begin < m_vertex_ids.size(); begin = end + 1)
+	{
+		for (end = begin; end < m_vertex_ids.size() && m_vertex_ids[end] != restart_marker; ++end);
+
+		assemble_triangles(draw_clause.primitive, m_vertex_ids.data() + begin, end - begin, index_base, vertex_count, m_triangle_indices);
+	}
+
+	if (m_triangle_indices.empty())
+	{
+		return;
+	}
+
+	// Upload the vertex streams in the same layout as the hardware backends
+	const auto required = calculate_memory_requirements(m_vertex_layout, vertex_base, vertex_count);
+	m_persistent_data.resize(required.first);
+	m_volatile_data.resize(required.second);
+
+	write_vertex_data_to_memory(m_vertex_layout, vertex_base, vertex_count,
+		required.first ? m_persistent_data.data() : nullptr, required.second ? m_volatile_data.data() : nullptr);
+	g_fxo->get<rsx::dma_manager>()->sync();
+
+	std::array<s32, 32> layout_state{};
+	fill_vertex_layout_state(m_vertex_layout, vertex_base, vertex_count, layout_state.data());
+
+	const rsx::sw::vertex_program_env vertex_env =
+	{
+		reinterpret_cast<const u32*>(rsx::method_registers.transform_program.data()),
+		rsx::method_registers.transform_constants.data(),
+		rsx::method_registers.transform_program_start(),
+		rsx::method_registers.vertex_attrib_output_mask(),
+		rsx::method_registers.transform_branch_bits(),
+		rsx::method_registers.two_side_light_en()
+	};
+
+	const rsx::sw::vertex_fetch_env fetch_env =
+	{
+		layout_state.data(),
+		m_persistent_data.data(),
+		m_volatile_data.data(),
+		index_base,
+		index_rebase ? rsx::method_registers.vertex_data_base_index() : 0
+	};
+
+	m_shaded_vertices.resize(vertex_count);
+
+	m_rasterizer->parallel_for(vertex_count, 256, [&](u32 begin, u32 end)
+	{
+		for (u32 i = begin; i < end; ++i)
+		{
+			rsx::sw::run_vertex_program(vertex_env, fetch_env, i + index_base, m_shaded_vertices[i].outputs.data());
+		}
+	});
+
+	m_rasterizer->draw_triangles(m_draw_state, m_shaded_vertices.data(), m_triangle_indices.data(), ::size32(m_triangle_indices) / 3);
+}
+
+void NullGSRender::clear_surface(u32 arg)
+{
+	if (!m_rasterizer || skip_current_frame) return;
+
+	// If stencil write mask is disabled, remove clear_stencil bit
+	if (!rsx::method_registers.stencil_mask()) arg &= ~0x2u;
+
+	// Ignore invalid clear flags
+	if ((arg & 0xf3) == 0) return;
+
+	u8 ctx = rsx::framebuffer_creation_context::context_draw;
+	if (arg & 0xF0) ctx |= rsx::framebuffer_creation_context::context_clear_color;
+	if (arg & 0x3) ctx |= rsx::framebuffer_creation_context::context_clear_depth;
+
+	get_framebuffer_layout(static_cast<rsx::framebuffer_creation_context>(ctx), m_framebuffer_layout);
+
+	rsx::sw::clear_state state;
+
+	if (!framebuffer_status_valid || !init_render_target(state.target))
+	{
+		return;
+	}
+
+	const auto depth_format = m_framebuffer_layout.depth_format;
+
+	state.clear_color = (arg & 0xf0) != 0;
+	state.color_mask = { (arg & 0x10) != 0, (arg & 0x20) != 0, (arg & 0x40) != 0, (arg & 0x80) != 0 };
+	state.color =
+	{
+		rsx::method_registers.clear_color_r(),
+		rsx::method_registers.clear_color_g(),
+		rsx::method_registers.clear_color_b(),
+		rsx::method_registers.clear_color_a()
+	};
+
+	state.clear_depth = (arg & 0x1) != 0;
+	state.clear_stencil = (arg & 0x2) != 0 && is_depth_stencil_format(depth_format);
+	state.depth = rsx::method_registers.z_clear_value(is_depth_stencil_format(depth_format));
+	state.stencil = rsx::method_registers.stencil_clear_value();
+
+	m_rasterizer->clear(state);
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include "Emu/RSX/GSRender.h"
+#include "NullRasterizer.h"
 
 class NullGSRender : public GSRender
 {
@@ -8,5 +9,24 @@ public:
 	NullGSRender();
 
 private:
+	// Software rendering into guest memory, only active if enabled in the config
+	std::unique_ptr<rsx::sw::rasterizer> m_rasterizer;
+	rsx::sw::draw_state m_draw_state;
+
+	rsx::vertex_input_layout m_vertex_layout;
+	std::vector<u8> m_persistent_data;
+	std::vector<u8> m_volatile_data;
+	std::vector<u32> m_index_data;
+	std::vector<u32> m_vertex_ids;
+	std::vector<u32> m_triangle_indices;
+	std::vector<rsx::sw::raster_vertex> m_shaded_vertices;
+
+	bool init_render_target(rsx::sw::render_target& target);
+	bool init_draw_state();
+
+	void on_init_thread() override;
+	void on_exit() override;
 	void end() override;
+	void emit_geometry(u32 sub_index) override;
+	void clear_surface(u32 arg) override;
 };
@@ -0,0 +1,801 @@
+#include "stdafx.h"
+#include "NullRasterizer.h"
+
+#include "Utilities/Thread.h"
+#include "util/asm.hpp"
+
+#include <cmath>
+
+namespace rsx::sw
+{
+	// Screen tiles are shaded independently, large enough to amortize the binning cost
+	constexpr u32 tile_size = 64;
+
+	// Vertices closer to the eye than this are clipped away before the perspective divide
+	constexpr f32 near_w = 1e-5f;
+
+	struct raster_job
+	{
+		const std::function<void(u32, u32)>* func;
+		u32 count;
+		u32 chunk_size;
+		atomic_t<u32> next = 0;
+		atomic_t<u32> pending = 0;
+
+		void run()
+		{
+			while (true)
+			{
+				const u32 begin = next.fetch_add(chunk_size);
+
+				if (begin >= count)
+				{
+					return;
+				}
+
+				(*func)(begin, std::min(begin + chunk_size, count));
+
+				if (pending.sub_fetch(1) == 0)
+				{
+					pending.notify_all();
+				}
+			}
+		}
+	};
+
+	struct raster_worker
+	{
+		lf_queue<std::shared_ptr<raster_job>> m_work_queue;
+
+		void operator()()
+		{
+			while (thread_ctrl::state() != thread_state::aborting)
+			{
+				for (auto&& job : m_work_queue.pop_all())
+				{
+					job->run();
+				}
+
+				thread_ctrl::wait_on(m_work_queue, nullptr);
+			}
+		}
+	};
+
+	struct rasterizer::triangle_setup
+	{
+		std::array<f32, 3> x;
+		std::array<f32, 3> y;
+		std::array<f32, 3> z;
+		std::array<f32, 3> inv_w;
+
+		// Outputs 1 to 15 pre-divided by w for perspective correct interpolation
+		std::array<std::array<vec4, 15>, 3> varyings;
+
+		f32 inv_area;
+		std::array<bool, 3> top_left;
+		bool front_facing;
+
+		// Inclusive pixel bounds
+		s32 min_x;
+		s32 min_y;
+		s32 max_x;
+		s32 max_y;
+	};
+
+	namespace
+	{
+		// Shared by the depth and stencil tests, value is the incoming one and ref the one stored in the surface
+		bool test_compare(rsx::comparison_function func, u32 value, u32 ref)
+		{
+			switch (func)
+			{
+			case rsx::comparison_function::never: return false;
+			case rsx::comparison_function::less: return value < ref;
+			case rsx::comparison_function::equal: return value == ref;
+			case rsx::comparison_function::less_or_equal: return value <= ref;
+			case rsx::comparison_function::greater: return value > ref;
+			case rsx::comparison_function::not_equal: return value != ref;
+			case rsx::comparison_function::greater_or_equal: return value >= ref;
+			case rsx::comparison_function::always: return true;
+			}
+
+			return true;
+		}
+
+		u32 get_depth_max(rsx::surface_depth_format2 format)
+		{
+			return format == rsx::surface_depth_format2::z16_uint ? 0xffff : 0xffffff;
+		}
+
+		u32 read_depth(rsx::surface_depth_format2 format, const u8* ptr)
+		{
+			if (format == rsx::surface_depth_format2::z16_uint)
+			{
+				return *reinterpret_cast<const be_t<u16>*>(ptr);
+			}
+
+			return *reinterpret_cast<const be_t<u32>*>(ptr) >> 8;
+		}
+
+		void write_depth(rsx::surface_depth_format2 format, u8* ptr, u32 value)
+		{
+			if (format == rsx::surface_depth_format2::z16_uint)
+			{
+				*reinterpret_cast<be_t<u16>*>(ptr) = static_cast<u16>(value);
+				return;
+			}
+
+			// Stencil is preserved
+			auto& dst = *reinterpret_cast<be_t<u32>*>(ptr);
+			dst = (value << 8) | (dst & 0xff);
+		}
+
+		u8 apply_stencil_op(rsx::stencil_op op, u8 value, u8 ref)
+		{
+			switch (op)
+			{
+			case rsx::stencil_op::keep: return value;
+			case rsx::stencil_op::zero: return 0;
+			case rsx::stencil_op::replace: return ref;
+			case rsx::stencil_op::incr: return value == 0xff ? value : value + 1;
+			case rsx::stencil_op::decr: return value == 0 ? value : value - 1;
+			case rsx::stencil_op::invert: return ~value;
+			case rsx::stencil_op::incr_wrap: return value + 1;
+			case rsx::stencil_op::decr_wrap: return value - 1;
+			}
+
+			return value;
+		}
+
+		// Stencil is the low byte of a z24s8 word, depth is preserved
+		void write_stencil(u8* ptr, const stencil_face_state& face, rsx::stencil_op op)
+		{
+			auto& dst = *reinterpret_cast<be_t<u32>*>(ptr);
+			const u32 value = dst;
+			const u8 stencil = static_cast<u8>(value);
+			const u8 result = (stencil & ~face.write_mask) | (apply_stencil_op(op, stencil, face.ref) & face.write_mask);
+
+			if (result != stencil)
+			{
+				dst = (value & ~0xffu) | result;
+			}
+		}
+
+		u32 get_depth_bpp(rsx::surface_depth_format2 format)
+		{
+			return format == rsx::surface_depth_format2::z16_uint ? 2 : 4;
+		}
+
+		u32 to_unorm(f32 value, u32 max)
+		{
+			return static_cast<u32>(std::clamp(value, 0.f, 1.f) * max + 0.5f);
+		}
+
+		template <typename T>
+		void put_channel(T& dst, u32 value, u32 shift, u32 bits)
+		{
+			const T mask = static_cast<T>(((1u << bits) - 1) << shift);
+			dst = static_cast<T>((dst & ~mask) | ((value << shift) & mask));
+		}
+
+		// Encodes RGBA unorm channels (0..255) into the surface at ptr, respecting the write mask
+		void write_color_bytes(rsx::surface_color_format format, u8* ptr, const std::array<u32, 4>& rgba, const std::array<bool, 4>& mask)
+		{
+			switch (format)
+			{
+			case rsx::surface_color_format::a8r8g8b8:
+			case rsx::surface_color_format::x8r8g8b8_z8r8g8b8:
+			case rsx::surface_color_format::x8r8g8b8_o8r8g8b8:
+			case rsx::surface_color_format::a8b8g8r8:
+			case rsx::surface_color_format::x8b8g8r8_z8b8g8r8:
+			case rsx::surface_color_format::x8b8g8r8_o8b8g8r8:
+			{
+				const bool bgr = format == rsx::surface_color_format::a8r8g8b8 ||
+					format == rsx::surface_color_format::x8r8g8b8_z8r8g8b8 ||
+					format == rsx::surface_color_format::x8r8g8b8_o8r8g8b8;
+
+				const bool has_alpha = format == rsx::surface_color_format::a8r8g8b8 || format == rsx::surface_color_format::a8b8g8r8;
+				const bool one_fill = format == rsx::surface_color_format::x8r8g8b8_o8r8g8b8 || format == rsx::surface_color_format::x8b8g8r8_o8b8g8r8;
+
+				auto& dst = *reinterpret_cast<be_t<u32>*>(ptr);
+				u32 value = dst;
+
+				if (mask[0]) put_channel(value, rgba[0], bgr ? 16 : 0, 8);
+				if (mask[1]) put_channel(value, rgba[1], 8, 8);
+				if (mask[2]) put_channel(value, rgba[2], bgr ? 0 : 16, 8);
+
+				if (!has_alpha)
+				{
+					put_channel(value, one_fill ? 0xff : 0, 24, 8);
+				}
+				else if (mask[3])
+				{
+					put_channel(value, rgba[3], 24, 8);
+				}
+
+				dst = value;
+				break;
+			}
+			case rsx::surface_color_format::r5g6b5:
+			{
+				auto& dst = *reinterpret_cast<be_t<u16>*>(ptr);
+				u16 value = dst;
+
+				if (mask[0]) put_channel(value, rgba[0] >> 3, 11, 5);
+				if (mask[1]) put_channel(value, rgba[1] >> 2, 5, 6);
+				if (mask[2]) put_channel(value, rgba[2] >> 3, 0, 5);
+
+				dst = value;
+				break;
+			}
+			default:
+				break;
+			}
+		}
+
+		// Decodes the RGBA channels of the surface at ptr, formats without alpha read as opaque
+		vec4 read_color(rsx::surface_color_format format, const u8* ptr)
+		{
+			if (format == rsx::surface_color_format::r5g6b5)
+			{
+				const u16 value = *reinterpret_cast<const be_t<u16>*>(ptr);
+				return { (value >> 11) / 31.f, ((value >> 5) & 0x3f) / 63.f, (value & 0x1f) / 31.f, 1.f };
+			}
+
+			const u32 value = *reinterpret_cast<const be_t<u32>*>(ptr);
+			const bool bgr = format == rsx::surface_color_format::a8r8g8b8 ||
+				format == rsx::surface_color_format::x8r8g8b8_z8r8g8b8 ||
+				format == rsx::surface_color_format::x8r8g8b8_o8r8g8b8;
+			const bool has_alpha = format == rsx::surface_color_format::a8r8g8b8 || format == rsx::surface_color_format::a8b8g8r8;
+
+			return
+			{
+				((value >> (bgr ? 16 : 0)) & 0xff) / 255.f,
+				((value >> 8) & 0xff) / 255.f,
+				((value >> (bgr ? 0 : 16)) & 0xff) / 255.f,
+				has_alpha ? (value >> 24) / 255.f : 1.f
+			};
+		}
+
+		f32 get_blend_factor(rsx::blend_factor factor, const vec4& src, const vec4& dst, const vec4& constant, u32 c)
+		{
+			switch (factor)
+			{
+			case rsx::blend_factor::zero: return 0.f;
+			case rsx::blend_factor::one: return 1.f;
+			case rsx::blend_factor::src_color: return src[c];
+			case rsx::blend_factor::one_minus_src_color: return 1.f - src[c];
+			case rsx::blend_factor::dst_color: return dst[c];
+			case rsx::blend_factor::one_minus_dst_color: return 1.f - dst[c];
+			case rsx::blend_factor::src_alpha: return src[3];
+			case rsx::blend_factor::one_minus_src_alpha: return 1.f - src[3];
+			case rsx::blend_factor::dst_alpha: return dst[3];
+			case rsx::blend_factor::one_minus_dst_alpha: return 1.f - dst[3];
+			case rsx::blend_factor::src_alpha_saturate: return c == 3 ? 1.f : std::min(src[3], 1.f - dst[3]);
+			case rsx::blend_factor::constant_color: return constant[c];
+			case rsx::blend_factor::one_minus_constant_color: return 1.f - constant[c];
+			case rsx::blend_factor::constant_alpha: return constant[3];
+			case rsx::blend_factor::one_minus_constant_alpha: return 1.f - constant[3];
+			}
+
+			return 1.f;
+		}
+
+		// Signed equations are emulated with their unsigned counterparts, same as the hardware backends
+		f32 apply_blend_equation(rsx::blend_equation equation, f32 src, f32 dst, f32 sfactor, f32 dfactor)
+		{
+			switch (equation)
+			{
+			case rsx::blend_equation::min: return std::min(src, dst);
+			case rsx::blend_equation::max: return std::max(src, dst);
+			case rsx::blend_equation::substract: return src * sfactor - dst * dfactor;
+			case rsx::blend_equation::reverse_substract:
+			case rsx::blend_equation::reverse_substract_signed: return dst * dfactor - src * sfactor;
+			default: return src * sfactor + dst * dfactor;
+			}
+		}
+
+		// The incoming color is clamped first, all supported surfaces are unorm
+		vec4 blend(const draw_state& state, vec4 src, const vec4& dst)
+		{
+			vec4 result;
+
+			for (f32& value : src)
+			{
+				value = std::clamp(value, 0.f, 1.f);
+			}
+
+			for (u32 c = 0; c < 4; ++c)
+			{
+				const bool alpha = c == 3;
+				const f32 sfactor = get_blend_factor(alpha ? state.blend_sfactor_a : state.blend_sfactor_rgb, src, dst, state.blend_color, c);
+				const f32 dfactor = get_blend_factor(alpha ? state.blend_dfactor_a : state.blend_dfactor_rgb, src, dst, state.blend_color, c);
+				result[c] = apply_blend_equation(alpha ? state.blend_equation_a : state.blend_equation_rgb, src[c], dst[c], sfactor, dfactor);
+			}
+
+			return result;
+		}
+
+		u32 get_color_bpp(rsx::surface_color_format format)
+		{
+			return format == rsx::surface_color_format::r5g6b5 ? 2 : 4;
+		}
+
+		raster_vertex lerp_vertex(const raster_vertex& a, const raster_vertex& b, f32 t)
+		{
+			raster_vertex result;
+
+			for (u32 i = 0; i < 16; ++i)
+			{
+				for (u32 c = 0; c < 4; ++c)
+				{
+					result.outputs[i][c] = a.outputs[i][c] + (b.outputs[i][c] - a.outputs[i][c]) * t;
+				}
+			}
+
+			return result;
+		}
+	}
+
+	rasterizer::rasterizer(u32 thread_count)
+	{
+		if (thread_count > 1)
+		{
+			// The calling thread participates in every job
+			m_workers = std::make_unique<named_thread_group<raster_worker>>("RSX.SW", thread_count - 1);
+		}
+	}
+
+	rasterizer::~rasterizer()
+	{
+	}
+
+	void rasterizer::parallel_for(u32 count, u32 chunk_size, const std::function<void(u32, u32)>& func)
+	{
+		if (!count)
+		{
+			return;
+		}
+
+		const u32 chunks = utils::aligned_div(count, chunk_size);
+
+		if (!m_workers || chunks == 1)
+		{
+			func(0, count);
+			return;
+		}
+
+		auto job = std::make_shared<raster_job>();
+		job->func = &func;
+		job->count = count;
+		job->chunk_size = chunk_size;
+		job->pending = chunks;
+
+		for (raster_worker& worker : *m_workers)
+		{
+			worker.m_work_queue.push(job);
+		}
+
+		job->run();
+
+		// Workers may still hold the job, but they can no longer claim any chunk
+		while (const u32 pending = job->pending)
+		{
+			job->pending.wait(pending);
+		}
+	}
+
+	void rasterizer::setup_triangle(const draw_state& state, const raster_vertex* v0, const raster_vertex* v1, const raster_vertex* v2)
+	{
+		const render_target& target = state.target;
+		std::array<const raster_vertex*, 3> v = { v0, v1, v2 };
+
+		triangle_setup tri;
+
+		for (u32 i = 0; i < 3; ++i)
+		{
+			const vec4& pos = v[i]->outputs[0];
+			const f32 inv_w = 1.f / pos[3];
+
+			tri.x[i] = pos[0] * inv_w * state.viewport_scale[0] + state.viewport_offset[0];
+			tri.y[i] = pos[1] * inv_w * state.viewport_scale[1] + state.viewport_offset[1];
+			tri.z[i] = pos[2] * inv_w * state.viewport_scale[2] + state.viewport_offset[2];
+			tri.inv_w[i] = inv_w;
+
+			if (!std::isfinite(tri.x[i]) || !std::isfinite(tri.y[i]) || !std::isfinite(tri.z[i]))
+			{
+				return;
+			}
+		}
+
+		// Twice the signed area, with y pointing down in memory
+		f32 area = (tri.x[1] - tri.x[0]) * (tri.y[2] - tri.y[0]) - (tri.x[2] - tri.x[0]) * (tri.y[1] - tri.y[0]);
+
+		if (!(area != 0.f))
+		{
+			return;
+		}
+
+		tri.front_facing = state.front_ccw ? area < 0.f : area > 0.f;
+
+		if (state.cull_enabled)
+		{
+			if (state.cull_mode == rsx::cull_face::front_and_back ||
+				(state.cull_mode == rsx::cull_face::front && tri.front_facing) ||
+				(state.cull_mode == rsx::cull_face::back && !tri.front_facing))
+			{
+				return;
+			}
+		}
+
+		if (area < 0.f)
+		{
+			// Make the winding consistent so that covered pixels have non-negative edge functions
+			std::swap(v[1], v[2]);
+			std::swap(tri.x[1], tri.x[2]);
+			std::swap(tri.y[1], tri.y[2]);
+			std::swap(tri.z[1], tri.z[2]);
+			std::swap(tri.inv_w[1], tri.inv_w[2]);
+			area = -area;
+		}
+
+		tri.inv_area = 1.f / area;
+
+		const auto [min_x, max_x] = std::minmax({ tri.x[0], tri.x[1], tri.x[2] });
+		const auto [min_y, max_y] = std::minmax({ tri.y[0], tri.y[1], tri.y[2] });
+
+		// Pixels are sampled at their center
+		tri.min_x = std::max<s32>(target.x0, static_cast<s32>(std::ceil(std::max(min_x, -1.f) - 0.5f)));
+		tri.min_y = std::max<s32>(target.y0, static_cast<s32>(std::ceil(std::max(min_y, -1.f) - 0.5f)));
+		tri.max_x = std::min<s32>(target.x1 - 1, static_cast<s32>(std::floor(std::min(max_x, 65536.f) - 0.5f)));
+		tri.max_y = std::min<s32>(target.y1 - 1, static_cast<s32>(std::floor(std::min(max_y, 65536.f) - 0.5f)));
+
+		if (tri.min_x > tri.max_x || tri.min_y > tri.max_y)
+		{
+			return;
+		}
+
+		for (u32 edge = 0; edge < 3; ++edge)
+		{
+			// Edge opposite to vertex [edge]
+			const u32 a = (edge + 1) % 3;
+			const u32 b = (edge + 2) % 3;
+			const f32 dx = tri.x[b] - tri.x[a];
+			const f32 dy = tri.y[b] - tri.y[a];
+			tri.top_left[edge] = dy < 0.f || (dy == 0.f && dx > 0.f);
+		}
+
+		for (u32 i = 0; i < 3; ++i)
+		{
+			for (u32 reg = 0; reg < 15; ++reg)
+			{
+				for (u32 c = 0; c < 4; ++c)
+				{
+					tri.varyings[i][reg][c] = v[i]->outputs[reg + 1][c] * tri.inv_w[i];
+				}
+			}
+		}
+
+		const u32 index = ::size32(m_triangles);
+		m_triangles.push_back(tri);
+
+		for (u32 ty = tri.min_y / tile_size; ty <= tri.max_y / tile_size; ++ty)
+		{
+			for (u32 tx = tri.min_x / tile_size; tx <= tri.max_x / tile_size; ++tx)
+			{
+				auto& bin = m_bins[ty * m_tiles_x + tx];
+
+				if (bin.empty())
+				{
+					m_active_tiles.push_back(ty * m_tiles_x + tx);
+				}
+
+				bin.push_back(index);
+			}
+		}
+	}
+
+	void rasterizer::rasterize_tile(const draw_state& state, u32 tile)
+	{
+		const render_target& target = state.target;
+		const bool use_depth = target.zeta && state.depth_test;
+		const bool use_stencil = target.zeta && state.stencil_test && target.depth_format == rsx::surface_depth_format2::z24s8_uint;
+		const u32 depth_max = get_depth_max(target.depth_format);
+		const u32 depth_bpp = get_depth_bpp(target.depth_format);
+		const u32 color_bpp = get_color_bpp(target.color_format);
+
+		const s32 tile_x0 = (tile % m_tiles_x) * tile_size;
+		const s32 tile_y0 = (tile / m_tiles_x) * tile_size;
+		const s32 tile_x1 = tile_x0 + tile_size - 1;
+		const s32 tile_y1 = tile_y0 + tile_size - 1;
+
+		std::array<vec4, 16> in_regs{};
+		fragment_output output;
+
+		for (const u32 index : m_bins[tile])
+		{
+			const triangle_setup& tri = m_triangles[index];
+
+			const s32 x0 = std::max(tri.min_x, tile_x0);
+			const s32 x1 = std::min(tri.max_x, tile_x1);
+			const s32 y0 = std::max(tri.min_y, tile_y0);
+			const s32 y1 = std::min(tri.max_y, tile_y1);
+
+			for (s32 y = y0; y <= y1; ++y)
+			{
+				const f32 py = y + 0.5f;
+
+				for (s32 x = x0; x <= x1; ++x)
+				{
+					const f32 px = x + 0.5f;
+
+					std::array<f32, 3> bary;
+					bool inside = true;
+
+					for (u32 edge = 0; edge < 3; ++edge)
+					{
+						const u32 a = (edge + 1) % 3;
+						const u32 b = (edge + 2) % 3;
+						const f32 e = (tri.x[b] - tri.x[a]) * (py - tri.y[a]) - (tri.y[b] - tri.y[a]) * (px - tri.x[a]);
+
+						if (e < 0.f || (e == 0.f && !tri.top_left[edge]))
+						{
+							inside = false;
+							break;
+						}
+
+						bary[edge] = e * tri.inv_area;
+					}
+
+					if (!inside)
+					{
+						continue;
+					}
+
+					f32 z = bary[0] * tri.z[0] + bary[1] * tri.z[1] + bary[2] * tri.z[2];
+
+					if (state.depth_clip && !state.depth_clamp && (z < 0.f || z > 1.f))
+					{
+						continue;
+					}
+
+					z = std::clamp(z, 0.f, 1.f);
+
+					u8* zeta_ptr = (use_depth || use_stencil) ? target.zeta + y * target.zeta_pitch + x * depth_bpp : nullptr;
+					u32 depth_value = to_unorm(z, depth_max);
+
+					if (use_depth && !use_stencil && !(state.fragment_env.shader_control & CELL_GCM_SHADER_CONTROL_DEPTH_EXPORT))
+					{
+						// Early test, the fragment program can not change the result and no stencil update depends on it
+						if (!test_compare(state.depth_func, depth_value, read_depth(target.depth_format, zeta_ptr)))
+						{
+							continue;
+						}
+					}
+
+					const f32 inv_w = bary[0] * tri.inv_w[0] + bary[1] * tri.inv_w[1] + bary[2] * tri.inv_w[2];
+					const f32 w = 1.f / inv_w;
+
+					for (u32 reg = 0; reg < 15; ++reg)
+					{
+						for (u32 c = 0; c < 4; ++c)
+						{
+							in_regs[reg + 1][c] = (bary[0] * tri.varyings[0][reg][c] + bary[1] * tri.varyings[1][reg][c] + bary[2] * tri.varyings[2][reg][c]) * w;
+						}
+					}
+
+					const fragment_input input = { { px, py, z, inv_w }, in_regs.data(), tri.front_facing };
+
+					if (!run_fragment_program(state.fragment_env, input, output))
+					{
+						continue;
+					}
+
+					const stencil_face_state& face = state.stencil[tri.front_facing ? 0 : 1];
+
+					if (use_stencil)
+					{
+						const u8 stencil = static_cast<u8>(*reinterpret_cast<const be_t<u32>*>(zeta_ptr));
+
+						if (!test_compare(face.func, face.ref & face.func_mask, stencil & face.func_mask))
+						{
+							write_stencil(zeta_ptr, face, face.op_fail);
+							continue;
+						}
+					}
+
+					if (use_depth)
+					{
+						if (output.depth_export)
+						{
+							depth_value = to_unorm(output.depth, depth_max);
+						}
+
+						if ((output.depth_export || use_stencil) && !test_compare(state.depth_func, depth_value, read_depth(target.depth_format, zeta_ptr)))
+						{
+							if (use_stencil)
+							{
+								write_stencil(zeta_ptr, face, face.op_zfail);
+							}
+
+							continue;
+						}
+
+						if (state.depth_write)
+						{
+							write_depth(target.depth_format, zeta_ptr, depth_value);
+						}
+					}
+
+					if (use_stencil)
+					{
+						write_stencil(zeta_ptr, face, face.op_zpass);
+					}
+
+					for (u32 rt = 0; rt < 4; ++rt)
+					{
+						if (!target.color[rt])
+						{
+							continue;
+						}
+
+						u8* color_ptr = target.color[rt] + y * target.color_pitch[rt] + x * color_bpp;
+						vec4 color = output.color[rt];
+
+						if (state.blend_enabled[rt])
+						{
+							color = blend(state, color, read_color(target.color_format, color_ptr));
+						}
+
+						const std::array<u32, 4> rgba = { to_unorm(color[0], 255), to_unorm(color[1], 255), to_unorm(color[2], 255), to_unorm(color[3], 255) };
+						write_color_bytes(target.color_format, color_ptr, rgba, state.color_mask[rt]);
+					}
+				}
+			}
+		}
+	}
+
+	void rasterizer::draw_triangles(const draw_state& state, const raster_vertex* vertices, const u32* indices, u32 triangle_count)
+	{
+		const render_target& target = state.target;
+
+		if (!triangle_count || target.x0 >= target.x1 || target.y0 >= target.y1)
+		{
+			return;
+		}
+
+		m_tiles_x = utils::aligned_div<u32>(target.width, tile_size);
+		const u32 tile_count = m_tiles_x * utils::aligned_div<u32>(target.height, tile_size);
+
+		if (m_bins.size() < tile_count)
+		{
+			m_bins.resize(tile_count);
+		}
+
+		m_triangles.clear();
+		m_active_tiles.clear();
+
+		for (u32 i = 0; i < triangle_count; ++i)
+		{
+			const raster_vertex* v[3] = { &vertices[indices[i * 3]], &vertices[indices[i * 3 + 1]], &vertices[indices[i * 3 + 2]] };
+
+			u32 behind = 0;
+
+			for (u32 n = 0; n < 3; ++n)
+			{
+				if (!(v[n]->outputs[0][3] > near_w)) behind |= (1u << n);
+			}
+
+			if (!behind)
+			{
+				setup_triangle(state, v[0], v[1], v[2]);
+				continue;
+			}
+
+			if (behind == 7)
+			{
+				continue;
+			}
+
+			// Clip against the w = near_w plane, producing up to two triangles
+			raster_vertex clipped[4];
+			u32 clipped_count = 0;
+
+			for (u32 n = 0; n < 3; ++n)
+			{
+				const raster_vertex& cur = *v[n];
+				const raster_vertex& next = *v[(n + 1) % 3];
+				const f32 cur_w = cur.outputs[0][3];
+				const f32 next_w = next.outputs[0][3];
+
+				if (!(behind & (1u << n)))
+				{
+					clipped[clipped_count++] = cur;
+				}
+
+				if (((behind >> n) ^ (behind >> ((n + 1) % 3))) & 1)
+				{
+					clipped[clipped_count++] = lerp_vertex(cur, next, (near_w - cur_w) / (next_w - cur_w));
+				}
+			}
+
+			for (u32 n = 2; n < clipped_count; ++n)
+			{
+				setup_triangle(state, &clipped[0], &clipped[n - 1], &clipped[n]);
+			}
+		}
+
+		parallel_for(::size32(m_active_tiles), 1, [&](u32 begin, u32 end)
+		{
+			for (u32 i = begin; i < end; ++i)
+			{
+				rasterize_tile(state, m_active_tiles[i]);
+			}
+		});
+
+		for (const u32 tile : m_active_tiles)
+		{
+			m_bins[tile].clear();
+		}
+	}
+
+	void rasterizer::clear(const clear_state& state)
+	{
+		const render_target& target = state.target;
+
+		if (target.x0 >= target.x1 || target.y0 >= target.y1)
+		{
+			return;
+		}
+
+		const u32 depth_bpp = get_depth_bpp(target.depth_format);
+		const u32 color_bpp = get_color_bpp(target.color_format);
+		const std::array<u32, 4> rgba = { state.color[0], state.color[1], state.color[2], state.color[3] };
+		const bool depth_stencil = target.depth_format == rsx::surface_depth_format2::z24s8_uint;
+
+		parallel_for(target.y1 - target.y0, 16, [&](u32 begin, u32 end)
+		{
+			for (u32 y = target.y0 + begin; y < target.y0 + end; ++y)
+			{
+				for (u32 x = target.x0; x < target.x1; ++x)
+				{
+					if (state.clear_color)
+					{
+						for (u32 rt = 0; rt < 4; ++rt)
+						{
+							if (target.color[rt])
+							{
+								write_color_bytes(target.color_format, target.color[rt] + y * target.color_pitch[rt] + x * color_bpp, rgba, state.color_mask);
+							}
+						}
+					}
+
+					if (!target.zeta)
+					{
+						continue;
+					}
+
+					u8* depth_ptr = target.zeta + y * target.zeta_pitch + x * depth_bpp;
+
+					if (!depth_stencil)
+					{
+						if (state.clear_depth)
+						{
+							*reinterpret_cast<be_t<u16>*>(depth_ptr) = static_cast<u16>(state.depth);
+						}
+
+						continue;
+					}
+
+					auto& dst = *reinterpret_cast<be_t<u32>*>(depth_ptr);
+					u32 value = dst;
+
+					if (state.clear_depth) value = (state.depth << 8) | (value & 0xff);
+					if (state.clear_stencil) value = (value & ~0xffu) | state.stencil;
+
+					dst = value;
+				}
+			}
+		});
+	}
+}
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "NullShaderInterpreter.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+template <class Context>
+class named_thread_group;
+
+namespace rsx::sw
+{
+	struct raster_worker;
+
+	// Guest surfaces bound for the draw, all pointers are host mappings of guest memory
+	struct render_target
+	{
+		std::array<u8*, 4> color = {};      // Indexed by fragment program output
+		std::array<u32, 4> color_pitch = {};
+		rsx::surface_color_format color_format = rsx::surface_color_format::a8r8g8b8;
+
+		u8* zeta = nullptr;
+		u32 zeta_pitch = 0;
+		rsx::surface_depth_format2 depth_format = rsx::surface_depth_format2::z24s8_uint;
+
+		u16 width = 0;
+		u16 height = 0;
+
+		// Scissor rectangle, end exclusive
+		u16 x0 = 0;
+		u16 y0 = 0;
+		u16 x1 = 0;
+		u16 y1 = 0;
+	};
+
+	struct stencil_face_state
+	{
+		rsx::comparison_function func = rsx::comparison_function::always;
+		u8 ref = 0;
+		u8 func_mask = 0xff;
+		u8 write_mask = 0xff;
+		rsx::stencil_op op_fail = rsx::stencil_op::keep;
+		rsx::stencil_op op_zfail = rsx::stencil_op::keep;
+		rsx::stencil_op op_zpass = rsx::stencil_op::keep;
+	};
+
+	struct draw_state
+	{
+		render_target target;
+		fragment_program_env fragment_env;
+
+		bool depth_test = false;
+		bool depth_write = false;
+		rsx::comparison_function depth_func = rsx::comparison_function::always;
+
+		// Only effective with a z24s8 surface; index 0 applies to front faces, index 1 to back faces
+		bool stencil_test = false;
+		std::array<stencil_face_state, 2> stencil = {};
+
+		// RGBA write masks per fragment program output
+		std::array<std::array<bool, 4>, 4> color_mask = {};
+
+		// Blending per fragment program output, the factors and equations are shared
+		std::array<bool, 4> blend_enabled = {};
+		rsx::blend_factor blend_sfactor_rgb = rsx::blend_factor::one;
+		rsx::blend_factor blend_sfactor_a = rsx::blend_factor::one;
+		rsx::blend_factor blend_dfactor_rgb = rsx::blend_factor::zero;
+		rsx::blend_factor blend_dfactor_a = rsx::blend_factor::zero;
+		rsx::blend_equation blend_equation_rgb = rsx::blend_equation::add;
+		rsx::blend_equation blend_equation_a = rsx::blend_equation::add;
+		vec4 blend_color = {};
+
+		bool cull_enabled = false;
+		rsx::cull_face cull_mode = rsx::cull_face::back;
+		bool front_ccw = true;
+
+		std::array<f32, 3> viewport_scale = {};
+		std::array<f32, 3> viewport_offset = {};
+		bool depth_clamp = false;
+		bool depth_clip = true;
+	};
+
+	// Shaded vertex, outputs[0] is the clip space position
+	struct raster_vertex
+	{
+		std::array<vec4, 16> outputs;
+	};
+
+	struct clear_state
+	{
+		render_target target;
+		bool clear_color = false;
+		std::array<bool, 4> color_mask = {}; // RGBA
+		std::array<u8, 4> color = {};        // RGBA
+		bool clear_depth = false;
+		bool clear_stencil = false;
+		u32 depth = 0;
+		u8 stencil = 0;
+	};
+
+	/**
+	 * Tile based triangle rasterizer writing straight into guest memory.
+	 * Triangles are binned into screen tiles which are shaded in parallel; the submission order is preserved inside each tile.
+	 */
+	class rasterizer
+	{
+	public:
+		rasterizer(u32 thread_count);
+		~rasterizer();
+
+		// Runs func(begin, end) over [0, count) in chunks on the worker threads and the calling thread
+		void parallel_for(u32 count, u32 chunk_size, const std::function<void(u32, u32)>& func);
+
+		// Draws a triangle list; indices reference the vertices array, three per triangle
+		void draw_triangles(const draw_state& state, const raster_vertex* vertices, const u32* indices, u32 triangle_count);
+
+		void clear(const clear_state& state);
+
+	private:
+		struct triangle_setup;
+
+		void setup_triangle(const draw_state& state, const raster_vertex* v0, const raster_vertex* v1, const raster_vertex* v2);
+		void rasterize_tile(const draw_state& state, u32 tile);
+
+		std::unique_ptr<named_thread_group<raster_worker>> m_workers;
+
+		std::vector<triangle_setup> m_triangles;
+		std::vector<std::vector<u32>> m_bins;
+		std::vector<u32> m_active_tiles;
+		u32 m_tiles_x = 0;
+	};
+}
@@ -0,0 +1,1515 @@
+#include "stdafx.h"
+#include "NullShaderInterpreter.h"
+
+#include "Emu/RSX/RSXVertexProgram.h"
+#include "Emu/RSX/RSXFragmentProgram.h"
+#include "Emu/RSX/rsx_utils.h"
+
+#include <cmath>
+
+// CPU port of Common/Interpreter/VertexInterpreter.glsl and FragmentInterpreter.glsl.
+// Behaviour is kept identical to the GLSL versions unless noted otherwise, so that both can be compared.
+
+namespace rsx::sw
+{
+	namespace
+	{
+		enum : u32
+		{
+			EXEC_LT = 1,
+			EXEC_EQ = 2,
+			EXEC_GT = 4,
+		};
+
+		// Upper bound of executed instructions, guards against runaway loops in broken programs
+		constexpr u32 max_instructions_executed = 0x10000;
+
+		constexpr u32 get_bits(u32 word, u32 offset, u32 count)
+		{
+			return (word >> offset) & ((1u << count) - 1);
+		}
+
+		constexpr bool test_bit(u32 word, u32 bit)
+		{
+			return ((word >> bit) & 1) != 0;
+		}
+
+		// Masked register move, bit n of mask selects component n
+		inline void reg_mov(vec4& dst, const vec4& src, u32 mask)
+		{
+			for (u32 i = 0; i < 4; ++i)
+			{
+				if (mask & (1u << i)) dst[i] = src[i];
+			}
+		}
+
+		inline vec4 splat(f32 value)
+		{
+			return { value, value, value, value };
+		}
+
+		inline vec4 clamp01(const vec4& v)
+		{
+			return { std::clamp(v[0], 0.f, 1.f), std::clamp(v[1], 0.f, 1.f), std::clamp(v[2], 0.f, 1.f), std::clamp(v[3], 0.f, 1.f) };
+		}
+
+		template <typename F>
+		inline vec4 map(const vec4& a, F&& func)
+		{
+			return { func(a[0]), func(a[1]), func(a[2]), func(a[3]) };
+		}
+
+		template <typename F>
+		inline vec4 map(const vec4& a, const vec4& b, F&& func)
+		{
+			return { func(a[0], b[0]), func(a[1], b[1]), func(a[2], b[2]), func(a[3], b[3]) };
+		}
+
+		inline f32 dot(const vec4& a, const vec4& b, u32 count)
+		{
+			f32 result = 0.f;
+			for (u32 i = 0; i < count; ++i)
+			{
+				result += a[i] * b[i];
+			}
+			return result;
+		}
+
+		inline vec4 distance_vector(const vec4& a, const vec4& b)
+		{
+			// Old-school distance vector
+			return { 1.f, a[1] * b[1], a[2], b[3] };
+		}
+
+		// Returns the mask of components passing the condition
+		u32 test_cond(const vec4& cond, u32 mode)
+		{
+			u32 result = 0;
+
+			for (u32 i = 0; i < 4; ++i)
+			{
+				bool pass;
+				switch (mode)
+				{
+				case EXEC_GT | EXEC_EQ | EXEC_LT: pass = true; break;
+				case EXEC_GT | EXEC_EQ: pass = cond[i] >= 0.f; break;
+				case EXEC_LT | EXEC_EQ: pass = cond[i] <= 0.f; break;
+				case EXEC_LT | EXEC_GT: pass = cond[i] != 0.f; break;
+				case EXEC_GT: pass = cond[i] > 0.f; break;
+				case EXEC_LT: pass = cond[i] < 0.f; break;
+				case EXEC_EQ: pass = cond[i] == 0.f; break;
+				default: pass = false; break;
+				}
+
+				result |= pass ? (1u << i) : 0u;
+			}
+
+			return result;
+		}
+
+		f32 half_to_float(u16 value)
+		{
+			const u32 sign = (value & 0x8000u) << 16;
+			const u32 exponent = (value >> 10) & 0x1f;
+			u32 mantissa = value & 0x3ff;
+
+			if (exponent == 0x1f)
+			{
+				// Inf/NaN
+				return std::bit_cast<f32>(sign | 0x7f800000u | (mantissa << 13));
+			}
+
+			if (exponent == 0)
+			{
+				if (!mantissa)
+				{
+					return std::bit_cast<f32>(sign);
+				}
+
+				// Denormal, renormalize
+				u32 e = 113;
+				while (!(mantissa & 0x400))
+				{
+					mantissa <<= 1;
+					e--;
+				}
+
+				return std::bit_cast<f32>(sign | (e << 23) | ((mantissa & 0x3ff) << 13));
+			}
+
+			return std::bit_cast<f32>(sign | ((exponent + 112) << 23) | (mantissa << 13));
+		}
+
+		u16 float_to_half(f32 value)
+		{
+			const u32 bits = std::bit_cast<u32>(value);
+			const u16 sign = static_cast<u16>((bits >> 16) & 0x8000);
+			const u32 abs_bits = bits & 0x7fffffff;
+
+			if (abs_bits >= 0x7f800000)
+			{
+				// Inf/NaN
+				return sign | 0x7c00 | ((abs_bits > 0x7f800000) ? 0x200 : 0);
+			}
+
+			if (abs_bits >= 0x477ff000)
+			{
+				// Overflow after rounding
+				return sign | 0x7c00;
+			}
+
+			if (abs_bits < 0x38800000)
+			{
+				// Denormal or zero, round to nearest even
+				const u32 shift = 126 - (abs_bits >> 23);
+				if (shift > 24)
+				{
+					return sign;
+				}
+
+				const u32 mantissa = (abs_bits & 0x7fffff) | 0x800000;
+				const u32 rounded = (mantissa + (1u << (shift - 1)) - 1 + ((mantissa >> shift) & 1)) >> shift;
+				return sign | static_cast<u16>(rounded);
+			}
+
+			const u32 rounded = abs_bits + 0xfff + ((abs_bits >> 13) & 1) - (112u << 23);
+			return sign | static_cast<u16>(rounded >> 13);
+		}
+
+		// Sign extension of raw 16-bit values
+		inline f32 sext16(u32 bits)
+		{
+			return (bits < 0x8000) ? static_cast<f32>(bits) : static_cast<f32>(static_cast<s32>(bits) - 65536);
+		}
+
+		vec4 fetch_attribute(const vertex_fetch_env& fetch, u32 location, u32 vertex_id)
+		{
+			// Each descriptor is 64 bits wide, see fill_vertex_layout_state
+			const u32 attrib0 = static_cast<u32>(fetch.layout[location * 2 + 0]);
+			const u32 attrib1 = static_cast<u32>(fetch.layout[location * 2 + 1]);
+
+			const u32 stride = get_bits(attrib0, 0, 8);
+			const u32 frequency = get_bits(attrib0, 8, 16);
+			const u32 type = get_bits(attrib0, 24, 3);
+			const u32 attribute_size = get_bits(attrib0, 27, 3);
+			const u32 starting_offset = get_bits(attrib1, 0, 29);
+			const bool swap_bytes = test_bit(attrib1, 29);
+			const bool is_volatile = test_bit(attrib1, 30);
+			const bool modulo = test_bit(attrib1, 31);
+
+			if (type > 6)
+			{
+				return { 0.f, 0.f, 0.f, 1.f };
+			}
+
+			s32 index = static_cast<s32>(vertex_id - fetch.vertex_index_base);
+			if (frequency == 0)
+			{
+				index = 0;
+			}
+			else if (modulo)
+			{
+				// If a vertex modifier is active, vertex_base must be 0 and is ignored
+				index = static_cast<s32>((vertex_id + fetch.vertex_index_offset) % frequency);
+			}
+			else
+			{
+				index /= static_cast<s32>(frequency);
+			}
+
+			constexpr u32 elem_size_table[] = { 2, 4, 2, 1, 2, 4, 1 };
+			constexpr f32 scaling_table[] = { 32768.f, 1.f, 1.f, 255.f, 1.f, 32767.f, 1.f };
+			const u32 elem_size = elem_size_table[type];
+			const f32 scale = scaling_table[type];
+
+			const u8* src = (is_volatile ? fetch.volatile_data : fetch.persistent_data);
+			u32 result[4] = {};
+
+			if (src)
+			{
+				src += static_cast<s64>(index) * stride + starting_offset;
+
+				for (u32 n = 0; n < attribute_size && n < 4; ++n, src += elem_size)
+				{
+					switch (elem_size)
+					{
+					case 1:
+						result[n] = src[0];
+						break;
+					case 2:
+						result[n] = swap_bytes ? ((src[0] << 8) | src[1]) : (src[0] | (src[1] << 8));
+						break;
+					default:
+						result[n] = swap_bytes ?
+							((src[0] << 24) | (src[1] << 16) | (src[2] << 8) | src[3]) :
+							(src[0] | (src[1] << 8) | (src[2] << 16) | (src[3] << 24));
+						break;
+					}
+				}
+			}
+
+			vec4 ret;
+
+			switch (type)
+			{
+			case 0: // SNORM16
+			case 4: // SINT16
+				ret = { sext16(result[0]), sext16(result[1]), sext16(result[2]), sext16(result[3]) };
+				break;
+			case 1: // FLOAT32
+				ret = { std::bit_cast<f32>(result[0]), std::bit_cast<f32>(result[1]), std::bit_cast<f32>(result[2]), std::bit_cast<f32>(result[3]) };
+				break;
+			case 2: // FLOAT16
+				ret = { half_to_float(static_cast<u16>(result[0])), half_to_float(static_cast<u16>(result[1])),
+					half_to_float(static_cast<u16>(result[2])), half_to_float(static_cast<u16>(result[3])) };
+				break;
+			case 3: // UNORM8
+			case 6: // UINT8
+				if (swap_bytes)
+				{
+					ret = { static_cast<f32>(result[3]), static_cast<f32>(result[2]), static_cast<f32>(result[1]), static_cast<f32>(result[0]) };
+				}
+				else
+				{
+					ret = { static_cast<f32>(result[0]), static_cast<f32>(result[1]), static_cast<f32>(result[2]), static_cast<f32>(result[3]) };
+				}
+				break;
+			default: // COMP32
+				ret =
+				{
+					sext16(get_bits(result[0], 0, 11) << 5),
+					sext16(get_bits(result[0], 11, 11) << 5),
+					sext16(get_bits(result[0], 22, 10) << 6),
+					scale
+				};
+				break;
+			}
+
+			if (attribute_size < 4)
+			{
+				ret[3] = scale;
+			}
+
+			return map(ret, [scale](f32 v) { return v / scale; });
+		}
+
+		class vertex_interpreter
+		{
+			const vertex_program_env& m_env;
+			const vertex_fetch_env& m_fetch;
+			const u32 m_vertex_id;
+			vec4* m_dest;
+
+			vec4 m_temp[32]{};
+			s32 m_a[2][4]{};
+			vec4 m_cc[2]{};
+			vec4 m_inputs[16]{};
+			u32 m_inputs_loaded = 0;
+
+			u32 m_instr[4]{};
+
+			// Unpacked fields of the current instruction
+			u32 m_addr_swz = 0;
+			u32 m_swizzle[4]{};
+			u32 m_cond = 0;
+			bool m_cond_test_enable = false;
+			u32 m_dst_tmp = 0;
+			u32 m_addr_reg_sel_1 = 0;
+			u32 m_cond_reg_sel_1 = 0;
+			bool m_saturate = false;
+			bool m_vec_result = false;
+			u32 m_input_src = 0;
+			u32 m_const_src = 0;
+			bool m_end = false;
+			bool m_index_const = false;
+			u32 m_dst = 0;
+			u32 m_sca_dst_tmp = 0;
+			u32 m_vec_mask = 0;
+			u32 m_sca_mask = 0;
+
+		public:
+			vertex_interpreter(const vertex_program_env& env, const vertex_fetch_env& fetch, u32 vertex_id, vec4* dest)
+				: m_env(env), m_fetch(fetch), m_vertex_id(vertex_id), m_dest(dest)
+			{}
+
+			void decode(const u32* instr)
+			{
+				std::memcpy(m_instr, instr, sizeof(m_instr));
+
+				const u32 d0 = m_instr[0], d1 = m_instr[1], d3 = m_instr[3];
+
+				m_addr_swz = get_bits(d0, 0, 2);
+				m_swizzle[3] = get_bits(d0, 2, 2);
+				m_swizzle[2] = get_bits(d0, 4, 2);
+				m_swizzle[1] = get_bits(d0, 6, 2);
+				m_swizzle[0] = get_bits(d0, 8, 2);
+				m_cond = get_bits(d0, 10, 3);
+				m_cond_test_enable = test_bit(d0, 13);
+				m_dst_tmp = get_bits(d0, 15, 6);
+				m_addr_reg_sel_1 = get_bits(d0, 24, 1);
+				m_cond_reg_sel_1 = get_bits(d0, 25, 1);
+				m_saturate = test_bit(d0, 26);
+				m_vec_result = test_bit(d0, 30);
+
+				m_input_src = get_bits(d1, 8, 4);
+				m_const_src = get_bits(d1, 12, 10);
+
+				m_end = test_bit(d3, 0);
+				m_index_const = test_bit(d3, 1);
+				m_dst = get_bits(d3, 2, 5);
+				m_sca_dst_tmp = get_bits(d3, 7, 6);
+				m_vec_mask = (test_bit(d3, 16) ? 1 : 0) | (test_bit(d3, 15) ? 2 : 0) | (test_bit(d3, 14) ? 4 : 0) | (test_bit(d3, 13) ? 8 : 0);
+				m_sca_mask = (test_bit(d3, 20) ? 1 : 0) | (test_bit(d3, 19) ? 2 : 0) | (test_bit(d3, 18) ? 4 : 0) | (test_bit(d3, 17) ? 8 : 0);
+			}
+
+			vec4 get_cond() const
+			{
+				const vec4& cc = m_cc[m_cond_reg_sel_1];
+				return { cc[m_swizzle[0]], cc[m_swizzle[1]], cc[m_swizzle[2]], cc[m_swizzle[3]] };
+			}
+
+			bool dynamic_branch() const
+			{
+				if (m_cond == (EXEC_LT | EXEC_GT | EXEC_EQ)) return true;
+				if (m_cond == 0) return false;
+
+				return test_cond(get_cond(), m_cond) != 0;
+			}
+
+			bool static_branch() const
+			{
+				const u32 mask = 1u << get_bits(m_instr[3], 23, 5);
+				const bool cond = test_bit(m_instr[3], 28);
+				const bool actual = (m_env.branch_bits & mask) != 0;
+
+				return cond == actual;
+			}
+
+			u32 branch_addr() const
+			{
+				return (get_bits(m_instr[2], 0, 6) << 3) + get_bits(m_instr[3], 29, 3);
+			}
+
+			const vec4& read_location(u32 location)
+			{
+				if (!(m_inputs_loaded & (1u << location)))
+				{
+					m_inputs[location] = fetch_attribute(m_fetch, location, m_vertex_id);
+					m_inputs_loaded |= (1u << location);
+				}
+
+				return m_inputs[location];
+			}
+
+			vec4 read_src(u32 index)
+			{
+				u32 src = 0;
+				bool do_abs = false;
+
+				switch (index)
+				{
+				case 0:
+					src = (get_bits(m_instr[1], 0, 8) << 9) | get_bits(m_instr[2], 23, 9);
+					do_abs = test_bit(m_instr[0], 21);
+					break;
+				case 1:
+					src = get_bits(m_instr[2], 6, 17);
+					do_abs = test_bit(m_instr[0], 22);
+					break;
+				default:
+					src = (get_bits(m_instr[2], 0, 6) << 11) | get_bits(m_instr[3], 21, 11);
+					do_abs = test_bit(m_instr[0], 23);
+					break;
+				}
+
+				vec4 value{};
+
+				switch (get_bits(src, 0, 2))
+				{
+				case 1: // Temp
+					value = m_temp[get_bits(src, 2, 6) & 31];
+					break;
+				case 2: // Input
+					value = read_location(m_input_src);
+					break;
+				case 3: // Constant
+				{
+					u32 address = m_const_src;
+					if (m_index_const)
+					{
+						address += m_a[m_addr_reg_sel_1][m_addr_swz];
+					}
+
+					if (address < 468)
+					{
+						const u32* c = m_env.constants[address];
+						value = { std::bit_cast<f32>(c[0]), std::bit_cast<f32>(c[1]), std::bit_cast<f32>(c[2]), std::bit_cast<f32>(c[3]) };
+					}
+					break;
+				}
+				default:
+					break;
+				}
+
+				if (get_bits(src, 8, 8) != 0x1B)
+				{
+					value = { value[get_bits(src, 14, 2)], value[get_bits(src, 12, 2)], value[get_bits(src, 10, 2)], value[get_bits(src, 8, 2)] };
+				}
+
+				if (do_abs)
+				{
+					value = map(value, [](f32 v) { return std::fabs(v); });
+				}
+
+				if (test_bit(src, 16))
+				{
+					value = map(value, [](f32 v) { return -v; });
+				}
+
+				return value;
+			}
+
+			void write_sca(f32 value)
+			{
+				if (m_saturate)
+				{
+					value = std::clamp(value, 0.f, 1.f);
+				}
+
+				if (m_sca_dst_tmp == 0x3f)
+				{
+					if (!m_vec_result)
+					{
+						if (m_dst < 16) reg_mov(m_dest[m_dst], splat(value), m_sca_mask);
+					}
+					else
+					{
+						reg_mov(m_cc[m_cond_reg_sel_1], splat(value), m_sca_mask);
+					}
+				}
+				else
+				{
+					reg_mov(m_temp[m_sca_dst_tmp & 31], splat(value), m_sca_mask);
+				}
+			}
+
+			void write_vec(vec4 value)
+			{
+				if (m_saturate)
+				{
+					value = clamp01(value);
+				}
+
+				u32 write_mask = m_vec_mask;
+				if (m_cond_test_enable)
+				{
+					write_mask &= test_cond(get_cond(), m_cond);
+				}
+
+				if (m_dst_tmp == 0x3f && !m_vec_result)
+				{
+					reg_mov(m_cc[m_cond_reg_sel_1], value, write_mask);
+				}
+				else
+				{
+					if (m_vec_result && m_dst < 16)
+					{
+						reg_mov(m_dest[m_dst], value, write_mask);
+					}
+
+					if (m_dst_tmp != 0x3f)
+					{
+						reg_mov(m_temp[m_dst_tmp & 31], value, write_mask);
+					}
+				}
+			}
+
+			void write_output(u32 oid, u32 mask_bit)
+			{
+				if (!(m_env.output_mask & (1u << mask_bit)))
+				{
+					m_dest[oid] = { 0.f, 0.f, 0.f, 1.f };
+				}
+			}
+
+			void run()
+			{
+				for (u32 i = 0; i < 16; ++i)
+				{
+					m_dest[i] = { 0.f, 0.f, 0.f, 1.f };
+				}
+
+				u32 callstack[8];
+				u32 stack_ptr = 0;
+				u32 current_instruction = m_env.entry;
+
+				for (u32 executed = 0; !m_end && current_instruction < 512 && executed < max_instructions_executed; ++executed)
+				{
+					decode(m_env.ucode + current_instruction * 4);
+					current_instruction++;
+
+					u32 vec_opcode = get_bits(m_instr[1], 22, 5);
+					u32 sca_opcode = get_bits(m_instr[1], 27, 5);
+
+					if (m_cond_test_enable && m_cond == 0)
+					{
+						vec_opcode = RSX_VEC_OPCODE_NOP;
+						sca_opcode = RSX_SCA_OPCODE_NOP;
+					}
+
+					if (vec_opcode == RSX_VEC_OPCODE_ARL)
+					{
+						const vec4 value = read_src(0);
+						for (u32 i = 0; i < 4; ++i)
+						{
+							m_a[m_dst_tmp & 1][i] = static_cast<s32>(value[i]);
+						}
+					}
+					else if (vec_opcode != RSX_VEC_OPCODE_NOP)
+					{
+						vec4 value = read_src(0);
+						switch (vec_opcode)
+						{
+						case RSX_VEC_OPCODE_MOV: break;
+						case RSX_VEC_OPCODE_MUL: value = map(value, read_src(1), [](f32 a, f32 b) { return a * b; }); break;
+						case RSX_VEC_OPCODE_ADD: value = map(value, read_src(2), [](f32 a, f32 b) { return a + b; }); break;
+						case RSX_VEC_OPCODE_MAD:
+						{
+							const vec4 b = read_src(1), c = read_src(2);
+							for (u32 i = 0; i < 4; ++i) value[i] = std::fma(value[i], b[i], c[i]);
+							break;
+						}
+						case RSX_VEC_OPCODE_DP3: value = splat(dot(value, read_src(1), 3)); break;
+						case RSX_VEC_OPCODE_DPH: value[3] = 1.f; value = splat(dot(value, read_src(1), 4)); break;
+						case RSX_VEC_OPCODE_DP4: value = splat(dot(value, read_src(1), 4)); break;
+						case RSX_VEC_OPCODE_DST: value = distance_vector(value, read_src(1)); break;
+						case RSX_VEC_OPCODE_MIN: value = map(value, read_src(1), [](f32 a, f32 b) { return std::min(a, b); }); break;
+						case RSX_VEC_OPCODE_MAX: value = map(value, read_src(1), [](f32 a, f32 b) { return std::max(a, b); }); break;
+						case RSX_VEC_OPCODE_SLT: value = map(value, read_src(1), [](f32 a, f32 b) { return a < b ? 1.f : 0.f; }); break;
+						case RSX_VEC_OPCODE_SGE: value = map(value, read_src(1), [](f32 a, f32 b) { return a >= b ? 1.f : 0.f; }); break;
+						case RSX_VEC_OPCODE_FRC: value = map(value, [](f32 a) { return a - std::floor(a); }); break;
+						case RSX_VEC_OPCODE_FLR: value = map(value, [](f32 a) { return std::floor(a); }); break;
+						case RSX_VEC_OPCODE_SEQ: value = map(value, read_src(1), [](f32 a, f32 b) { return a == b ? 1.f : 0.f; }); break;
+						case RSX_VEC_OPCODE_SFL: value = splat(0.f); break;
+						case RSX_VEC_OPCODE_SGT: value = map(value, read_src(1), [](f32 a, f32 b) { return a > b ? 1.f : 0.f; }); break;
+						case RSX_VEC_OPCODE_SLE: value = map(value, read_src(1), [](f32 a, f32 b) { return a <= b ? 1.f : 0.f; }); break;
+						case RSX_VEC_OPCODE_SNE: value = map(value, read_src(1), [](f32 a, f32 b) { return a != b ? 1.f : 0.f; }); break;
+						case RSX_VEC_OPCODE_STR: value = splat(1.f); break;
+						case RSX_VEC_OPCODE_SSG: value = map(value, [](f32 a) { return a > 0.f ? 1.f : (a < 0.f ? -1.f : 0.f); }); break;
+						default: break;
+						}
+
+						write_vec(value);
+					}
+
+					if (sca_opcode != RSX_SCA_OPCODE_NOP)
+					{
+						f32 value = read_src(2)[0];
+						switch (sca_opcode)
+						{
+						case RSX_SCA_OPCODE_MOV: break;
+						case RSX_SCA_OPCODE_RCP: value = 1.f / value; break;
+						case RSX_SCA_OPCODE_RCC: value = std::clamp(1.f / value, 5.42101e-20f, 1.884467e19f); break;
+						case RSX_SCA_OPCODE_RSQ: value = 1.f / std::sqrt(value); break;
+						case RSX_SCA_OPCODE_EXP: value = std::exp(value); break;
+						case RSX_SCA_OPCODE_LOG: value = std::log(value); break;
+						case RSX_SCA_OPCODE_LG2: value = std::log2(value); break;
+						case RSX_SCA_OPCODE_EX2: value = std::exp2(value); break;
+						case RSX_SCA_OPCODE_SIN: value = std::sin(value); break;
+						case RSX_SCA_OPCODE_COS: value = std::cos(value); break;
+
+						case RSX_SCA_OPCODE_BRA:
+							// Jump by address register
+							if (dynamic_branch()) current_instruction = static_cast<u32>(m_a[m_addr_reg_sel_1][0]);
+							continue;
+						case RSX_SCA_OPCODE_BRI:
+							// Jump immediate
+							if (dynamic_branch()) current_instruction = branch_addr();
+							continue;
+						case RSX_SCA_OPCODE_CAL:
+							// Call immediate
+							if (dynamic_branch() && stack_ptr < std::size(callstack))
+							{
+								callstack[stack_ptr++] = current_instruction;
+								current_instruction = branch_addr();
+							}
+							continue;
+						case RSX_SCA_OPCODE_CLI:
+							// Unknown
+							continue;
+						case RSX_SCA_OPCODE_RET:
+							// Return
+							if (dynamic_branch())
+							{
+								if (stack_ptr == 0)
+								{
+									m_end = true;
+									break;
+								}
+
+								current_instruction = callstack[--stack_ptr];
+							}
+							continue;
+						case RSX_SCA_OPCODE_BRB:
+							// Branch by boolean mask
+							if (static_branch()) current_instruction = branch_addr();
+							continue;
+						case RSX_SCA_OPCODE_CLB:
+							// Call by boolean mask
+							if (static_branch() && stack_ptr < std::size(callstack))
+							{
+								callstack[stack_ptr++] = current_instruction;
+								current_instruction = branch_addr();
+							}
+							continue;
+						default:
+							break;
+						}
+
+						if (sca_opcode != RSX_SCA_OPCODE_RET)
+						{
+							write_sca(value);
+						}
+					}
+				}
+
+				// Unconditionally update COLOR0 and SPECULAR0
+				write_output(1, 0);
+				write_output(2, 1);
+
+				// Conditionally update COLOR1 and SPECULAR1 depending on 2-sided mask
+				if (!m_env.two_sided_lighting)
+				{
+					m_dest[3] = m_dest[1];
+					m_dest[4] = m_dest[2];
+				}
+				else
+				{
+					write_output(3, 2);
+					write_output(4, 3);
+				}
+
+				if (!(m_env.output_mask & (1u << 4)))
+				{
+					m_dest[5][0] = 0.f;
+				}
+
+				write_output(15, 12);
+				write_output(6, 13);
+				write_output(7, 14);
+				write_output(8, 15);
+				write_output(9, 16);
+				write_output(10, 17);
+				write_output(11, 18);
+				write_output(12, 19);
+				write_output(13, 20);
+				write_output(14, 21);
+			}
+		};
+
+		enum fp_register_type : u32
+		{
+			RSX_FP_REGISTER_TYPE_TEMP = 0,
+			RSX_FP_REGISTER_TYPE_INPUT = 1,
+			RSX_FP_REGISTER_TYPE_CONSTANT = 2,
+			RSX_FP_REGISTER_TYPE_UNKNOWN = 3,
+		};
+
+		constexpr f32 modifier_scale[] = { 1.f, 2.f, 4.f, 8.f, 1.f, 0.5f, 0.25f, 0.125f };
+
+		inline u32 pack_snorm(f32 value, f32 scale, u32 mask)
+		{
+			return static_cast<u32>(static_cast<s32>(std::round(std::clamp(value, -1.f, 1.f) * scale))) & mask;
+		}
+
+		inline u32 pack_unorm8(f32 value)
+		{
+			return static_cast<u32>(std::round(std::clamp(value, 0.f, 1.f) * 255.f));
+		}
+
+		// Native channels of a texel in A, R, G, B order
+		using texel = std::array<f32, 4>;
+
+		inline texel expand_565(u16 color)
+		{
+			return { 1.f, ((color >> 11) & 0x1f) / 31.f, ((color >> 5) & 0x3f) / 63.f, (color & 0x1f) / 31.f };
+		}
+
+		texel fetch_compressed_texel(const texture_env& tex, u32 x, u32 y)
+		{
+			// Blocks are stored in the same little endian layout as the S3TC formats of the hardware backends
+			const u32 block_size = tex.format == CELL_GCM_TEXTURE_COMPRESSED_DXT1 ? 8 : 16;
+			const u8* block = tex.data + (y / 4) * tex.pitch + (x / 4) * block_size;
+			const u8* color_block = block + block_size - 8;
+			const u32 index = (y % 4) * 4 + (x % 4);
+
+			const u16 c0 = *reinterpret_cast<const le_t<u16>*>(color_block);
+			const u16 c1 = *reinterpret_cast<const le_t<u16>*>(color_block + 2);
+			const u32 code = (*reinterpret_cast<const le_t<u32>*>(color_block + 4) >> (index * 2)) & 3;
+
+			const texel e0 = expand_565(c0);
+			const texel e1 = expand_565(c1);
+			texel result;
+
+			switch (code)
+			{
+			case 0: result = e0; break;
+			case 1: result = e1; break;
+			default:
+			{
+				if (c0 <= c1 && block_size == 8)
+				{
+					if (code == 3)
+					{
+						return {};
+					}
+
+					for (u32 i = 1; i < 4; ++i) result[i] = (e0[i] + e1[i]) / 2.f;
+				}
+				else
+				{
+					const f32 w = code == 2 ? 1.f / 3.f : 2.f / 3.f;
+					for (u32 i = 1; i < 4; ++i) result[i] = e0[i] + (e1[i] - e0[i]) * w;
+				}
+
+				result[0] = 1.f;
+				break;
+			}
+			}
+
+			if (tex.format == CELL_GCM_TEXTURE_COMPRESSED_DXT23)
+			{
+				const u64 alpha = *reinterpret_cast<const le_t<u64>*>(block);
+				result[0] = ((alpha >> (index * 4)) & 0xf) / 15.f;
+			}
+			else if (tex.format == CELL_GCM_TEXTURE_COMPRESSED_DXT45)
+			{
+				const f32 a0 = block[0] / 255.f;
+				const f32 a1 = block[1] / 255.f;
+				const u64 bits = *reinterpret_cast<const le_t<u64>*>(block) >> 16;
+				const u32 alpha_code = (bits >> (index * 3)) & 7;
+
+				if (alpha_code < 2)
+				{
+					result[0] = alpha_code ? a1 : a0;
+				}
+				else if (block[0] > block[1])
+				{
+					result[0] = ((8 - alpha_code) * a0 + (alpha_code - 1) * a1) / 7.f;
+				}
+				else if (alpha_code < 6)
+				{
+					result[0] = ((6 - alpha_code) * a0 + (alpha_code - 1) * a1) / 5.f;
+				}
+				else
+				{
+					result[0] = alpha_code == 6 ? 0.f : 1.f;
+				}
+			}
+
+			return result;
+		}
+
+		texel fetch_texel(const texture_env& tex, u32 x, u32 y)
+		{
+			switch (tex.format)
+			{
+			case CELL_GCM_TEXTURE_COMPRESSED_DXT1:
+			case CELL_GCM_TEXTURE_COMPRESSED_DXT23:
+			case CELL_GCM_TEXTURE_COMPRESSED_DXT45:
+				return fetch_compressed_texel(tex, x, y);
+			default:
+				break;
+			}
+
+			const u32 bpp = tex.format == CELL_GCM_TEXTURE_B8 ? 1 : tex.format == CELL_GCM_TEXTURE_A8R8G8B8 || tex.format == CELL_GCM_TEXTURE_D8R8G8B8 ? 4 : 2;
+			const u8* ptr = tex.data + (tex.swizzled ? rsx::calculate_z_index(x, y, 0, tex.log2_width, tex.log2_height, 0) * bpp : y * tex.pitch + x * bpp);
+
+			switch (tex.format)
+			{
+			case CELL_GCM_TEXTURE_B8:
+			{
+				const f32 value = ptr[0] / 255.f;
+				return { 1.f, value, value, value };
+			}
+			case CELL_GCM_TEXTURE_A8R8G8B8:
+			case CELL_GCM_TEXTURE_D8R8G8B8:
+			{
+				const u32 value = *reinterpret_cast<const be_t<u32>*>(ptr);
+				const f32 a = tex.format == CELL_GCM_TEXTURE_A8R8G8B8 ? (value >> 24) / 255.f : 1.f;
+				return { a, ((value >> 16) & 0xff) / 255.f, ((value >> 8) & 0xff) / 255.f, (value & 0xff) / 255.f };
+			}
+			case CELL_GCM_TEXTURE_R5G6B5:
+				return expand_565(*reinterpret_cast<const be_t<u16>*>(ptr));
+			case CELL_GCM_TEXTURE_A1R5G5B5:
+			case CELL_GCM_TEXTURE_D1R5G5B5:
+			{
+				const u16 value = *reinterpret_cast<const be_t<u16>*>(ptr);
+				const f32 a = tex.format == CELL_GCM_TEXTURE_A1R5G5B5 ? (value >> 15) : 1.f;
+				return { a, ((value >> 10) & 0x1f) / 31.f, ((value >> 5) & 0x1f) / 31.f, (value & 0x1f) / 31.f };
+			}
+			case CELL_GCM_TEXTURE_R5G5B5A1:
+			{
+				const u16 value = *reinterpret_cast<const be_t<u16>*>(ptr);
+				return { static_cast<f32>(value & 1), (value >> 11) / 31.f, ((value >> 6) & 0x1f) / 31.f, ((value >> 1) & 0x1f) / 31.f };
+			}
+			case CELL_GCM_TEXTURE_A4R4G4B4:
+			{
+				const u16 value = *reinterpret_cast<const be_t<u16>*>(ptr);
+				return { (value >> 12) / 15.f, ((value >> 8) & 0xf) / 15.f, ((value >> 4) & 0xf) / 15.f, (value & 0xf) / 15.f };
+			}
+			default:
+				return {};
+			}
+		}
+
+		// Maps a texel coordinate into [0, size), returns false if the border color is sampled instead
+		bool wrap_texel(rsx::texture_wrap_mode mode, s32& coord, s32 size)
+		{
+			switch (mode)
+			{
+			case rsx::texture_wrap_mode::wrap:
+				coord = ((coord % size) + size) % size;
+				return true;
+			case rsx::texture_wrap_mode::mirror:
+			{
+				const s32 period = ((coord % (size * 2)) + size * 2) % (size * 2);
+				coord = period < size ? period : size * 2 - 1 - period;
+				return true;
+			}
+			case rsx::texture_wrap_mode::border:
+				return coord >= 0 && coord < size;
+			case rsx::texture_wrap_mode::mirror_once_clamp_to_edge:
+			case rsx::texture_wrap_mode::mirror_once_clamp:
+				coord = std::min(coord < 0 ? -1 - coord : coord, size - 1);
+				return true;
+			case rsx::texture_wrap_mode::mirror_once_border:
+				coord = coord < 0 ? -1 - coord : coord;
+				return coord < size;
+			case rsx::texture_wrap_mode::clamp_to_edge:
+			case rsx::texture_wrap_mode::clamp:
+			default:
+				coord = std::clamp(coord, 0, size - 1);
+				return true;
+			}
+		}
+
+		texel fetch_wrapped_texel(const texture_env& tex, s32 x, s32 y)
+		{
+			if (!wrap_texel(tex.wrap_s, x, tex.width) || !wrap_texel(tex.wrap_t, y, tex.height))
+			{
+				return tex.border_color;
+			}
+
+			return fetch_texel(tex, x, y);
+		}
+
+		vec4 sample_texture(const texture_env& tex, f32 s, f32 t)
+		{
+			if (!tex.data)
+			{
+				return splat(0.f);
+			}
+
+			// Bound the coordinates so that the integer conversions below are well defined
+			constexpr f32 coord_limit = 1 << 24;
+			const f32 u = std::isfinite(s) ? std::clamp(tex.normalized ? s * tex.width : s, -coord_limit, coord_limit) : 0.f;
+			const f32 v = std::isfinite(t) ? std::clamp(tex.normalized ? t * tex.height : t, -coord_limit, coord_limit) : 0.f;
+
+			texel value;
+
+			if (!tex.linear_filter)
+			{
+				value = fetch_wrapped_texel(tex, static_cast<s32>(std::floor(u)), static_cast<s32>(std::floor(v)));
+			}
+			else
+			{
+				const f32 fu = u - 0.5f;
+				const f32 fv = v - 0.5f;
+				const f32 x0 = std::floor(fu);
+				const f32 y0 = std::floor(fv);
+				const f32 ax = fu - x0;
+				const f32 ay = fv - y0;
+				const s32 x = static_cast<s32>(x0);
+				const s32 y = static_cast<s32>(y0);
+
+				const texel t00 = fetch_wrapped_texel(tex, x, y);
+				const texel t10 = fetch_wrapped_texel(tex, x + 1, y);
+				const texel t01 = fetch_wrapped_texel(tex, x, y + 1);
+				const texel t11 = fetch_wrapped_texel(tex, x + 1, y + 1);
+
+				for (u32 i = 0; i < 4; ++i)
+				{
+					const f32 top = t00[i] + (t10[i] - t00[i]) * ax;
+					const f32 bottom = t01[i] + (t11[i] - t01[i]) * ax;
+					value[i] = top + (bottom - top) * ay;
+				}
+			}
+
+			texel remapped;
+
+			for (u32 i = 0; i < 4; ++i)
+			{
+				switch (tex.remap_control[i])
+				{
+				case CELL_GCM_TEXTURE_REMAP_REMAP: remapped[i] = value[tex.remap_source[i] & 3]; break;
+				case CELL_GCM_TEXTURE_REMAP_ONE: remapped[i] = 1.f; break;
+				default: remapped[i] = 0.f; break;
+				}
+			}
+
+			vec4 result = { remapped[1], remapped[2], remapped[3], remapped[0] };
+
+			for (u32 i = 0; i < 4; ++i)
+			{
+				if (tex.sign_expand[i]) result[i] = result[i] * 2.f - 1.f;
+			}
+
+			return result;
+		}
+
+		class fragment_interpreter
+		{
+			const fragment_program_env& m_env;
+			const fragment_input& m_in;
+
+			vec4 m_regs16[48]{};
+			vec4 m_regs32[48]{};
+			vec4 m_cc[2]{};
+			vec4 m_vrr{};
+			vec4 m_wpos{};
+			vec4 m_fogc{};
+
+			u32 m_words[4]{};
+			u32 m_opcode = 0;
+			bool m_end = false;
+			s32 m_ip = -1;
+			s32 m_inst_length = 1;
+
+			s32 m_test_addr = -1;
+			s32 m_jump_addr = -1;
+			s32 m_loop_start_addr = -1;
+			s32 m_loop_end_addr = -1;
+			s32 m_counter = 0;
+
+			// Instructions are stored with the halves of every word swapped
+			void fetch_words(s32 ip, u32* dst) const
+			{
+				const u32* src = m_env.ucode + ip * 4;
+				for (u32 i = 0; i < 4; ++i)
+				{
+					dst[i] = ((src[i] << 8) & 0xFF00FF00) | ((src[i] >> 8) & 0x00FF00FF);
+				}
+			}
+
+			vec4 read_cond() const
+			{
+				const vec4& cc = m_cc[get_bits(m_words[1], 31, 1)];
+				const u32 swz = get_bits(m_words[1], 21, 8);
+				return { cc[get_bits(swz, 0, 2)], cc[get_bits(swz, 2, 2)], cc[get_bits(swz, 4, 2)], cc[get_bits(swz, 6, 2)] };
+			}
+
+			bool check_cond() const
+			{
+				const u32 mode = get_bits(m_words[1], 18, 3);
+				if (mode == 0x7)
+				{
+					return true;
+				}
+
+				return test_cond(read_cond(), mode) != 0;
+			}
+
+			vec4 read_src(u32 index)
+			{
+				const u32 word = m_words[index + 1];
+				vec4 value{};
+
+				switch (get_bits(word, 0, 2))
+				{
+				case RSX_FP_REGISTER_TYPE_TEMP:
+				{
+					const u32 reg = get_bits(word, 2, 6);
+					if (reg < 48)
+					{
+						value = test_bit(word, 8) ? m_regs16[reg] : m_regs32[reg];
+					}
+					break;
+				}
+				case RSX_FP_REGISTER_TYPE_INPUT:
+				{
+					const u32 reg = get_bits(m_words[0], 13, 4);
+					switch (reg)
+					{
+					case 0:
+						value = m_wpos; break;
+					case 1:
+						value = m_in.front_facing ? m_in.in_regs[3] : m_in.in_regs[1]; break;
+					case 2:
+						value = m_in.front_facing ? m_in.in_regs[4] : m_in.in_regs[2]; break;
+					case 3:
+						value = m_fogc; break;
+					case 13:
+						value = m_in.in_regs[6]; break;
+					case 14:
+						value = splat(m_in.front_facing ? 1.f : -1.f); break;
+					default:
+						value = m_in.in_regs[std::min(reg + 3, 15u)]; break;
+					}
+					break;
+				}
+				case RSX_FP_REGISTER_TYPE_CONSTANT:
+				{
+					m_inst_length = 2;
+
+					if (static_cast<u32>(m_ip + 2) * 16 <= m_env.ucode_length)
+					{
+						u32 constant[4];
+						fetch_words(m_ip + 1, constant);
+						value = { std::bit_cast<f32>(constant[0]), std::bit_cast<f32>(constant[1]), std::bit_cast<f32>(constant[2]), std::bit_cast<f32>(constant[3]) };
+					}
+					break;
+				}
+				default:
+					break;
+				}
+
+				const u32 swz = get_bits(word, 9, 8);
+				if (swz != 0xE4)
+				{
+					value = { value[get_bits(swz, 0, 2)], value[get_bits(swz, 2, 2)], value[get_bits(swz, 4, 2)], value[get_bits(swz, 6, 2)] };
+				}
+
+				// abs
+				if (index == 0 ? test_bit(m_words[1], 29) : test_bit(word, 18))
+				{
+					value = map(value, [](f32 v) { return std::fabs(v); });
+				}
+
+				// neg
+				if (test_bit(word, 17))
+				{
+					value = map(value, [](f32 v) { return -v; });
+				}
+
+				return value;
+			}
+
+			void write_dst(const vec4& value)
+			{
+				u32 mask = get_bits(m_words[0], 9, 4);
+
+				if (test_bit(m_words[0], 8)) // SET COND
+				{
+					reg_mov(m_cc[get_bits(m_words[1], 30, 1)], value, mask);
+				}
+
+				if (test_bit(m_words[0], 30)) // NO DEST
+				{
+					return;
+				}
+
+				const f32 scale = modifier_scale[get_bits(m_words[2], 28, 3)];
+				vec4 result = map(value, [scale](f32 v) { return v * scale; });
+
+				if (test_bit(m_words[0], 31)) // SAT
+				{
+					result = clamp01(result);
+				}
+
+				const u32 cond = get_bits(m_words[1], 18, 3);
+				if (cond != 0x7)
+				{
+					mask &= test_cond(read_cond(), cond);
+				}
+
+				const u32 reg = get_bits(m_words[0], 1, 6);
+				if (reg >= 48)
+				{
+					return;
+				}
+
+				reg_mov(test_bit(m_words[0], 7) ? m_regs16[reg] : m_regs32[reg], result, mask);
+			}
+
+			void initialize()
+			{
+				// NOTE: Unlike the GLSL version, all registers start zeroed to keep the output deterministic
+
+				// Fog coord
+				m_fogc = m_in.in_regs[5];
+				const f32 fog0 = m_env.fog_param0;
+				const f32 fog1 = m_env.fog_param1;
+				const f32 x = m_fogc[0];
+
+				switch (m_env.fog_mode)
+				{
+				case 0: // linear
+					m_fogc[1] = fog1 * x + (fog0 - 1.f);
+					break;
+				case 1: // exponential
+					m_fogc[1] = std::exp(11.084f * (fog1 * x + fog0 - 1.5f));
+					break;
+				case 2: // exponential2
+					m_fogc[1] = std::exp(-std::pow(4.709f * (fog1 * x + fog0 - 1.5f), 2.f));
+					break;
+				case 3: // exponential_abs
+					m_fogc[1] = std::exp(11.084f * (fog1 * std::fabs(x) + fog0 - 1.5f));
+					break;
+				case 4: // exponential2_abs
+					m_fogc[1] = std::exp(-std::pow(4.709f * (fog1 * std::fabs(x) + fog0 - 1.5f), 2.f));
+					break;
+				case 5: // linear_abs
+					m_fogc[1] = fog1 * std::fabs(x) + (fog0 - 1.f);
+					break;
+				default:
+					break;
+				}
+
+				m_fogc[1] = std::clamp(m_fogc[1], 0.f, 1.f);
+
+				// WPOS
+				const vec4& frag_coord = m_in.frag_coord;
+				m_wpos = { frag_coord[0] * std::fabs(m_env.wpos_scale), frag_coord[1] * m_env.wpos_scale + m_env.wpos_bias, frag_coord[2], frag_coord[3] };
+			}
+
+			vec4 sample(f32 s, f32 t) const
+			{
+				vec4 result = sample_texture(m_env.textures[get_bits(m_words[0], 17, 4)], s, t);
+
+				if (test_bit(m_words[0], 21)) // _bx2
+				{
+					result = map(result, [](f32 v) { return v * 2.f - 1.f; });
+				}
+
+				return result;
+			}
+
+			// Returns false if the instruction was not handled by this class
+			bool execute_one_input(const vec4& s0)
+			{
+				switch (m_opcode)
+				{
+				case RSX_FP_OPCODE_MOV: m_vrr = s0; break;
+				case RSX_FP_OPCODE_FRC: m_vrr = map(s0, [](f32 a) { return a - std::floor(a); }); break;
+				case RSX_FP_OPCODE_FLR: m_vrr = map(s0, [](f32 a) { return std::floor(a); }); break;
+				case RSX_FP_OPCODE_DDX:
+				case RSX_FP_OPCODE_DDY:
+					// Fragments are shaded one at a time, there are no neighbours to derive from
+					m_vrr = splat(0.f); break;
+				case RSX_FP_OPCODE_RCP: m_vrr = splat(1.f / s0[0]); break;
+				case RSX_FP_OPCODE_RSQ: m_vrr = splat(1.f / std::sqrt(s0[0])); break;
+				case RSX_FP_OPCODE_EX2: m_vrr = splat(std::exp2(s0[0])); break;
+				case RSX_FP_OPCODE_LG2: m_vrr = splat(std::log2(s0[0])); break;
+				case RSX_FP_OPCODE_STR: m_vrr = splat(1.f); break;
+				case RSX_FP_OPCODE_SFL: m_vrr = splat(0.f); break;
+				case RSX_FP_OPCODE_COS: m_vrr = splat(std::cos(s0[0])); break;
+				case RSX_FP_OPCODE_SIN: m_vrr = splat(std::sin(s0[0])); break;
+				case RSX_FP_OPCODE_NRM:
+				{
+					const f32 length = std::sqrt(dot(s0, s0, 3));
+					for (u32 i = 0; i < 3; ++i) m_vrr[i] = s0[i] / length;
+					break;
+				}
+				case RSX_FP_OPCODE_TEX:
+					m_vrr = sample(s0[0], s0[1]); break;
+				case RSX_FP_OPCODE_TXP:
+					m_vrr = sample(s0[0] / s0[3], s0[1] / s0[3]); break;
+				case RSX_FP_OPCODE_PK2:
+					m_vrr = splat(std::bit_cast<f32>(float_to_half(s0[0]) | (float_to_half(s0[1]) << 16))); break;
+				case RSX_FP_OPCODE_PK4:
+					m_vrr = splat(std::bit_cast<f32>(pack_snorm(s0[0], 127.f, 0xff) | (pack_snorm(s0[1], 127.f, 0xff) << 8) |
+						(pack_snorm(s0[2], 127.f, 0xff) << 16) | (pack_snorm(s0[3], 127.f, 0xff) << 24))); break;
+				case RSX_FP_OPCODE_PK16:
+					m_vrr = splat(std::bit_cast<f32>(pack_snorm(s0[0], 32767.f, 0xffff) | (pack_snorm(s0[1], 32767.f, 0xffff) << 16))); break;
+				case RSX_FP_OPCODE_PKG:
+					// Should be similar to PKB but with gamma correction
+				case RSX_FP_OPCODE_PKB:
+					m_vrr = splat(std::bit_cast<f32>(pack_unorm8(s0[0]) | (pack_unorm8(s0[1]) << 8) | (pack_unorm8(s0[2]) << 16) | (pack_unorm8(s0[3]) << 24))); break;
+				case RSX_FP_OPCODE_UP2:
+				{
+					const u32 bits = std::bit_cast<u32>(s0[0]);
+					const f32 x = half_to_float(static_cast<u16>(bits)), y = half_to_float(static_cast<u16>(bits >> 16));
+					m_vrr = { x, y, x, y };
+					break;
+				}
+				case RSX_FP_OPCODE_UP4:
+				{
+					const u32 bits = std::bit_cast<u32>(s0[0]);
+					for (u32 i = 0; i < 4; ++i) m_vrr[i] = std::clamp(static_cast<s8>(bits >> (i * 8)) / 127.f, -1.f, 1.f);
+					break;
+				}
+				case RSX_FP_OPCODE_UP16:
+				{
+					const u32 bits = std::bit_cast<u32>(s0[0]);
+					const f32 x = std::clamp(static_cast<s16>(bits) / 32767.f, -1.f, 1.f), y = std::clamp(static_cast<s16>(bits >> 16) / 32767.f, -1.f, 1.f);
+					m_vrr = { x, y, x, y };
+					break;
+				}
+				case RSX_FP_OPCODE_UPG:
+					// Same as UPB with gamma correction
+				case RSX_FP_OPCODE_UPB:
+				{
+					const u32 bits = std::bit_cast<u32>(s0[0]);
+					for (u32 i = 0; i < 4; ++i) m_vrr[i] = static_cast<u8>(bits >> (i * 8)) / 255.f;
+					break;
+				}
+				default:
+					return false;
+				}
+
+				return true;
+			}
+
+			bool execute_two_inputs(const vec4& s0, const vec4& s1)
+			{
+				switch (m_opcode)
+				{
+				case RSX_FP_OPCODE_MUL: m_vrr = map(s0, s1, [](f32 a, f32 b) { return a * b; }); break;
+				case RSX_FP_OPCODE_ADD: m_vrr = map(s0, s1, [](f32 a, f32 b) { return a + b; }); break;
+				case RSX_FP_OPCODE_DP2: m_vrr = splat(dot(s0, s1, 2)); break;
+				case RSX_FP_OPCODE_DP3: m_vrr = splat(dot(s0, s1, 3)); break;
+				case RSX_FP_OPCODE_DP4: m_vrr = splat(dot(s0, s1, 4)); break;
+				case RSX_FP_OPCODE_DST: m_vrr = distance_vector(s0, s1); break;
+				case RSX_FP_OPCODE_MIN: m_vrr = map(s0, s1, [](f32 a, f32 b) { return std::min(a, b); }); break;
+				case RSX_FP_OPCODE_MAX: m_vrr = map(s0, s1, [](f32 a, f32 b) { return std::max(a, b); }); break;
+				case RSX_FP_OPCODE_SLT: m_vrr = map(s0, s1, [](f32 a, f32 b) { return a < b ? 1.f : 0.f; }); break;
+				case RSX_FP_OPCODE_SGE: m_vrr = map(s0, s1, [](f32 a, f32 b) { return a >= b ? 1.f : 0.f; }); break;
+				case RSX_FP_OPCODE_SLE: m_vrr = map(s0, s1, [](f32 a, f32 b) { return a <= b ? 1.f : 0.f; }); break;
+				case RSX_FP_OPCODE_SGT: m_vrr = map(s0, s1, [](f32 a, f32 b) { return a > b ? 1.f : 0.f; }); break;
+				case RSX_FP_OPCODE_SNE: m_vrr = map(s0, s1, [](f32 a, f32 b) { return a != b ? 1.f : 0.f; }); break;
+				case RSX_FP_OPCODE_SEQ: m_vrr = map(s0, s1, [](f32 a, f32 b) { return a == b ? 1.f : 0.f; }); break;
+				case RSX_FP_OPCODE_POW: m_vrr = splat(std::pow(s0[0], s1[0])); break;
+				case RSX_FP_OPCODE_DIV: m_vrr = map(s0, [d = s1[0]](f32 a) { return a / d; }); break;
+				case RSX_FP_OPCODE_DIVSQ:
+				{
+					const f32 factor = 1.f / std::sqrt(s1[0]);
+					m_vrr = map(s0, [factor](f32 a) { return a != 0.f ? a * factor : a; });
+					break;
+				}
+				case RSX_FP_OPCODE_REFL:
+				{
+					const f32 d = 2.f * dot(s1, s0, 4);
+					m_vrr = map(s0, s1, [d](f32 a, f32 b) { return a - d * b; });
+					break;
+				}
+				case RSX_FP_OPCODE_TXL:
+				case RSX_FP_OPCODE_TXB:
+					// Only the base level is resident, the bias and lod are ignored
+					m_vrr = sample(s0[0], s0[1]); break;
+				default:
+					return false;
+				}
+
+				return true;
+			}
+
+			void execute_three_inputs(const vec4& s0, const vec4& s1, const vec4& s2)
+			{
+				switch (m_opcode)
+				{
+				case RSX_FP_OPCODE_MAD:
+					for (u32 i = 0; i < 4; ++i) m_vrr[i] = std::fma(s0[i], s1[i], s2[i]);
+					break;
+				case RSX_FP_OPCODE_LRP:
+					for (u32 i = 0; i < 4; ++i) m_vrr[i] = s1[i] * (1.f - s0[i]) + s2[i] * s0[i];
+					break;
+				case RSX_FP_OPCODE_DP2A:
+					m_vrr = splat(dot(s0, s1, 2) + s2[0]);
+					break;
+				default:
+					break;
+				}
+			}
+
+			// Returns false if the flow control instruction terminated the program
+			bool execute_flow_control()
+			{
+				switch (m_opcode | (1 << 6))
+				{
+				case RSX_FP_OPCODE_RET:
+					return false;
+				case RSX_FP_OPCODE_IFE:
+					if (check_cond())
+					{
+						// Go down IF path
+						if (m_words[2] < m_words[3])
+						{
+							m_test_addr = static_cast<s32>(m_words[2] >> 2);
+							m_jump_addr = static_cast<s32>(m_words[3] >> 2);
+						}
+						// If simple IF..ENDIF, do nothing
+					}
+					else
+					{
+						// Go to ELSE path
+						m_ip = static_cast<s32>(m_words[2] >> 2);
+						m_inst_length = 0;
+					}
+					break;
+				case RSX_FP_OPCODE_LOOP:
+				case RSX_FP_OPCODE_REP:
+					if (check_cond())
+					{
+						const s32 step = static_cast<s32>(get_bits(m_words[2], 19, 8));
+						m_counter = static_cast<s32>(get_bits(m_words[2], 2, 8)) - static_cast<s32>(get_bits(m_words[2], 10, 8));
+						m_counter = step ? m_counter / step : 0;
+						m_loop_start_addr = m_ip + 1;
+						m_loop_end_addr = static_cast<s32>(m_words[3] >> 2);
+					}
+					else
+					{
+						m_ip = static_cast<s32>(m_words[3] >> 2);
+						m_inst_length = 0;
+					}
+					break;
+				case RSX_FP_OPCODE_BRK:
+					if (m_loop_end_addr > 0)
+					{
+						m_ip = m_loop_end_addr;
+						m_inst_length = 0;
+						m_counter = 0;
+					}
+					break;
+				default:
+					break;
+				}
+
+				return true;
+			}
+
+		public:
+			fragment_interpreter(const fragment_program_env& env, const fragment_input& in)
+				: m_env(env), m_in(in)
+			{}
+
+			bool run(fragment_output& out)
+			{
+				initialize();
+
+				const s32 instruction_count = static_cast<s32>(m_env.ucode_length / 16);
+
+				for (u32 executed = 0; !m_end && executed < max_instructions_executed; ++executed)
+				{
+					m_ip += m_inst_length;
+					m_inst_length = 1;
+
+					if (m_ip == m_test_addr)
+					{
+						m_ip = m_jump_addr;
+						m_test_addr = -1;
+						m_jump_addr = -1;
+					}
+					else if (m_ip == m_loop_end_addr)
+					{
+						if (m_counter > 0)
+						{
+							m_counter--;
+							m_ip = m_loop_start_addr;
+						}
+						else
+						{
+							m_loop_end_addr = -1;
+							m_loop_start_addr = -1;
+						}
+					}
+
+					if (m_ip < 0 || m_ip >= instruction_count)
+					{
+						break;
+					}
+
+					// Decode instruction
+					fetch_words(m_ip, m_words);
+					m_opcode = get_bits(m_words[0], 24, 6);
+					m_end = test_bit(m_words[0], 0);
+
+					if (test_bit(m_words[2], 31))
+					{
+						// Flow control
+						if (!execute_flow_control())
+						{
+							break;
+						}
+
+						continue;
+					}
+
+					// Class 1, no input/output
+					switch (m_opcode)
+					{
+					case RSX_FP_OPCODE_NOP:
+					case RSX_FP_OPCODE_FENCT:
+					case RSX_FP_OPCODE_FENCB:
+						continue;
+					case RSX_FP_OPCODE_KIL:
+						if (check_cond())
+						{
+							return false;
+						}
+						continue;
+					default:
+						break;
+					}
+
+					// Class 2, 1 input
+					const vec4 s0 = read_src(0);
+					if (!execute_one_input(s0))
+					{
+						// Class 3, 2 inputs
+						const vec4 s1 = read_src(1);
+						if (!execute_two_inputs(s0, s1))
+						{
+							// Class 4, 3 inputs
+							execute_three_inputs(s0, s1, read_src(2));
+						}
+					}
+
+					write_dst(m_vrr);
+				}
+
+				if (m_env.shader_control & CELL_GCM_SHADER_CONTROL_32_BITS_EXPORTS)
+				{
+					out.color = { m_regs32[0], m_regs32[2], m_regs32[3], m_regs32[4] };
+				}
+				else
+				{
+					out.color = { m_regs16[0], m_regs16[4], m_regs16[6], m_regs16[8] };
+				}
+
+				out.depth_export = (m_env.shader_control & CELL_GCM_SHADER_CONTROL_DEPTH_EXPORT) != 0;
+				out.depth = out.depth_export ? m_regs32[1][2] : m_in.frag_coord[2];
+
+				if (m_env.alpha_test)
+				{
+					const f32 alpha = out.color[0][3];
+					const f32 ref = m_env.alpha_ref;
+
+					switch (m_env.alpha_func)
+					{
+					case rsx::comparison_function::never: return false;
+					case rsx::comparison_function::less: return alpha < ref;
+					case rsx::comparison_function::equal: return alpha == ref;
+					case rsx::comparison_function::less_or_equal: return alpha <= ref;
+					case rsx::comparison_function::greater: return alpha > ref;
+					case rsx::comparison_function::not_equal: return alpha != ref;
+					case rsx::comparison_function::greater_or_equal: return alpha >= ref;
+					case rsx::comparison_function::always: break;
+					}
+				}
+
+				return true;
+			}
+		};
+	}
+
+	void run_vertex_program(const vertex_program_env& env, const vertex_fetch_env& fetch, u32 vertex_id, vec4* dest)
+	{
+		vertex_interpreter(env, fetch, vertex_id, dest).run();
+	}
+
+	bool run_fragment_program(const fragment_program_env& env, const fragment_input& in, fragment_output& out)
+	{
+		return fragment_interpreter(env, in).run(out);
+	}
+}
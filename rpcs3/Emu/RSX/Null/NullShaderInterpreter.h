@@ -0,0 +1,96 @@
+#pragma once
+
+#include "Emu/RSX/gcm_enums.h"
+#include "util/types.hpp"
+
+#include <array>
+
+namespace rsx::sw
+{
+	using vec4 = std::array<f32, 4>;
+
+	// Vertex program environment, equivalent to the uniforms of the GLSL vertex interpreter
+	struct vertex_program_env
+	{
+		const u32* ucode = nullptr;          // Raw transform program block (512 instructions of 4 words)
+		const u32 (*constants)[4] = nullptr; // Transform constants (468 vectors)
+		u32 entry = 0;                       // Absolute address of the first instruction
+		u32 output_mask = 0;
+		u32 branch_bits = 0;
+		bool two_sided_lighting = false;
+	};
+
+	// Vertex streams as written by rsx::thread::write_vertex_data_to_memory
+	struct vertex_fetch_env
+	{
+		const s32* layout = nullptr;         // 16 attribute descriptors generated by fill_vertex_layout_state
+		const u8* persistent_data = nullptr;
+		const u8* volatile_data = nullptr;
+		u32 vertex_index_base = 0;
+		u32 vertex_index_offset = 0;
+	};
+
+	// Fragment texture unit, only the base mipmap level of 2D textures is sampled
+	struct texture_env
+	{
+		const u8* data = nullptr;            // Host mapping of the texture, nullptr if the unit reads as zero
+		u32 format = 0;                      // CELL_GCM_TEXTURE_* without the LN and UN flags
+		u32 pitch = 0;                       // Bytes per row, or per row of blocks for compressed formats
+		u16 width = 0;
+		u16 height = 0;
+		u8 log2_width = 0;                   // Swizzled layout only
+		u8 log2_height = 0;
+		bool swizzled = false;
+		bool normalized = true;
+		bool linear_filter = false;
+		rsx::texture_wrap_mode wrap_s = rsx::texture_wrap_mode::wrap;
+		rsx::texture_wrap_mode wrap_t = rsx::texture_wrap_mode::wrap;
+		std::array<u8, 4> remap_source = {}; // Remap lookup as returned by fragment_texture::decoded_remap, ARGB order
+		std::array<u8, 4> remap_control = {};
+		std::array<bool, 4> sign_expand = {}; // RGBA
+		vec4 border_color = {};              // ARGB
+	};
+
+	// Fragment program environment, equivalent to the uniforms of the GLSL fragment interpreter
+	struct fragment_program_env
+	{
+		const u32* ucode = nullptr;          // Raw fragment program ucode (guest layout)
+		u32 ucode_length = 0;
+		u32 shader_control = 0;
+		f32 fog_param0 = 0.f;
+		f32 fog_param1 = 0.f;
+		u32 fog_mode = 0;
+		f32 wpos_scale = 1.f;
+		f32 wpos_bias = 0.f;
+		bool alpha_test = false;
+		rsx::comparison_function alpha_func = rsx::comparison_function::always;
+		f32 alpha_ref = 0.f;
+		std::array<texture_env, 16> textures = {};
+	};
+
+	struct fragment_input
+	{
+		vec4 frag_coord;                     // Pixel center, window depth and 1/w
+		const vec4* in_regs;                 // Interpolated vertex program outputs
+		bool front_facing;
+	};
+
+	struct fragment_output
+	{
+		std::array<vec4, 4> color;
+		f32 depth;
+		bool depth_export;
+	};
+
+	/**
+	 * Runs the vertex program for one vertex. vertex_id has the same meaning as gl_VertexID in the hardware backends.
+	 * Fills the 16 output registers; dest[0] holds the position before the viewport transform.
+	 */
+	void run_vertex_program(const vertex_program_env& env, const vertex_fetch_env& fetch, u32 vertex_id, vec4* dest);
+
+	/**
+	 * Runs the fragment program for one fragment. Returns false if the fragment was discarded.
+	 * Textures are sampled at their base level with point or bilinear filtering, screen space derivatives read as zero.
+	 */
+	bool run_fragment_program(const fragment_program_env& env, const fragment_input& in, fragment_output& out);
+}
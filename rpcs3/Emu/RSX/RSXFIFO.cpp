@@ -216,6 +216,121 @@ namespace rsx
 			data.set(m_cmd & 0xfffc, vm::read32(m_args_ptr));
 		}
 
+		bool FIFO_control::decode_subroutine(u32 offs, decoded_subroutine& result)
+		{
+			// Registers whose handlers read their arguments directly from the FIFO or depend on the current GET position
+			const auto is_cacheable = [](u32 reg)
+			{
+				static constexpr std::array<std::pair<u32, u32>, 3> ranges
+				{{
+					{NV308A_COLOR, 0x700},
+					{NV4097_SET_TRANSFORM_PROGRAM, 32},
+					{NV4097_SET_TRANSFORM_CONSTANT, 32}
+				}};
+
+				if (reg < (0x100 >> 2))
+				{
+					// Object binding and NV406E (reference, semaphores)
+					return false;
+				}
+
+				for (const auto& range : ranges)
+				{
+					if (reg >= range.first && reg < range.first + range.second)
+					{
+						return false;
+					}
+				}
+
+				return true;
+			};
+
+			result.ea = m_iotable->get_addr(offs);
+			result.cacheable = false;
+			result.raw.clear();
+			result.commands.clear();
+
+			if (result.ea == umax)
+			{
+				return false;
+			}
+
+			const u32 put = read_put<false>();
+
+			// Read the next word (must stay within the same io page and must not reach PUT)
+			const auto read_word = [&](u32& word) -> bool
+			{
+				const u32 pos = offs + ::size32(result.raw) * 4;
+
+				if (pos == put)
+				{
+					// Don't remember this result, PUT may move later
+					result.raw.clear();
+					return false;
+				}
+
+				if ((pos >> 20) != (offs >> 20) || result.raw.size() >= 0x4000)
+				{
+					return false;
+				}
+
+				const u32 raw = vm::_ref<u32>(result.ea + (pos - offs));
+				result.raw.push_back(raw);
+				word = std::bit_cast<be_t<u32>>(raw);
+				return true;
+			};
+
+			for (u32 cmd; read_word(cmd);)
+			{
+				if (cmd & RSX_METHOD_NON_METHOD_CMD_MASK)
+				{
+					// Jumps and nested calls are not allowed
+					result.cacheable = (cmd & RSX_METHOD_RETURN_MASK) == RSX_METHOD_RETURN_CMD;
+					return result.cacheable;
+				}
+
+				const u32 count = (cmd >> 18) & 0x7ff;
+				const u32 inc = ((cmd & RSX_METHOD_NON_INCREMENT_CMD_MASK) == RSX_METHOD_NON_INCREMENT_CMD) ? 0 : 1;
+
+				for (u32 i = 0, reg = (cmd & 0xfffc) >> 2, arg; i < count; i++, reg += inc)
+				{
+					if (!read_word(arg) || !is_cacheable(reg))
+					{
+						return false;
+					}
+
+					result.commands.push_back({reg, arg});
+				}
+			}
+
+			return false;
+		}
+
+		const decoded_subroutine* FIFO_control::get_subroutine(u32 offs)
+		{
+			if (m_call_cache_invalidated.exchange(false))
+			{
+				m_call_cache.clear();
+			}
+
+			if (m_call_cache.size() >= max_call_cache_size && !m_call_cache.contains(offs))
+			{
+				// Start over, the entries which are still in use are decoded again
+				m_call_cache.clear();
+			}
+
+			auto& entry = m_call_cache[offs];
+
+			// Validate the mapping and the contents (commands are written by the CPU without any notification)
+			if (!entry.raw.empty() && entry.ea == m_iotable->get_addr(offs) &&
+				std::memcmp(entry.raw.data(), vm::base(entry.ea), entry.raw.size() * 4) == 0)
+			{
+				return entry.cacheable ? &entry : nullptr;
+			}
+
+			return decode_subroutine(offs, entry) ? &entry : nullptr;
+		}
+
 		void flattening_helper::reset(bool _enabled)
 		{
 			enabled = _enabled;
@@ -380,6 +495,42 @@ namespace rsx
 		}
 	}
 
+	void thread::set_FIFO_running()
+	{
+		if (const auto state = performance_counters.state;
+			state != FIFO_state::running)
+		{
+			performance_counters.state = FIFO_state::running;
+
+			// Hack: Delay FIFO wake-up according to setting
+			// NOTE: The typical spin setup is a NOP followed by a jump-to-self
+			// NOTE: There is a small delay when the jump address is dynamically edited by cell
+			if (state != FIFO_state::nop)
+			{
+				fifo_wake_delay();
+			}
+
+			// Update performance counters with time spent in idle mode
+			performance_counters.idle_time += (get_system_time() - performance_counters.FIFO_idle_timestamp);
+		}
+	}
+
+	void thread::run_FIFO_subroutine(const FIFO::decoded_subroutine& sub)
+	{
+		set_FIFO_running();
+
+		// Methods are already validated, only dispatch remains
+		for (const auto& [reg, value] : sub.commands)
+		{
+			method_registers.decode(reg, value);
+
+			if (auto method = methods[reg])
+			{
+				method(this, reg, value);
+			}
+		}
+	}
+
 	void thread::run_FIFO()
 	{
 		FIFO::register_pair command;
@@ -478,6 +629,18 @@ namespace rsx
 				}
 
 				const u32 offs = cmd & RSX_METHOD_CALL_OFFSET_MASK;
+
+				if (!capture_current_frame && !m_flattener.is_enabled())
+				{
+					if (const auto sub = fifo_ctrl->get_subroutine(offs))
+					{
+						// Execute the whole subroutine at once and continue after the CALL
+						run_FIFO_subroutine(*sub);
+						fifo_ctrl->set_get(fifo_ctrl->get_pos() + 4);
+						return;
+					}
+				}
+
 				fifo_ret_addr = fifo_ctrl->get_pos() + 4;
 				fifo_ctrl->set_get(offs);
 				return;
@@ -499,22 +662,7 @@ namespace rsx
 			fmt::throw_exception("Unexpected command 0x%x", cmd);
 		}
 
-		if (const auto state = performance_counters.state;
-			state != FIFO_state::running)
-		{
-			performance_counters.state = FIFO_state::running;
-
-			// Hack: Delay FIFO wake-up according to setting
-			// NOTE: The typical spin setup is a NOP followed by a jump-to-self
-			// NOTE: There is a small delay when the jump address is dynamically edited by cell
-			if (state != FIFO_state::nop)
-			{
-				fifo_wake_delay();
-			}
-
-			// Update performance counters with time spent in idle mode
-			performance_counters.idle_time += (get_system_time() - performance_counters.FIFO_idle_timestamp);
-		}
+		set_FIFO_running();
 
 		do
 		{
@@ -1,8 +1,12 @@
 #pragma once
 
 #include "util/types.hpp"
+#include "util/atomic.hpp"
 #include "Emu/RSX/gcm_enums.h"
 
+#include <vector>
+#include <unordered_map>
+
 struct RsxDmaControl;
 
 namespace rsx
@@ -108,6 +112,22 @@ namespace rsx
 			inline flatten_op test(register_pair& command);
 		};
 
+		// Pre-decoded command subroutine (target of a CALL command)
+		struct decoded_subroutine
+		{
+			// Effective address of the first command
+			u32 ea = 0;
+
+			// False if the subroutine contains commands which must go through the regular FIFO path
+			bool cacheable = false;
+
+			// Raw command words (in memory byte order) used to validate the cache entry
+			std::vector<u32> raw;
+
+			// Decoded methods up to the RET command (reg is the register index)
+			std::vector<register_pair> commands;
+		};
+
 		class FIFO_control
 		{
 		private:
@@ -124,6 +144,13 @@ namespace rsx
 			u32 m_args_ptr = 0;
 			u32 m_cmd = ~0u;
 
+			// Decoded CALL targets: io offset -> subroutine
+			static constexpr usz max_call_cache_size = 4096;
+			std::unordered_map<u32, decoded_subroutine> m_call_cache;
+			atomic_t<bool> m_call_cache_invalidated = false;
+
+			bool decode_subroutine(u32 offs, decoded_subroutine& result);
+
 		public:
 			FIFO_control(rsx::thread* pctrl);
 			~FIFO_control() = default;
@@ -141,6 +168,12 @@ namespace rsx
 			void read(register_pair& data);
 			inline bool read_unsafe(register_pair& data);
 			bool skip_methods(u32 count);
+
+			// Get validated pre-decoded subroutine at the io offset, or nullptr if it can't be used
+			const decoded_subroutine* get_subroutine(u32 offs);
+
+			// Drop all decoded subroutines (can be called from any thread)
+			void invalidate_subroutines() { m_call_cache_invalidated = true; }
 		};
 	}
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "rsx_utils.h"
 
 #include <thread>
+#include <chrono>
 #include "util/asm.hpp"
 
 namespace rsx
@@ -17,8 +18,87 @@ namespace rsx
 		atomic_t<u64> m_processed_count = 0;
 		transport_packet* m_current_job = nullptr;
 
+		// Payloads of staged copies, allocated in a ring and released in submission order
+		static constexpr u32 arena_size = 0x400000;
+		std::unique_ptr<u8[]> m_arena;
+		u32 m_arena_put = 0;
+		atomic_t<u32> m_arena_used = 0;
+
+		// Queue statistics, reset by get_queue_stats()
+		atomic_t<u32> m_max_depth = 0;
+		atomic_t<u64> m_total_latency = 0;
+		atomic_t<u64> m_latency_samples = 0;
+
 		std::thread::id m_thread_id;
 
+		// Reserves arena space for a payload. Returns nullptr if the payload does not fit right now
+		u8* stage(u32 length, u32& reserved)
+		{
+			const u32 aligned = utils::align(length, 64);
+
+			if (aligned > arena_size / 4)
+			{
+				return nullptr;
+			}
+
+			if (!m_arena)
+			{
+				m_arena = std::make_unique<u8[]>(arena_size);
+			}
+
+			u32 offset = m_arena_put;
+			reserved = aligned;
+
+			if (offset + aligned > arena_size)
+			{
+				// The tail of the ring is released together with this payload
+				reserved += arena_size - offset;
+				offset = 0;
+			}
+
+			if (m_arena_used + reserved > arena_size)
+			{
+				return nullptr;
+			}
+
+			m_arena_used += reserved;
+			m_arena_put = offset + aligned;
+			return m_arena.get() + offset;
+		}
+
+		void process(transport_packet& job)
+		{
+			m_current_job = &job;
+
+			switch (job.type)
+			{
+			case raw_copy:
+			{
+				std::memcpy(job.dst, job.src, job.length);
+				break;
+			}
+			case staged_copy:
+			{
+				std::memcpy(job.dst, job.src, job.length);
+				m_arena_used -= job.aux_param0;
+				break;
+			}
+			case index_emulate:
+			{
+				write_index_array_for_non_indexed_non_native_primitive_to_buffer(static_cast<char*>(job.dst), static_cast<rsx::primitive_type>(job.aux_param0), job.length);
+				break;
+			}
+			case callback:
+			{
+				rsx::get_current_renderer()->renderctl(job.aux_param0, job.src);
+				break;
+			}
+			default: fmt::throw_exception("Unreachable");
+			}
+
+			m_processed_count.release(m_processed_count + 1);
+		}
+
 		void operator ()()
 		{
 			if (!g_cfg.video.multithreaded_rsx)
@@ -38,34 +118,20 @@ namespace rsx
 			{
 				for (auto&& job : m_work_queue.pop_all())
 				{
-					m_current_job = &job;
-
-					switch (job.type)
+					if (job.type == packet_batch)
 					{
-					case raw_copy:
-					{
-						std::memcpy(job.dst, job.src, job.length);
-						break;
-					}
-					case vector_copy:
-					{
-						std::memcpy(job.dst, job.opt_storage.data(), job.length);
-						break;
+						for (auto& packet : job.batch)
+						{
+							process(packet);
+						}
 					}
-					case index_emulate:
+					else
 					{
-						write_index_array_for_non_indexed_non_native_primitive_to_buffer(static_cast<char*>(job.dst), static_cast<rsx::primitive_type>(job.aux_param0), job.length);
-						break;
-					}
-					case callback:
-					{
-						rsx::get_current_renderer()->renderctl(job.aux_param0, job.src);
-						break;
-					}
-					default: fmt::throw_exception("Unreachable");
+						process(job);
 					}
 
-					m_processed_count.release(m_processed_count + 1);
+					m_total_latency += get_system_time() - job.timestamp;
+					m_latency_samples++;
 				}
 
 				m_current_job = nullptr;
@@ -92,35 +158,175 @@ namespace rsx
 	// initialization
 	void dma_manager::init()
 	{
+		if (g_cfg.video.multithreaded_rsx)
+		{
+			calibrate();
+		}
+	}
+
+	void dma_manager::calibrate()
+	{
+		// Offloading pays off once copying on the calling thread costs more than handing the packet over.
+		// Both sides are measured on the host instead of relying on numbers profiled on a single CPU.
+		using clock = std::chrono::steady_clock;
+
+		constexpr u32 block_size = 0x40000;
+		constexpr u32 packet_count = 256;
+		constexpr u32 rounds = 4;
+
+		const auto elapsed_ns = [](clock::time_point start)
+		{
+			return static_cast<f64>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count());
+		};
+
+		std::vector<u8> src(block_size, 0x55);
+		std::vector<u8> dst(block_size);
+		std::vector<transport_packet> batch;
+		lf_queue<transport_packet> queue;
+
+		// Keeps the measured work observable
+		volatile u64 sink = 0;
+
+		f64 copy_ns = 1e18, push_ns = 1e18, append_ns = 1e18;
+
+		// Take the best of a few rounds to filter out preemption
+		for (u32 round = 0; round < rounds; round++)
+		{
+			auto start = clock::now();
+			std::memcpy(dst.data(), src.data(), block_size);
+			copy_ns = std::min(copy_ns, elapsed_ns(start));
+			sink = dst[round];
+
+			start = clock::now();
+			for (u32 i = 0; i < packet_count; i++)
+			{
+				queue.push(dst.data(), src.data(), i);
+			}
+			push_ns = std::min(push_ns, elapsed_ns(start) / packet_count);
+
+			for (auto&& packet : queue.pop_all())
+			{
+				sink = packet.length;
+			}
+
+			start = clock::now();
+			for (u32 i = 0; i < packet_count; i++)
+			{
+				batch.emplace_back(dst.data(), src.data(), i);
+			}
+			append_ns = std::min(append_ns, elapsed_ns(start) / packet_count);
+
+			sink = batch.size();
+			batch = {};
+		}
+
+		const f64 bytes_per_ns = block_size / std::max(copy_ns, 1.);
+
+		const auto to_size = [&](f64 ns, u32 alignment, u32 min, u32 max)
+		{
+			return std::clamp(utils::align(static_cast<u32>(std::min(ns * bytes_per_ns, 1e9)), alignment), min, max);
+		};
+
+		max_immediate_transfer_size = to_size(push_ns, 512, 1024, 65536);
+		max_immediate_batched_size = to_size(append_ns, 64, 256, max_immediate_transfer_size);
+
+		rsx_log.notice("DMA offload thresholds: %u bytes, %u bytes batched (copy: %.2f GB/s, queue push: %.0fns, batch append: %.0fns)",
+			max_immediate_transfer_size, max_immediate_batched_size, bytes_per_ns, push_ns, append_ns);
+	}
+
+	void dma_manager::submit(transport_packet&& packet)
+	{
+		if (m_batch_open)
+		{
+			m_batch.emplace_back(std::move(packet));
+			return;
+		}
+
+		const auto _thr = g_fxo->get<dma_thread>();
+		const u64 enqueued = ++_thr->m_enqueued_count;
+
+		if (const u64 processed = _thr->m_processed_count; processed < enqueued)
+		{
+			_thr->m_max_depth.fetch_op([&](u32& v) { v = std::max<u32>(v, static_cast<u32>(enqueued - processed)); });
+		}
+
+		packet.timestamp = get_system_time();
+		_thr->m_work_queue.push(std::move(packet));
 	}
 
 	// General transport
-	void dma_manager::copy(void *dst, std::vector<u8>& src, u32 length)
+	void dma_manager::copy(void *dst, const std::vector<u8>& src, u32 length)
 	{
-		if (length <= max_immediate_transfer_size || !g_cfg.video.multithreaded_rsx)
+		if (length <= (m_batch_open ? max_immediate_batched_size : max_immediate_transfer_size) || !g_cfg.video.multithreaded_rsx)
 		{
 			std::memcpy(dst, src.data(), length);
+			return;
+		}
+
+		u32 reserved = 0;
+
+		if (u8* staging = g_fxo->get<dma_thread>()->stage(length, reserved))
+		{
+			// The caller keeps its vector, the payload is carried by the arena
+			std::memcpy(staging, src.data(), length);
+			submit({ dst, staging, length, reserved });
 		}
 		else
 		{
-			g_fxo->get<dma_thread>()->m_enqueued_count++;
-			g_fxo->get<dma_thread>()->m_work_queue.push(dst, src, length);
+			std::memcpy(dst, src.data(), length);
 		}
 	}
 
 	void dma_manager::copy(void *dst, void *src, u32 length)
 	{
-		if (length <= max_immediate_transfer_size || !g_cfg.video.multithreaded_rsx)
+		if (length <= (m_batch_open ? max_immediate_batched_size : max_immediate_transfer_size) || !g_cfg.video.multithreaded_rsx)
 		{
 			std::memcpy(dst, src, length);
 		}
 		else
 		{
-			g_fxo->get<dma_thread>()->m_enqueued_count++;
-			g_fxo->get<dma_thread>()->m_work_queue.push(dst, src, length);
+			submit({ dst, src, length });
 		}
 	}
 
+	void dma_manager::begin_batch()
+	{
+		// Batches are recorded by the RSX thread only and must not be left open across sync points
+		ensure(!m_batch_open);
+		m_batch_open = g_cfg.video.multithreaded_rsx.get();
+	}
+
+	void dma_manager::end_batch()
+	{
+		if (!std::exchange(m_batch_open, false) || m_batch.empty())
+		{
+			return;
+		}
+
+		if (m_batch.size() == 1)
+		{
+			submit(std::move(m_batch.front()));
+			m_batch.clear();
+			return;
+		}
+
+		const auto _thr = g_fxo->get<dma_thread>();
+		const u64 count = m_batch.size();
+		const u64 enqueued = (_thr->m_enqueued_count += count);
+
+		if (const u64 processed = _thr->m_processed_count; processed < enqueued)
+		{
+			_thr->m_max_depth.fetch_op([&](u32& v) { v = std::max<u32>(v, static_cast<u32>(enqueued - processed)); });
+		}
+
+		transport_packet node(std::move(m_batch));
+		node.timestamp = get_system_time();
+		_thr->m_work_queue.push(std::move(node));
+
+		m_batch.clear();
+		m_batch.reserve(count);
+	}
+
 	// Vertex utilities
 	void dma_manager::emulate_as_indexed(void *dst, rsx::primitive_type primitive, u32 count)
 	{
@@ -131,8 +337,7 @@ namespace rsx
 		}
 		else
 		{
-			g_fxo->get<dma_thread>()->m_enqueued_count++;
-			g_fxo->get<dma_thread>()->m_work_queue.push(dst, primitive, count);
+			submit({ dst, primitive, count });
 		}
 	}
 
@@ -141,8 +346,7 @@ namespace rsx
 	{
 		ensure(g_cfg.video.multithreaded_rsx);
 
-		g_fxo->get<dma_thread>()->m_enqueued_count++;
-		g_fxo->get<dma_thread>()->m_work_queue.push(request_code, args);
+		submit({ request_code, args });
 	}
 
 	// Synchronization
@@ -215,7 +419,7 @@ namespace rsx
 		case raw_copy:
 			address = (writing) ? m_current_job->dst : m_current_job->src;
 			break;
-		case vector_copy:
+		case staged_copy:
 			ensure(writing);
 			address = m_current_job->dst;
 			break;
@@ -230,4 +434,14 @@ namespace rsx
 
 		return utils::address_range::start_length(vm::get_addr(address), range);
 	}
+
+	void dma_manager::get_queue_stats(u32& max_depth, u64& average_latency)
+	{
+		const auto _thr = g_fxo->get<dma_thread>();
+		const u64 samples = _thr->m_latency_samples.exchange(0);
+		const u64 latency = _thr->m_total_latency.exchange(0);
+
+		max_depth = _thr->m_max_depth.exchange(0);
+		average_latency = samples ? latency / samples : 0;
+	}
 }
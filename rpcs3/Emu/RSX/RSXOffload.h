@@ -13,27 +13,30 @@ namespace rsx
 		enum op
 		{
 			raw_copy = 0,
-			vector_copy = 1,
+			staged_copy = 1,
 			index_emulate = 2,
-			callback = 3
+			callback = 3,
+			packet_batch = 4
 		};
 
 		struct transport_packet
 		{
 			op type;
-			std::vector<u8> opt_storage;
+			std::vector<transport_packet> batch;
 			void *src;
 			void *dst;
 			u32 length;
 			u32 aux_param0;
 			u32 aux_param1;
+			u64 timestamp = 0;
 
 			transport_packet(void *_dst, void *_src, u32 len)
 				: type(op::raw_copy), src(_src), dst(_dst), length(len)
 			{}
 
-			transport_packet(void *_dst, std::vector<u8>& _src, u32 len)
-				: type(op::vector_copy), opt_storage(std::move(_src)), dst(_dst), length(len)
+			// Source lives in the staging arena, aux_param0 is the amount of arena space to release
+			transport_packet(void *_dst, void *_src, u32 len, u32 arena_len)
+				: type(op::staged_copy), src(_src), dst(_dst), length(len), aux_param0(arena_len)
 			{}
 
 			transport_packet(void *_dst, rsx::primitive_type prim, u32 len)
@@ -43,12 +46,26 @@ namespace rsx
 			transport_packet(u32 command, void* args)
 				: type(op::callback), src(args), aux_param0(command)
 			{}
+
+			transport_packet(std::vector<transport_packet>&& packets)
+				: type(op::packet_batch), batch(std::move(packets)), src(nullptr), dst(nullptr), length(0)
+			{}
 		};
 
 		atomic_t<bool> m_mem_fault_flag = false;
 
-		// TODO: Improved benchmarks here; value determined by profiling on a Ryzen CPU, rounded to the nearest 512 bytes
-		const u32 max_immediate_transfer_size = 3584;
+		// Copies up to this size are cheaper to do on the calling thread than to enqueue. Calibrated by init(), rounded to 512 bytes
+		u32 max_immediate_transfer_size = 3584;
+
+		// Same for copies appended to an open batch, which do not pay for the queue push
+		u32 max_immediate_batched_size = 512;
+
+		// Packets recorded between begin_batch() and end_batch(), only used by the RSX thread
+		std::vector<transport_packet> m_batch;
+		bool m_batch_open = false;
+
+		void submit(transport_packet&& packet);
+		void calibrate();
 
 	public:
 		dma_manager() = default;
@@ -57,9 +74,13 @@ namespace rsx
 		void init();
 
 		// General tranport
-		void copy(void *dst, std::vector<u8>& src, u32 length);
+		void copy(void *dst, const std::vector<u8>& src, u32 length);
 		void copy(void *dst, void *src, u32 length);
 
+		// Batched submission; packets recorded in between are sent to the offloader as a single queue entry
+		void begin_batch();
+		void end_batch();
+
 		// Vertex utilities
 		void emulate_as_indexed(void *dst, rsx::primitive_type primitive, u32 count);
 
@@ -76,6 +97,9 @@ namespace rsx
 		// Fault recovery
 		utils::address_range get_fault_range(bool writing) const;
 
+		// Statistics since the last call: highest number of packets in flight and average queue latency in microseconds
+		void get_queue_stats(u32& max_depth, u64& average_latency);
+
 		struct offload_thread;
 	};
 }
@@ -7,6 +7,7 @@
 #include "Common/GLSLCommon.h"
 #include "Common/texture_cache.h"
 #include "Common/surface_store.h"
+#include "Common/write_tracking.h"
 #include "Capture/rsx_capture.h"
 #include "rsx_methods.h"
 #include "rsx_utils.h"
@@ -357,6 +358,7 @@ namespace rsx
 	thread::~thread()
 	{
 		g_access_violation_handler = nullptr;
+		write_tracking::shutdown();
 	}
 
 	thread::thread()
@@ -364,9 +366,27 @@ namespace rsx
 	{
 		g_access_violation_handler = [this](u32 address, bool is_writing)
 		{
-			return on_access_violation(address, is_writing);
+			const u64 start = get_system_time();
+
+			if (!on_access_violation(address, is_writing))
+			{
+				return false;
+			}
+
+			if (is_writing)
+			{
+				m_write_faults++;
+				m_write_fault_time += get_system_time() - start;
+			}
+
+			return true;
 		};
 
+		if (g_cfg.video.async_write_tracking)
+		{
+			write_tracking::init();
+		}
+
 		m_rtts_dirty = true;
 		m_textures_dirty.fill(true);
 		m_vertex_textures_dirty.fill(true);
@@ -394,6 +414,9 @@ namespace rsx
 
 	void thread::begin()
 	{
+		// Written pages are collected before every draw, CPU writes to textures which stay bound must be seen by the next draw
+		handle_tracked_writes();
+
 		if (cond_render_ctrl.hw_cond_active)
 		{
 			if (!cond_render_ctrl.eval_pending())
@@ -1562,8 +1585,9 @@ namespace rsx
 		m_graphics_state &= ~rsx::pipeline_state::fragment_program_ucode_dirty;
 
 		const auto [program_offset, program_location] = method_registers.shader_program_address();
-		auto data_ptr = vm::base(rsx::get_address(program_offset, program_location));
-		current_fp_metadata = program_hash_util::fragment_program_utils::analyse_fragment_program(data_ptr);
+		const u32 program_address = rsx::get_address(program_offset, program_location);
+		auto data_ptr = vm::base(program_address);
+		current_fp_metadata = m_fp_analysis_cache.analyse(program_address, data_ptr);
 
 		current_fragment_program.data = (static_cast<u8*>(data_ptr) + current_fp_metadata.program_start_offset);
 		current_fragment_program.offset = program_offset + current_fp_metadata.program_start_offset;
@@ -1626,6 +1650,12 @@ namespace rsx
 
 	void thread::analyse_current_rsx_pipeline()
 	{
+		if (!(m_graphics_state & rsx::pipeline_state::invalidate_pipeline_bits))
+		{
+			// No program or program state changed since the previous draw
+			m_frame_stats.pipeline_reuses++;
+		}
+
 		if (m_graphics_state & rsx::pipeline_state::fragment_program_ucode_dirty)
 		{
 			// Request for update of fragment constants if the program block is invalidated
@@ -2360,6 +2390,9 @@ namespace rsx
 
 		if (persistent != nullptr)
 		{
+			const auto dma = g_fxo->get<rsx::dma_manager>();
+			dma->begin_batch();
+
 			for (const auto &block : layout.interleaved_blocks)
 			{
 				auto range = block.calculate_required_range(first_vertex, vertex_count);
@@ -2367,9 +2400,11 @@ namespace rsx
 				const u32 data_size = range.second * block.attribute_stride;
 				const u32 vertex_base = range.first * block.attribute_stride;
 
-				g_fxo->get<rsx::dma_manager>()->copy(persistent, vm::_ptr<char>(block.real_offset_address) + vertex_base, data_size);
+				dma->copy(persistent, vm::_ptr<char>(block.real_offset_address) + vertex_base, data_size);
 				persistent += data_size;
 			}
+
+			dma->end_batch();
 		}
 	}
 
@@ -2730,6 +2765,12 @@ namespace rsx
 	{
 		if (!m_rsx_thread_exiting && address < rsx::constants::local_mem_base)
 		{
+			// Unmapped memory (e.g. of unloaded modules) may have contained command subroutines
+			if (fifo_ctrl)
+			{
+				fifo_ctrl->invalidate_subroutines();
+			}
+
 			if (!isHLE)
 			{
 				// Each bit represents io entry to be unmapped
@@ -2809,9 +2850,29 @@ namespace rsx
 			return;
 
 		on_invalidate_memory_range(m_invalidated_memory_range, rsx::invalidation_cause::unmap);
+		m_fp_analysis_cache.invalidate(m_invalidated_memory_range);
 		m_invalidated_memory_range.invalidate();
 	}
 
+	void thread::handle_tracked_writes()
+	{
+		if (!write_tracking::is_active())
+			return;
+
+		const u64 start = get_system_time();
+
+		m_tracked_writes.clear();
+		m_frame_stats.tracked_dirty_pages += write_tracking::collect(m_tracked_writes);
+
+		// Ranges are coalesced, each one is invalidated at once
+		for (const auto& range : m_tracked_writes)
+		{
+			on_tracked_write(range);
+		}
+
+		m_frame_stats.write_tracking_time += get_system_time() - start;
+	}
+
 	//Pause/cont wrappers for FIFO ctrl. Never call this from rsx thread itself!
 	void thread::pause()
 	{
@@ -2925,6 +2986,9 @@ namespace rsx
 		}
 
 		// Save current state
+		m_frame_stats.write_faults = m_write_faults.exchange(0);
+		m_frame_stats.write_fault_time = m_write_fault_time.exchange(0);
+		g_fxo->get<rsx::dma_manager>()->get_queue_stats(m_frame_stats.dma_queue_depth, m_frame_stats.dma_queue_latency);
 		m_queued_flip.stats = m_frame_stats;
 		m_queued_flip.push(buffer);
 		m_queued_flip.skip_frame = skip_current_frame;
@@ -3053,6 +3117,9 @@ namespace rsx
 		m_queued_flip.emu_flip = true;
 		m_queued_flip.in_progress = true;
 
+		// The display buffer may be read from guest memory
+		handle_tracked_writes();
+
 		flip(m_queued_flip);
 
 		last_flip_time = get_system_time() - 1000000;
@@ -534,11 +534,20 @@ namespace rsx
 	struct frame_statistics_t
 	{
 		u32 draw_calls;
+		u32 pipeline_reuses;
 		s64 setup_time;
 		s64 vertex_upload_time;
+		u64 vertex_upload_bytes;
+		u64 vertex_reused_bytes;
 		s64 textures_upload_time;
 		s64 draw_exec_time;
 		s64 flip_time;
+		u32 write_faults;
+		s64 write_fault_time;
+		u32 tracked_dirty_pages;
+		s64 write_tracking_time;
+		u32 dma_queue_depth;
+		u64 dma_queue_latency;
 	};
 
 	struct display_flip_info_t
@@ -643,6 +652,13 @@ namespace rsx
 		rsx::profiling_timer m_profiler;
 		frame_statistics_t m_frame_stats;
 
+		// Access violations handled on behalf of other threads
+		atomic_t<u32> m_write_faults{0};
+		atomic_t<u64> m_write_fault_time{0};
+
+		// Dirty pages reported by the asynchronous write tracker
+		std::vector<address_range> m_tracked_writes;
+
 	public:
 		RsxDmaControl* ctrl = nullptr;
 		u32 dma_address{0};
@@ -719,6 +735,7 @@ namespace rsx
 
 		program_hash_util::fragment_program_utils::fragment_program_metadata current_fp_metadata = {};
 		program_hash_util::vertex_program_utils::vertex_program_metadata current_vp_metadata = {};
+		program_hash_util::fragment_program_analysis_cache m_fp_analysis_cache;
 
 	protected:
 		std::array<u32, 4> get_color_surface_addresses() const;
@@ -803,6 +820,8 @@ namespace rsx
 		virtual void emit_geometry(u32) {}
 
 		void run_FIFO();
+		void run_FIFO_subroutine(const FIFO::decoded_subroutine& sub);
+		void set_FIFO_running();
 
 	public:
 		virtual void clear_surface(u32 /*arg*/) {};
@@ -816,6 +835,8 @@ namespace rsx
 		virtual u64 timestamp();
 		virtual bool on_access_violation(u32 /*address*/, bool /*is_writing*/) { return false; }
 		virtual void on_invalidate_memory_range(const address_range & /*range*/, rsx::invalidation_cause) {}
+		// Invalidates cached data of the range written behind write-tracked pages (asynchronous write tracking)
+		virtual void on_tracked_write(const address_range & /*range*/) {}
 		virtual void notify_tile_unbound(u32 /*tile*/) {}
 
 		// control
@@ -879,6 +900,10 @@ namespace rsx
 		void handle_emu_flip(u32 buffer);
 		void handle_invalidated_memory_range();
 
+	public:
+		// Invalidates cached data for the pages written since the last sync point when asynchronous write tracking is active
+		void handle_tracked_writes();
+
 	public:
 		//std::future<void> add_internal_task(std::function<bool()> callback);
 		//void invoke(std::function<bool()> callback);
@@ -496,6 +496,8 @@ VKGSRender::VKGSRender() : GSRender()
 
 	if (g_cfg.video.disable_vertex_cache || g_cfg.video.multithreaded_rsx)
 		m_vertex_cache = std::make_unique<vk::null_vertex_cache>();
+	else if (rsx::write_tracking::is_active())
+		m_vertex_cache = std::make_unique<vk::persistent_vertex_cache>();
 	else
 		m_vertex_cache = std::make_unique<vk::weak_vertex_cache>();
 
@@ -750,7 +752,36 @@ void VKGSRender::on_invalidate_memory_range(const utils::address_range &range, r
 		}
 
 		vk::unmap_dma(range.start, range.length());
+
+		// Remapped memory is no longer write-tracked
+		m_vertex_cache->invalidate_range(range);
+	}
+}
+
+void VKGSRender::on_tracked_write(const utils::address_range &range)
+{
+	vk::texture_cache::thrashed_set result;
+	{
+		std::lock_guard lock(m_secondary_cb_guard);
+		result = std::move(m_texture_cache.invalidate_range(m_secondary_command_buffer, range, rsx::invalidation_cause::deferred_write));
+	}
+
+	if (result.violation_handled)
+	{
+		{
+			std::lock_guard lock(m_sampler_mutex);
+			m_samplers_dirty.store(true);
+		}
+
+		if (result.num_flushable > 0)
+		{
+			// Flushable sections are page-protected and normally fault before the write, sync pending changes first
+			flush_command_queue();
+			m_texture_cache.flush_all(m_secondary_command_buffer, result);
+		}
 	}
+
+	m_vertex_cache->invalidate_range(range);
 }
 
 void VKGSRender::on_semaphore_acquire_wait()
@@ -25,6 +25,7 @@ namespace vk
 {
 	using vertex_cache = rsx::vertex_cache::default_vertex_cache<rsx::vertex_cache::uploaded_range<VkFormat>, VkFormat>;
 	using weak_vertex_cache = rsx::vertex_cache::weak_vertex_cache<VkFormat>;
+	using persistent_vertex_cache = rsx::vertex_cache::persistent_vertex_cache<VkFormat>;
 	using null_vertex_cache = vertex_cache;
 
 	using shader_cache = rsx::shaders_cache<vk::pipeline_props, vk::program_cache>;
@@ -218,6 +219,10 @@ namespace vk
 		s64 texture_upload_heap_ptr = 0;
 		s64 rasterizer_env_heap_ptr = 0;
 
+		// Oldest attribute data from previous frames reused by this frame, it must not be released before this frame is done
+		s64 attrib_reuse_ptr = -1;
+		u64 attrib_reuse_lap = 0;
+
 		u64 last_frame_sync_time = 0;
 
 		//Copy shareable information
@@ -240,6 +245,9 @@ namespace vk
 			index_heap_ptr = other.index_heap_ptr;
 			texture_upload_heap_ptr = other.texture_upload_heap_ptr;
 			rasterizer_env_heap_ptr = other.rasterizer_env_heap_ptr;
+
+			attrib_reuse_ptr = other.attrib_reuse_ptr;
+			attrib_reuse_lap = other.attrib_reuse_lap;
 		}
 
 		//Exchange storage (non-copyable)
@@ -270,6 +278,7 @@ namespace vk
 		void reset_heap_ptrs()
 		{
 			last_frame_sync_time = 0;
+			attrib_reuse_ptr = -1;
 		}
 	};
 
@@ -582,5 +591,6 @@ protected:
 
 	bool on_access_violation(u32 address, bool is_writing) override;
 	void on_invalidate_memory_range(const utils::address_range &range, rsx::invalidation_cause cause) override;
+	void on_tracked_write(const utils::address_range &range) override;
 	void on_semaphore_acquire_wait() override;
 };
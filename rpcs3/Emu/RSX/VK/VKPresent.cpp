@@ -119,7 +119,7 @@ void VKGSRender::advance_queued_frames()
 
 	vk::remove_unused_framebuffers();
 
-	m_vertex_cache->purge();
+	m_vertex_cache->on_frame_end();
 	m_current_frame->tag_frame_end(m_attrib_ring_info.get_current_put_pos_minus_one(),
 		m_vertex_env_ring_info.get_current_put_pos_minus_one(),
 		m_fragment_env_ring_info.get_current_put_pos_minus_one(),
@@ -234,7 +234,26 @@ void VKGSRender::frame_context_cleanup(vk::frame_context_t *ctx, bool free_resou
 			m_last_heap_sync_time = ctx->last_frame_sync_time;
 
 			// Heap cleanup; deallocates memory consumed by the frame if it is still held
-			m_attrib_ring_info.m_get_pos = ctx->attrib_heap_ptr;
+			// Attribute data reused by frames still in flight has to stay allocated
+			usz attrib_get_pos = ctx->attrib_heap_ptr;
+			const auto keep_reused_attribs = [&](const vk::frame_context_t* frame)
+			{
+				if (frame != ctx && frame->attrib_reuse_ptr >= 0 &&
+					m_attrib_ring_info.is_intact(frame->attrib_reuse_ptr, frame->attrib_reuse_lap) &&
+					m_attrib_ring_info.get_distance(frame->attrib_reuse_ptr) > m_attrib_ring_info.get_distance(attrib_get_pos))
+				{
+					attrib_get_pos = frame->attrib_reuse_ptr;
+				}
+			};
+
+			for (const auto frame : m_queued_frames)
+			{
+				keep_reused_attribs(frame);
+			}
+
+			keep_reused_attribs(m_current_frame);
+
+			m_attrib_ring_info.m_get_pos = attrib_get_pos;
 			m_vertex_env_ring_info.m_get_pos = ctx->vtx_env_heap_ptr;
 			m_fragment_env_ring_info.m_get_pos = ctx->frag_env_heap_ptr;
 			m_fragment_constants_ring_info.m_get_pos = ctx->frag_const_heap_ptr;
@@ -257,6 +276,7 @@ void VKGSRender::frame_context_cleanup(vk::frame_context_t *ctx, bool free_resou
 	}
 
 	ctx->swap_command_buffer = nullptr;
+	ctx->attrib_reuse_ptr = -1;
 
 	// Remove from queued list
 	while (!m_queued_frames.empty())
@@ -741,9 +761,9 @@ void VKGSRender::flip(const rsx::display_flip_info_t& info)
 			}
 
 			m_text_writer->print_text(*m_current_command_buffer, *direct_fbo, 0,   0, direct_fbo->width(), direct_fbo->height(), fmt::format("RSX Load:                 %3d%%", get_load()));
-			m_text_writer->print_text(*m_current_command_buffer, *direct_fbo, 0,  18, direct_fbo->width(), direct_fbo->height(), fmt::format("draw calls: %17d", info.stats.draw_calls));
+			m_text_writer->print_text(*m_current_command_buffer, *direct_fbo, 0,  18, direct_fbo->width(), direct_fbo->height(), fmt::format("draw calls: %17d (%u pipeline reuses)", info.stats.draw_calls, info.stats.pipeline_reuses));
 			m_text_writer->print_text(*m_current_command_buffer, *direct_fbo, 0,  36, direct_fbo->width(), direct_fbo->height(), fmt::format("draw call setup: %12dus", info.stats.setup_time));
-			m_text_writer->print_text(*m_current_command_buffer, *direct_fbo, 0,  54, direct_fbo->width(), direct_fbo->height(), fmt::format("vertex upload time: %9dus", info.stats.vertex_upload_time));
+			m_text_writer->print_text(*m_current_command_buffer, *direct_fbo, 0,  54, direct_fbo->width(), direct_fbo->height(), fmt::format("vertex upload time: %9dus (%u KiB uploaded, %u KiB reused)", info.stats.vertex_upload_time, info.stats.vertex_upload_bytes / 1024, info.stats.vertex_reused_bytes / 1024));
 			m_text_writer->print_text(*m_current_command_buffer, *direct_fbo, 0,  72, direct_fbo->width(), direct_fbo->height(), fmt::format("texture upload time: %8dus", info.stats.textures_upload_time));
 			m_text_writer->print_text(*m_current_command_buffer, *direct_fbo, 0,  90, direct_fbo->width(), direct_fbo->height(), fmt::format("draw call execution: %8dus", info.stats.draw_exec_time));
 			m_text_writer->print_text(*m_current_command_buffer, *direct_fbo, 0, 108, direct_fbo->width(), direct_fbo->height(), fmt::format("submit and flip: %12dus", info.stats.flip_time));
@@ -754,6 +774,7 @@ void VKGSRender::flip(const rsx::display_flip_info_t& info)
 			const auto num_flushes = m_texture_cache.get_num_flush_requests();
 			const auto num_mispredict = m_texture_cache.get_num_cache_mispredictions();
 			const auto num_speculate = m_texture_cache.get_num_cache_speculative_writes();
+			const auto num_speculate_hits = m_texture_cache.get_num_cache_speculative_hits();
 			const auto num_misses = m_texture_cache.get_num_cache_misses();
 			const auto num_unavoidable = m_texture_cache.get_num_unavoidable_hard_faults();
 			const auto cache_miss_ratio = static_cast<u32>(ceil(m_texture_cache.get_cache_miss_ratio() * 100));
@@ -763,8 +784,10 @@ void VKGSRender::flip(const rsx::display_flip_info_t& info)
 			m_text_writer->print_text(*m_current_command_buffer, *direct_fbo, 0, 144, direct_fbo->width(), direct_fbo->height(), fmt::format("Unreleased textures: %8d", num_dirty_textures));
 			m_text_writer->print_text(*m_current_command_buffer, *direct_fbo, 0, 162, direct_fbo->width(), direct_fbo->height(), fmt::format("Texture cache memory: %7dM", texture_memory_size));
 			m_text_writer->print_text(*m_current_command_buffer, *direct_fbo, 0, 180, direct_fbo->width(), direct_fbo->height(), fmt::format("Temporary texture memory: %3dM", tmp_texture_memory_size));
-			m_text_writer->print_text(*m_current_command_buffer, *direct_fbo, 0, 198, direct_fbo->width(), direct_fbo->height(), fmt::format("Flush requests: %13d  = %2d (%3d%%) hard faults, %2d unavoidable, %2d misprediction(s), %2d speculation(s)", num_flushes, num_misses, cache_miss_ratio, num_unavoidable, num_mispredict, num_speculate));
+			m_text_writer->print_text(*m_current_command_buffer, *direct_fbo, 0, 198, direct_fbo->width(), direct_fbo->height(), fmt::format("Flush requests: %13d  = %2d (%3d%%) hard faults, %2d unavoidable, %2d misprediction(s), %2d speculation(s) (%2d hit)", num_flushes, num_misses, cache_miss_ratio, num_unavoidable, num_mispredict, num_speculate, num_speculate_hits));
 			m_text_writer->print_text(*m_current_command_buffer, *direct_fbo, 0, 216, direct_fbo->width(), direct_fbo->height(), fmt::format("Texture uploads: %14u (%u from CPU - %02u%%)", num_texture_upload, num_texture_upload_miss, texture_upload_miss_ratio));
+			m_text_writer->print_text(*m_current_command_buffer, *direct_fbo, 0, 234, direct_fbo->width(), direct_fbo->height(), fmt::format("Write faults: %17u (%dus), %u tracked page(s) (%dus)", info.stats.write_faults, info.stats.write_fault_time, info.stats.tracked_dirty_pages, info.stats.write_tracking_time));
+			m_text_writer->print_text(*m_current_command_buffer, *direct_fbo, 0, 252, direct_fbo->width(), direct_fbo->height(), fmt::format("DMA queue depth: %14u (%uus average latency)", info.stats.dma_queue_depth, info.stats.dma_queue_latency));
 		}
 
 		direct_fbo->release();
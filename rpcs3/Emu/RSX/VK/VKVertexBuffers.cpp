@@ -240,12 +240,14 @@ vk::vertex_upload_info VKGSRender::upload_vertex_data()
 	auto required = calculate_memory_requirements(m_vertex_layout, vertex_base, vertex_count);
 	u32 persistent_range_base = UINT32_MAX, volatile_range_base = UINT32_MAX;
 	usz persistent_offset = UINT64_MAX, volatile_offset = UINT64_MAX;
+	bool reused_cached_data = false;
+	u32  cached_storage_address = UINT32_MAX;
+	u64  cached_lap = 0;
 
 	if (required.first > 0)
 	{
 		//Check if cacheable
 		//Only data in the 'persistent' block may be cached
-		//TODO: make vertex cache keep local data beyond frame boundaries and hook notify command
 		bool in_cache = false;
 		bool to_store = false;
 		u32  storage_address = UINT32_MAX;
@@ -256,12 +258,29 @@ vk::vertex_upload_info VKGSRender::upload_vertex_data()
 			const auto data_offset = (vertex_base * m_vertex_layout.interleaved_blocks[0].attribute_stride);
 			storage_address = m_vertex_layout.interleaved_blocks[0].real_offset_address + data_offset;
 
-			if (auto cached = m_vertex_cache->find_vertex_range(storage_address, VK_FORMAT_R8_UINT, required.first))
+			// Entries can outlive the heap contents, only reuse data which has not been overwritten yet.
+			// Data far behind the put position is uploaded again rather than holding most of the heap back.
+			if (auto cached = m_vertex_cache->find_vertex_range(storage_address, VK_FORMAT_R8_UINT, required.first);
+				cached && m_attrib_ring_info.is_intact(cached->offset_in_heap, cached->tag) &&
+				m_attrib_ring_info.get_distance(cached->offset_in_heap) < m_attrib_ring_info.size() / 2)
 			{
 				ensure(cached->local_address == storage_address);
 
 				in_cache = true;
 				persistent_range_base = cached->offset_in_heap;
+				cached_lap = cached->tag;
+
+				// Data uploaded by an earlier frame may already have been released
+				m_attrib_ring_info.reserve_from(persistent_range_base);
+
+				auto& frame = *m_current_frame;
+				if (frame.attrib_reuse_ptr < 0 ||
+					!m_attrib_ring_info.is_intact(frame.attrib_reuse_ptr, frame.attrib_reuse_lap) ||
+					m_attrib_ring_info.get_distance(persistent_range_base) > m_attrib_ring_info.get_distance(frame.attrib_reuse_ptr))
+				{
+					frame.attrib_reuse_ptr = persistent_range_base;
+					frame.attrib_reuse_lap = cached_lap;
+				}
 			}
 			else
 			{
@@ -277,9 +296,12 @@ vk::vertex_upload_info VKGSRender::upload_vertex_data()
 			if (to_store)
 			{
 				//store ref in vertex cache
-				m_vertex_cache->store_range(storage_address, VK_FORMAT_R8_UINT, required.first, static_cast<u32>(persistent_offset));
+				m_vertex_cache->store_range(storage_address, VK_FORMAT_R8_UINT, required.first, static_cast<u32>(persistent_offset), m_attrib_ring_info.get_lap());
 			}
 		}
+
+		reused_cached_data = in_cache;
+		cached_storage_address = storage_address;
 	}
 
 	if (required.second > 0)
@@ -288,6 +310,19 @@ vk::vertex_upload_info VKGSRender::upload_vertex_data()
 		volatile_range_base = static_cast<u32>(volatile_offset);
 	}
 
+	if (reused_cached_data && !m_attrib_ring_info.is_intact(persistent_range_base, cached_lap))
+	{
+		// The heap was reallocated to fit the volatile data, upload the persistent block again
+		persistent_offset = static_cast<u32>(m_attrib_ring_info.alloc<256>(required.first));
+		persistent_range_base = static_cast<u32>(persistent_offset);
+		reused_cached_data = false;
+
+		m_vertex_cache->store_range(cached_storage_address, VK_FORMAT_R8_UINT, required.first, static_cast<u32>(persistent_offset), m_attrib_ring_info.get_lap());
+	}
+
+	m_frame_stats.vertex_upload_bytes += (reused_cached_data ? 0 : required.first) + required.second;
+	m_frame_stats.vertex_reused_bytes += (reused_cached_data ? required.first : 0);
+
 	//Write all the data once if possible
 	if (required.first && required.second && volatile_offset > persistent_offset)
 	{
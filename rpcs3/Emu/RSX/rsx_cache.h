@@ -8,6 +8,7 @@
 #include "Common/ProgramStateCache.h"
 #include "Emu/System.h"
 #include "Common/texture_cache_checker.h"
+#include "Common/write_tracking.h"
 #include "Overlays/Shaders/shader_loading_dialog.h"
 
 #include "rsx_utils.h"
@@ -39,6 +40,21 @@ namespace rsx
 		ensure(range.is_page_range());
 
 		//rsx_log.error("memory_protect(0x%x, 0x%x, %x)", static_cast<u32>(range.start), static_cast<u32>(range.length()), static_cast<u32>(prot));
+		if (prot == utils::protection::ro && write_tracking::is_active())
+		{
+			// Writes are collected at sync points instead, the pages stay writable
+			utils::memory_protect(vm::base(range.start), range.length(), utils::protection::rw);
+
+			if (write_tracking::protect(range))
+			{
+#ifdef TEXTURE_CACHE_DEBUG
+				tex_cache_checker.set_protection(range, prot);
+#endif
+				return;
+			}
+		}
+
+		write_tracking::unprotect(range);
 		utils::memory_protect(vm::base(range.start), range.length(), prot);
 
 #ifdef TEXTURE_CACHE_DEBUG
@@ -809,7 +825,9 @@ namespace rsx
 		public:
 			virtual ~default_vertex_cache() = default;
 			virtual storage_type* find_vertex_range(uptr /*local_addr*/, upload_format, u32 /*data_length*/) { return nullptr; }
-			virtual void store_range(uptr /*local_addr*/, upload_format, u32 /*data_length*/, u32 /*offset_in_heap*/) {}
+			virtual void store_range(uptr /*local_addr*/, upload_format, u32 /*data_length*/, u32 /*offset_in_heap*/, u64 /*tag*/) {}
+			virtual void invalidate_range(const utils::address_range& /*range*/) {}
+			virtual void on_frame_end() { purge(); }
 			virtual void purge() {}
 		};
 
@@ -823,6 +841,7 @@ namespace rsx
 			upload_format buffer_format;
 			u32 offset_in_heap;
 			u32 data_length;
+			u64 tag; // Owned by the renderer, identifies the heap generation of offset_in_heap
 		};
 
 		template <typename upload_format>
@@ -849,20 +868,180 @@ namespace rsx
 				return nullptr;
 			}
 
-			void store_range(uptr local_addr, upload_format fmt, u32 data_length, u32 offset_in_heap) override
+			void store_range(uptr local_addr, upload_format fmt, u32 data_length, u32 offset_in_heap, u64 tag) override
+			{
+				storage_type v = {};
+				v.buffer_format = fmt;
+				v.data_length = data_length;
+				v.local_address = local_addr;
+				v.offset_in_heap = offset_in_heap;
+				v.tag = tag;
+
+				auto& ranges = vertex_ranges[local_addr];
+				std::erase_if(ranges, [&](const storage_type& e) { return e.buffer_format == fmt && e.data_length == data_length; });
+				ranges.push_back(v);
+			}
+
+			void purge() override
+			{
+				vertex_ranges.clear();
+			}
+		};
+
+		// A vertex cache which keeps uploaded ranges across frames
+		// Guest memory of the cached ranges is write-tracked and entries are dropped as soon as it is written to
+		// The renderer has to check whether the uploaded data is still present in its heap using the tag
+		template <typename upload_format>
+		class persistent_vertex_cache : public default_vertex_cache<uploaded_range<upload_format>, upload_format>
+		{
+			using storage_type = uploaded_range<upload_format>;
+
+		private:
+			std::unordered_map<uptr, std::vector<storage_type>> vertex_ranges;
+
+			// Ranges which were written to recently and are only cached for the current frame
+			std::vector<uptr> volatile_ranges;
+
+			// Frame of the last write to a cached range. Tracking data updated every frame is a waste of time
+			std::unordered_map<uptr, u64> recently_written;
+			u64 frame_index = 0;
+
+		public:
+			~persistent_vertex_cache()
+			{
+				purge();
+			}
+
+			storage_type* find_vertex_range(uptr local_addr, upload_format fmt, u32 data_length) override
+			{
+				const auto found = vertex_ranges.find(local_addr);
+
+				if (found == vertex_ranges.end())
+				{
+					return nullptr;
+				}
+
+				for (auto &v : found->second)
+				{
+					// NOTE: This has to match exactly. Using sized shortcuts such as >= comparison causes artifacting in some applications (UC1)
+					if (v.buffer_format == fmt && v.data_length == data_length)
+						return &v;
+				}
+
+				return nullptr;
+			}
+
+			void store_range(uptr local_addr, upload_format fmt, u32 data_length, u32 offset_in_heap, u64 tag) override
 			{
+				auto& ranges = vertex_ranges[local_addr];
+
+				// Replaces stale entries, e.g if the uploaded data has been overwritten in the heap
+				std::erase_if(ranges, [&](const storage_type& v) { return v.buffer_format == fmt && v.data_length == data_length; });
+
+				if (ranges.empty())
+				{
+					const auto range = utils::address_range::start_length(static_cast<u32>(local_addr), data_length).to_page_range();
+
+					if (recently_written.contains(local_addr) || !write_tracking::protect(range, write_tracking::owner_vertex_cache))
+					{
+						volatile_ranges.push_back(local_addr);
+					}
+				}
+
 				storage_type v = {};
 				v.buffer_format = fmt;
 				v.data_length = data_length;
 				v.local_address = local_addr;
 				v.offset_in_heap = offset_in_heap;
+				v.tag = tag;
+
+				ranges.push_back(v);
+			}
+
+			void invalidate_range(const utils::address_range& range) override
+			{
+				// Pages tracked for the erased entries
+				std::vector<utils::address_range> released;
+
+				for (auto it = vertex_ranges.begin(); it != vertex_ranges.end();)
+				{
+					const auto& ranges = it->second;
+					const u32 start = static_cast<u32>(it->first);
+
+					u32 length = 0;
+					bool overlaps = false;
+
+					for (const storage_type& v : ranges)
+					{
+						length = std::max(length, v.data_length);
+						overlaps = overlaps || range.overlaps(utils::address_range::start_length(start, v.data_length));
+					}
+
+					if (overlaps)
+					{
+						released.push_back(utils::address_range::start_length(start, length).to_page_range());
+						recently_written[it->first] = frame_index;
+						it = vertex_ranges.erase(it);
+					}
+					else
+					{
+						it++;
+					}
+				}
+
+				if (released.empty())
+				{
+					return;
+				}
+
+				for (const auto& r : released)
+				{
+					write_tracking::unprotect(r, write_tracking::owner_vertex_cache);
+				}
+
+				// Pages shared with the remaining entries must stay tracked
+				for (const auto& [addr, ranges] : vertex_ranges)
+				{
+					if (std::find(volatile_ranges.begin(), volatile_ranges.end(), addr) != volatile_ranges.end())
+					{
+						continue;
+					}
+
+					u32 length = 0;
+
+					for (const storage_type& v : ranges)
+					{
+						length = std::max(length, v.data_length);
+					}
+
+					const auto pages = utils::address_range::start_length(static_cast<u32>(addr), length).to_page_range();
+
+					if (std::any_of(released.begin(), released.end(), [&](const utils::address_range& r) { return r.overlaps(pages); }) &&
+						!write_tracking::protect(pages, write_tracking::owner_vertex_cache))
+					{
+						volatile_ranges.push_back(addr);
+					}
+				}
+			}
+
+			void on_frame_end() override
+			{
+				for (const uptr addr : volatile_ranges)
+				{
+					vertex_ranges.erase(addr);
+				}
+
+				volatile_ranges.clear();
 
-				vertex_ranges[local_addr].push_back(v);
+				std::erase_if(recently_written, [&](const auto& e) { return e.second + 1 < frame_index; });
+				frame_index++;
 			}
 
 			void purge() override
 			{
 				vertex_ranges.clear();
+				volatile_ranges.clear();
+				write_tracking::unprotect_all(write_tracking::owner_vertex_cache);
 			}
 		};
 	}
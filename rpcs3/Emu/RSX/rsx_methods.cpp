@@ -852,6 +852,12 @@ namespace rsx
 		{
 			static void impl(thread* rsx, u32 _reg, u32 arg)
 			{
+				if (arg == method_registers.register_previous_value)
+				{
+					// Redundant write, descriptor contents are still validated at draw time
+					return;
+				}
+
 				rsx->m_textures_dirty[index] = true;
 
 				if (rsx->current_fp_metadata.referenced_textures_mask & (1 << index))
@@ -866,6 +872,12 @@ namespace rsx
 		{
 			static void impl(thread* rsx, u32 _reg, u32 arg)
 			{
+				if (arg == method_registers.register_previous_value)
+				{
+					// Redundant write, descriptor contents are still validated at draw time
+					return;
+				}
+
 				rsx->m_vertex_textures_dirty[index] = true;
 
 				if (rsx->current_vp_metadata.referenced_textures_mask & (1 << index))
@@ -1238,6 +1250,9 @@ namespace rsx
 				dst_info.pixels = pixels_dst;
 				dst_info.swizzled = (method_registers.blit_engine_context_surface() == blit_engine::context_surface::swizzle2d);
 
+				// The source may have been written since the last draw
+				rsx->handle_tracked_writes();
+
 				if (rsx->scaled_image_from_memory(src_info, dst_info, in_inter == blit_engine::transfer_interpolator::foh))
 					return;
 			}
@@ -369,6 +369,57 @@ namespace rsx
 
 		u32 adv = pitch / sizeof(T);
 
+		if (!(width & 1) && !(height & 1)) [[likely]]
+		{
+			// For even x and y, texels (x, y), (x + 1, y), (x, y + 1) and (x + 1, y + 1) are consecutive in swizzled memory.
+			// Walk the surface in 2x2 blocks, two texels per row copy and a quarter of the address arithmetic.
+			for (int y = 0; y < height; y += 2)
+			{
+				offs_x = offs_x0;
+
+				if constexpr (!input_is_swizzled)
+				{
+					auto src0 = static_cast<const T*>(input_pixels) + y * adv;
+					auto src1 = src0 + adv;
+					auto dst = static_cast<T*>(output_pixels) + offs_y;
+
+					for (int x = 0; x < width; x += 2)
+					{
+						std::memcpy(dst + offs_x, src0 + x, sizeof(T) * 2);
+						std::memcpy(dst + offs_x + 2, src1 + x, sizeof(T) * 2);
+						offs_x = (offs_x - x_mask) & x_mask;
+						offs_x = (offs_x - x_mask) & x_mask;
+					}
+				}
+				else
+				{
+					auto src = static_cast<const T*>(input_pixels) + offs_y;
+					auto dst0 = static_cast<T*>(output_pixels) + y * adv;
+					auto dst1 = dst0 + adv;
+
+					for (int x = 0; x < width; x += 2)
+					{
+						std::memcpy(dst0 + x, src + offs_x, sizeof(T) * 2);
+						std::memcpy(dst1 + x, src + offs_x + 2, sizeof(T) * 2);
+						offs_x = (offs_x - x_mask) & x_mask;
+						offs_x = (offs_x - x_mask) & x_mask;
+					}
+				}
+
+				for (int row = 0; row < 2; ++row)
+				{
+					offs_y = (offs_y - y_mask) & y_mask;
+
+					if (offs_y == 0)
+					{
+						offs_x0 += y_incr;
+					}
+				}
+			}
+
+			return;
+		}
+
 		if constexpr (!input_is_swizzled)
 		{
 			for (int y = 0; y < height; ++y)
@@ -437,13 +488,24 @@ namespace rsx
 		const u32 log2_h = ceil_log2(height);
 		const u32 log2_d = ceil_log2(depth);
 
+		// The bits of each coordinate land at fixed positions of the index, so the axes can be interleaved separately
+		std::vector<u32> x_offsets(width);
+		for (u32 x = 0; x < width; ++x)
+		{
+			x_offsets[x] = calculate_z_index(x, 0, 0, log2_w, log2_h, log2_d);
+		}
+
 		for (u32 z = 0; z < depth; ++z)
 		{
+			const u32 z_offset = calculate_z_index(0, 0, z, log2_w, log2_h, log2_d);
+
 			for (u32 y = 0; y < height; ++y)
 			{
+				const T* src_row = src + (z_offset | calculate_z_index(0, y, 0, log2_w, log2_h, log2_d));
+
 				for (u32 x = 0; x < width; ++x)
 				{
-					*dst++ = src[calculate_z_index(x, y, z, log2_w, log2_h, log2_d)];
+					*dst++ = src_row[x_offsets[x]];
 				}
 			}
 		}
@@ -96,7 +96,7 @@ namespace
 
 namespace atomic_wait
 {
-	extern void parse_hashtable(bool(*cb)(u64 id, u32 refs, u64 ptr, u32 stats));
+	extern void parse_hashtable(bool(*cb)(u64 id, u32 refs, u64 ptr, u32 stats, u32 contention));
 }
 
 template<>
@@ -1047,6 +1047,12 @@ game_boot_result Emulator::Load(const std::string& title_id, bool add_only, bool
 			}
 		}
 
+		if (!add_only)
+		{
+			// Must happen before any code is generated for this boot
+			jit_runtime::set_huge_pages(g_cfg.core.jit_huge_pages);
+		}
+
 		if (g_use_rtm)
 		{
 			// Update supplementary settings
@@ -1887,13 +1893,17 @@ void Emulator::Stop(bool restart)
 	static u64 aw_colm = 0;
 	static u64 aw_colc = 0;
 	static u64 aw_used = 0;
+	static u64 aw_conm = 0;
+	static u64 aw_conc = 0;
 
 	aw_refs = 0;
 	aw_colm = 0;
 	aw_colc = 0;
 	aw_used = 0;
+	aw_conm = 0;
+	aw_conc = 0;
 
-	atomic_wait::parse_hashtable([](u64 id, u32 refs, u64 ptr, u32 maxc) -> bool
+	atomic_wait::parse_hashtable([](u64 id, u32 refs, u64 ptr, u32 maxc, u32 cont) -> bool
 	{
 		aw_refs += refs != 0;
 		aw_used += ptr != 0;
@@ -1901,10 +1911,13 @@ void Emulator::Stop(bool restart)
 		aw_colm = std::max<u64>(aw_colm, maxc);
 		aw_colc += maxc != 0;
 
+		aw_conm = std::max<u64>(aw_conm, cont);
+		aw_conc += cont;
+
 		return false;
 	});
 
-	sys_log.notice("Atomic wait hashtable stats: [in_use=%u, used=%u, max_collision_weight=%u, total_collisions=%u]", aw_refs, aw_used, aw_colm, aw_colc);
+	sys_log.notice("Atomic wait hashtable stats: [in_use=%u, used=%u, max_collision_weight=%u, total_collisions=%u, max_contention=%u, total_contention=%u]", aw_refs, aw_used, aw_colm, aw_colc, aw_conm, aw_conc);
 
 	if (restart)
 	{
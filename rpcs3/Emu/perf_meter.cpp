@@ -20,11 +20,11 @@ void perf_stat_base::push(u64 ns[66]) noexcept
 	}
 }
 
-void perf_stat_base::print(const char* name) noexcept
+void perf_stat_base::print(const char* name, f64 seconds) noexcept
 {
 	if (u64 num_total = m_log[0].load())
 	{
-		perf_log.notice(u8"Perf stats for %s: total events: %u (total time %.4fs, avg %.4fµs)", name, num_total, m_log[65].load() / 1000'000'000., m_log[65].load() / 1000. / num_total);
+		perf_log.notice(u8"Perf stats for %s: total events: %u (%.1f/s, total time %.4fs, avg %.4fµs)", name, num_total, num_total / seconds, m_log[65].load() / 1000'000'000., m_log[65].load() / 1000. / num_total);
 
 		for (u32 i = 0; i < 13; i++)
 		{
@@ -104,6 +104,9 @@ static std::map<std::string, perf_stat_base> s_perf_acc;
 
 static std::multimap<std::string, u64*> s_perf_sources;
 
+// Start of the period covered by the next report
+static u64 s_perf_start = get_tsc();
+
 void perf_stat_base::add(u64 ns[66], const char* name) noexcept
 {
 	// Don't attempt to register some foreign/unnamed threads
@@ -151,12 +154,16 @@ void perf_stat_base::report() noexcept
 		s_perf_acc[name].push(ns);
 	}
 
+	const u64 now = get_tsc();
+	const f64 seconds = std::max<f64>((now - s_perf_start) * 1. / utils::get_tsc_freq(), 1e-9);
+
 	for (auto& [name, data] : s_perf_acc)
 	{
-		data.print(name.c_str());
+		data.print(name.c_str(), seconds);
 	}
 
 	s_perf_acc.clear();
+	s_perf_start = now;
 
 	perf_log.notice("Performance report end.");
 }
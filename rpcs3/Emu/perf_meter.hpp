@@ -38,8 +38,8 @@ class perf_stat_base
 	atomic_t<u64> m_log[66]{};
 
 protected:
-	// Print accumulated values
-	void print(const char* name) noexcept;
+	// Print accumulated values (collected during the specified number of seconds)
+	void print(const char* name, f64 seconds) noexcept;
 
 	// Accumulate values from a thread
 	void push(u64 ns[66]) noexcept;
@@ -0,0 +1,244 @@
+#include "game_list_cache.h"
+
+#include "util/yaml.hpp"
+#include "util/logs.hpp"
+#include "Utilities/StrFmt.h"
+
+#include <QMutexLocker>
+
+LOG_CHANNEL(game_list_log, "GameList");
+
+// Bump this whenever the layout of the index changes
+static constexpr u32 s_index_version = 2;
+
+game_list_cache::game_list_cache()
+{
+	m_index_dir  = fs::get_cache_dir() + "game_list/";
+	m_index_path = m_index_dir + "index.yml";
+}
+
+bool game_list_cache::load()
+{
+	QMutexLocker lock(&m_mutex);
+
+	m_games.clear();
+	m_dirty = false;
+
+	const fs::file index(m_index_path);
+
+	if (!index)
+	{
+		return false;
+	}
+
+	auto [root, error] = yaml_load(index.to_string());
+
+	if (!error.empty())
+	{
+		game_list_log.error("Failed to load the game list index %s: %s", m_index_path, error);
+		return false;
+	}
+
+	if (get_yaml_node_value<u32>(root["version"], error) != s_index_version || !error.empty())
+	{
+		game_list_log.notice("Discarding outdated game list index %s", m_index_path);
+
+		// Icon thumbnails of version 1
+		fs::remove_all(m_index_dir + "icons/");
+		return false;
+	}
+
+	const auto read_stamp = [&error](const YAML::Node& node, file_stamp& stamp)
+	{
+		if (!node.IsSequence() || node.size() != 2)
+		{
+			return false;
+		}
+
+		stamp.size  = get_yaml_node_value<u64>(node[0], error);
+		stamp.mtime = get_yaml_node_value<s64>(node[1], error);
+		return error.empty();
+	};
+
+	for (const auto& game : root["games"])
+	{
+		const YAML::Node& node = game.second;
+
+		game_entry entry;
+
+		if (!node.IsMap() || !read_stamp(node["sfo"], entry.sfo))
+		{
+			game_list_log.warning("Skipping invalid game list index entry: %s", game.first.Scalar());
+			error.clear();
+			continue;
+		}
+
+		GameInfo& info    = entry.info;
+		info.path         = game.first.Scalar();
+		info.serial       = node["serial"].Scalar();
+		info.name         = node["name"].Scalar();
+		info.app_ver      = node["app_ver"].Scalar();
+		info.version      = node["version"].Scalar();
+		info.category     = node["category"].Scalar();
+		info.fw           = node["fw"].Scalar();
+		info.parental_lvl = get_yaml_node_value<u32>(node["parental_lvl"], error);
+		info.resolution   = get_yaml_node_value<u32>(node["resolution"], error);
+		info.sound_format = get_yaml_node_value<u32>(node["sound_format"], error);
+		info.bootable     = get_yaml_node_value<u32>(node["bootable"], error);
+		info.attr         = get_yaml_node_value<u32>(node["attr"], error);
+
+		if (!error.empty())
+		{
+			game_list_log.warning("Skipping invalid game list index entry: %s (%s)", info.path, error);
+			error.clear();
+			continue;
+		}
+
+		m_games.emplace(info.path, std::move(entry));
+	}
+
+	game_list_log.notice("Loaded game list index with %d games", m_games.size());
+	return true;
+}
+
+void game_list_cache::save()
+{
+	QMutexLocker lock(&m_mutex);
+
+	if (!m_dirty)
+	{
+		return;
+	}
+
+	if (!fs::create_path(m_index_dir))
+	{
+		game_list_log.error("Failed to create path: %s (%s)", m_index_dir, fs::g_tls_error);
+		return;
+	}
+
+	YAML::Emitter out;
+
+	out << YAML::BeginMap;
+	out << YAML::Key << "version" << YAML::Value << s_index_version;
+	out << YAML::Key << "games" << YAML::Value << YAML::BeginMap;
+
+	for (const auto& [path, entry] : m_games)
+	{
+		const GameInfo& info = entry.info;
+
+		out << YAML::Key << path << YAML::Value << YAML::BeginMap;
+		out << YAML::Key << "sfo" << YAML::Value << YAML::Flow << YAML::BeginSeq << entry.sfo.size << entry.sfo.mtime << YAML::EndSeq;
+		out << YAML::Key << "serial" << YAML::Value << info.serial;
+		out << YAML::Key << "name" << YAML::Value << info.name;
+		out << YAML::Key << "app_ver" << YAML::Value << info.app_ver;
+		out << YAML::Key << "version" << YAML::Value << info.version;
+		out << YAML::Key << "category" << YAML::Value << info.category;
+		out << YAML::Key << "fw" << YAML::Value << info.fw;
+		out << YAML::Key << "parental_lvl" << YAML::Value << info.parental_lvl;
+		out << YAML::Key << "resolution" << YAML::Value << info.resolution;
+		out << YAML::Key << "sound_format" << YAML::Value << info.sound_format;
+		out << YAML::Key << "bootable" << YAML::Value << info.bootable;
+		out << YAML::Key << "attr" << YAML::Value << info.attr;
+		out << YAML::EndMap;
+	}
+
+	out << YAML::EndMap;
+	out << YAML::EndMap;
+
+	// Write to a temporary file first so that a crash can't leave a truncated index behind
+	const std::string tmp_path = m_index_path + ".tmp";
+
+	if (fs::file index{tmp_path, fs::rewrite}; !index || index.write(out.c_str(), out.size()) != out.size())
+	{
+		game_list_log.error("Failed to write the game list index %s (%s)", tmp_path, fs::g_tls_error);
+		return;
+	}
+
+	if (!fs::rename(tmp_path, m_index_path, true))
+	{
+		game_list_log.error("Failed to save the game list index %s (%s)", m_index_path, fs::g_tls_error);
+		return;
+	}
+
+	m_dirty = false;
+}
+
+void game_list_cache::begin_scan()
+{
+	QMutexLocker lock(&m_mutex);
+	m_touched.clear();
+}
+
+void game_list_cache::end_scan()
+{
+	QMutexLocker lock(&m_mutex);
+
+	for (auto it = m_games.begin(); it != m_games.end();)
+	{
+		if (!m_touched.count(it->first))
+		{
+			it = m_games.erase(it);
+			m_dirty = true;
+		}
+		else
+		{
+			++it;
+		}
+	}
+
+	m_touched.clear();
+}
+
+bool game_list_cache::get_info(const std::string& path, const fs::stat_t& sfo_stat, GameInfo& info)
+{
+	QMutexLocker lock(&m_mutex);
+
+	m_touched.insert(path);
+
+	const auto found = m_games.find(path);
+
+	if (found == m_games.end() || !(found->second.sfo == file_stamp{sfo_stat.size, sfo_stat.mtime}))
+	{
+		return false;
+	}
+
+	info = found->second.info;
+	return true;
+}
+
+void game_list_cache::set_info(const std::string& path, const fs::stat_t& sfo_stat, const GameInfo& info)
+{
+	QMutexLocker lock(&m_mutex);
+
+	m_touched.insert(path);
+
+	game_entry& entry = m_games[path];
+	entry.sfo  = file_stamp{sfo_stat.size, sfo_stat.mtime};
+	entry.info = info;
+	entry.info.path = path;
+	m_dirty = true;
+}
+
+void game_list_cache::invalidate(const std::string& path)
+{
+	const auto is_below = [&path](const std::string& entry)
+	{
+		return entry.starts_with(path) && (entry.size() == path.size() || path.ends_with('/') || entry[path.size()] == '/');
+	};
+
+	QMutexLocker lock(&m_mutex);
+
+	for (auto it = m_games.begin(); it != m_games.end();)
+	{
+		if (is_below(it->first))
+		{
+			game_list_log.trace("Invalidated game list index entry: %s", it->first);
+			it = m_games.erase(it);
+			m_dirty = true;
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Emu/GameInfo.h"
+#include "Utilities/File.h"
+
+#include <QMutex>
+
+#include <unordered_map>
+#include <unordered_set>
+
+// On-disk index of the game list. Entries are keyed by the game path and revalidated by the size and mtime of PARAM.SFO.
+// Only the raw PARAM.SFO values are stored, localized fallbacks for missing values are applied by the caller.
+class game_list_cache
+{
+public:
+	game_list_cache();
+
+	/** Loads the index from disk. Returns false if no usable index was found */
+	bool load();
+
+	/** Writes the index to disk if anything changed since the last save */
+	void save();
+
+	/** Marks the start of a full scan. Entries that were not touched until end_scan() are dropped */
+	void begin_scan();
+	void end_scan();
+
+	/** Returns true and fills info if the cached PARAM.SFO data for path is still valid */
+	bool get_info(const std::string& path, const fs::stat_t& sfo_stat, GameInfo& info);
+
+	/** Stores freshly parsed PARAM.SFO data for path */
+	void set_info(const std::string& path, const fs::stat_t& sfo_stat, const GameInfo& info);
+
+	/** Drops every entry below path (used by the file watcher) */
+	void invalidate(const std::string& path);
+
+private:
+	struct file_stamp
+	{
+		u64 size = 0;
+		s64 mtime = 0;
+
+		bool operator==(const file_stamp& other) const { return size == other.size && mtime == other.mtime; }
+	};
+
+	struct game_entry
+	{
+		file_stamp sfo;
+		GameInfo info;
+	};
+
+	QMutex m_mutex;
+	std::unordered_map<std::string, game_entry> m_games;
+	std::unordered_set<std::string> m_touched;
+	std::string m_index_dir;
+	std::string m_index_path;
+	bool m_dirty = false;
+};
@@ -12,6 +12,7 @@
 #include "gui_settings.h"
 #include "game_list.h"
 #include "game_list_grid.h"
+#include "game_list_cache.h"
 #include "patch_manager_dialog.h"
 
 #include "Emu/Memory/vm.h"
@@ -146,6 +147,20 @@ game_list_frame::game_list_frame(std::shared_ptr<gui_settings> gui_settings, std
 	connect(m_game_grid, &QTableWidget::itemSelectionChanged, this, &game_list_frame::itemSelectionChangedSlot);
 	connect(m_game_grid, &QTableWidget::itemDoubleClicked, this, &game_list_frame::doubleClickedSlot);
 
+	m_game_cache = std::make_unique<game_list_cache>();
+	m_game_cache->load();
+
+	// Coalesce bursts of file system events (e.g. during installs) into a single refresh
+	m_refresh_timer.setSingleShot(true);
+	m_refresh_timer.setInterval(1000);
+
+	connect(&m_refresh_timer, &QTimer::timeout, this, [this]()
+	{
+		Refresh(true, false);
+	});
+	connect(&m_watcher, &QFileSystemWatcher::directoryChanged, this, &game_list_frame::OnWatchedPathChanged);
+	connect(&m_watcher, &QFileSystemWatcher::fileChanged, this, &game_list_frame::OnWatchedPathChanged);
+
 	connect(m_game_compat, &game_compatibility::DownloadStarted, [this]()
 	{
 		for (const auto& game : m_game_data)
@@ -542,34 +557,63 @@ void game_list_frame::Refresh(const bool from_drive, const bool scroll_after)
 
 		lf_queue<game_info> games;
 
+		QMap<QString, QString> sfo_dirs;
+
+		m_game_cache->begin_scan();
+
 		QtConcurrent::blockingMap(path_list, [&](const std::string& dir)
 		{
 			const Localized thread_localized;
 
 			{
 				const std::string sfo_dir = Emulator::GetSfoDirFromGamePath(dir, Emu.GetUsr());
-				const fs::file sfo_file(sfo_dir + "/PARAM.SFO");
-				if (!sfo_file)
+				const std::string sfo_path = sfo_dir + "/PARAM.SFO";
+
+				fs::stat_t sfo_stat{};
+				if (!fs::stat(sfo_path, sfo_stat) || sfo_stat.is_directory)
 				{
 					return;
 				}
 
-				const auto psf = psf::load_object(sfo_file);
-
 				GameInfo game;
-				game.path         = dir;
-				game.serial       = std::string(psf::get_string(psf, "TITLE_ID", ""));
-				game.name         = std::string(psf::get_string(psf, "TITLE", cat_unknown_localized));
-				game.app_ver      = std::string(psf::get_string(psf, "APP_VER", cat_unknown_localized));
-				game.version      = std::string(psf::get_string(psf, "VERSION", cat_unknown_localized));
-				game.category     = std::string(psf::get_string(psf, "CATEGORY", cat_unknown));
-				game.fw           = std::string(psf::get_string(psf, "PS3_SYSTEM_VER", cat_unknown_localized));
-				game.parental_lvl = psf::get_integer(psf, "PARENTAL_LEVEL", 0);
-				game.resolution   = psf::get_integer(psf, "RESOLUTION", 0);
-				game.sound_format = psf::get_integer(psf, "SOUND_FORMAT", 0);
-				game.bootable     = psf::get_integer(psf, "BOOTABLE", 0);
-				game.attr         = psf::get_integer(psf, "ATTRIBUTE", 0);
-				game.icon_path    = fs::get_config_dir() + "/Icons/game_icons/" + game.serial + "/ICON0.PNG";
+
+				// Only parse PARAM.SFO if it changed since the index was written
+				if (!m_game_cache->get_info(dir, sfo_stat, game))
+				{
+					const fs::file sfo_file(sfo_path);
+					if (!sfo_file)
+					{
+						return;
+					}
+
+					const auto psf = psf::load_object(sfo_file);
+
+					// Localized fallbacks are applied below, they must not be stored in the index
+					game.path         = dir;
+					game.serial       = std::string(psf::get_string(psf, "TITLE_ID", ""));
+					game.name         = std::string(psf::get_string(psf, "TITLE", ""));
+					game.app_ver      = std::string(psf::get_string(psf, "APP_VER", ""));
+					game.version      = std::string(psf::get_string(psf, "VERSION", ""));
+					game.category     = std::string(psf::get_string(psf, "CATEGORY", cat_unknown));
+					game.fw           = std::string(psf::get_string(psf, "PS3_SYSTEM_VER", ""));
+					game.parental_lvl = psf::get_integer(psf, "PARENTAL_LEVEL", 0);
+					game.resolution   = psf::get_integer(psf, "RESOLUTION", 0);
+					game.sound_format = psf::get_integer(psf, "SOUND_FORMAT", 0);
+					game.bootable     = psf::get_integer(psf, "BOOTABLE", 0);
+					game.attr         = psf::get_integer(psf, "ATTRIBUTE", 0);
+
+					m_game_cache->set_info(dir, sfo_stat, game);
+				}
+
+				for (std::string* value : { &game.name, &game.app_ver, &game.version, &game.fw })
+				{
+					if (value->empty())
+					{
+						*value = cat_unknown_localized;
+					}
+				}
+
+				game.icon_path = fs::get_config_dir() + "/Icons/game_icons/" + game.serial + "/ICON0.PNG";
 
 				if (!fs::is_file(game.icon_path))
 				{
@@ -578,6 +622,8 @@ void game_list_frame::Refresh(const bool from_drive, const bool scroll_after)
 
 				mutex_cat.lock();
 
+				sfo_dirs.insert(qstr(sfo_dir), qstr(dir));
+
 				const QString serial = qstr(game.serial);
 
 				// Read persistent_settings values
@@ -686,6 +732,11 @@ void game_list_frame::Refresh(const bool from_drive, const bool scroll_after)
 			m_game_data.push_back(std::move(g));
 		}
 
+		m_game_cache->end_scan();
+		m_game_cache->save();
+
+		UpdateWatchedPaths({ qstr(_hdd + "game/"), qstr(_hdd + "disc/") }, sfo_dirs);
+
 		// Try to update the app version for disc games if there is a patch
 		for (const auto& entry : m_game_data)
 		{
@@ -781,6 +832,45 @@ void game_list_frame::Refresh(const bool from_drive, const bool scroll_after)
 	}
 }
 
+void game_list_frame::UpdateWatchedPaths(const QStringList& root_dirs, const QMap<QString, QString>& sfo_dirs)
+{
+	QStringList wanted = root_dirs;
+	wanted.append(sfo_dirs.keys());
+
+	const QSet<QString> wanted_set = gui::utils::list_to_set(wanted);
+	const QSet<QString> watched_set = gui::utils::list_to_set(m_watcher.directories());
+
+	if (const QSet<QString> stale = watched_set - wanted_set; !stale.isEmpty())
+	{
+		m_watcher.removePaths(stale.values());
+	}
+
+	if (const QSet<QString> added = wanted_set - watched_set; !added.isEmpty())
+	{
+		// Paths that can't be watched (e.g. missing directories or exhausted inotify watches) are returned and simply skipped
+		if (const QStringList failed = m_watcher.addPaths(added.values()); !failed.isEmpty())
+		{
+			game_list_log.warning("Failed to watch %d game directories", failed.count());
+		}
+	}
+
+	m_watched_sfo_dirs = sfo_dirs;
+}
+
+void game_list_frame::OnWatchedPathChanged(const QString& path)
+{
+	game_list_log.trace("Watched game path changed: %s", sstr(path));
+
+	// The index validates PARAM.SFO and icons by size and mtime, but network shares don't always report reliable timestamps
+	if (const auto found = m_watched_sfo_dirs.find(path); found != m_watched_sfo_dirs.end())
+	{
+		m_game_cache->invalidate(sstr(found.value()));
+		m_game_cache->invalidate(sstr(path));
+	}
+
+	m_refresh_timer.start();
+}
+
 void game_list_frame::ToggleCategoryFilter(const QStringList& categories, bool show)
 {
 	if (show)
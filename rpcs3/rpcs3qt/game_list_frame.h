@@ -11,10 +11,13 @@
 #include <QStackedWidget>
 #include <QSet>
 #include <QTableWidgetItem>
+#include <QFileSystemWatcher>
+#include <QTimer>
 
 #include <memory>
 
 class game_list;
+class game_list_cache;
 class game_list_grid;
 class gui_settings;
 class emu_settings;
@@ -92,6 +95,7 @@ private Q_SLOTS:
 	void ShowContextMenu(const QPoint &pos);
 	void doubleClickedSlot(QTableWidgetItem *item);
 	void itemSelectionChangedSlot();
+	void OnWatchedPathChanged(const QString& path);
 Q_SIGNALS:
 	void GameListFrameClosed();
 	void NotifyGameSelection(const game_info& game);
@@ -112,6 +116,7 @@ private:
 	bool IsEntryVisible(const game_info& game);
 	void SortGameList();
 	bool SearchMatchesApp(const QString& name, const QString& serial) const;
+	void UpdateWatchedPaths(const QStringList& game_dirs, const QMap<QString, QString>& sfo_dirs);
 
 	bool RemoveCustomConfiguration(const std::string& title_id, game_info game = nullptr, bool is_interactive = false);
 	bool RemoveCustomPadConfiguration(const std::string& title_id, game_info game = nullptr, bool is_interactive = false);
@@ -160,6 +165,14 @@ private:
 	QSet<QString> m_hidden_list;
 	bool m_show_hidden{false};
 
+	// Persistent index of parsed game data and icon thumbnails
+	std::unique_ptr<game_list_cache> m_game_cache;
+
+	// Watches the game directories and refreshes the list once their contents settle
+	QFileSystemWatcher m_watcher;
+	QTimer m_refresh_timer;
+	QMap<QString, QString> m_watched_sfo_dirs; // sfo dir -> game dir
+
 	// Search
 	QString m_search_text;
 
@@ -39,6 +39,11 @@ namespace utils
 
 #include "asm.hpp"
 #include "endian.hpp"
+#include "sysinfo.hpp"
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
 
 // Total number of entries.
 static constexpr usz s_hashtable_size = 1u << 17;
@@ -518,11 +523,21 @@ static constexpr u128 dup8(u32 val)
 // Free or put in specified tls slot
 static void cond_free(u32 cond_id, u32 tls_slot);
 
-// Semaphore tree root (level 1) - split in 8 parts (8192 in each)
-static atomic_t<u128> s_cond_sem1{1};
+namespace
+{
+	// Semaphore on its own cache line (allocation pools don't share cache lines)
+	template <typename T>
+	struct alignas(64) cond_sem
+	{
+		atomic_t<T> val;
+	};
+}
+
+// Semaphore tree root (level 1) - 8 counters (8192 in each)
+static cond_sem<u32> s_cond_sem1[8]{{1}};
 
 // Semaphore tree (level 2) - split in 8 parts (1024 in each)
-static atomic_t<u128> s_cond_sem2[8]{{1}};
+static cond_sem<u128> s_cond_sem2[8]{{1}};
 
 // Semaphore tree (level 3) - split in 16 parts (128 in each)
 static atomic_t<u128> s_cond_sem3[64]{{1}};
@@ -559,6 +574,38 @@ namespace
 // TLS storage for few allocaded "semaphores" to allow skipping initialization
 static thread_local tls_cond_handler s_tls_conds{};
 
+// Round-robin pool counter for systems without current CPU information
+static atomic_t<u32> s_cond_pool_ctr{0};
+
+// Preferred level 1 part of the semaphore tree for this thread (-1 if not determined yet)
+static thread_local u32 s_tls_cond_pool = -1;
+
+static u32 cond_get_pool()
+{
+	if (s_tls_cond_pool < 8) [[likely]]
+	{
+		return s_tls_cond_pool;
+	}
+
+	// Split CPUs in 8 contiguous groups, neighbouring logical CPUs usually share caches or NUMA node.
+	// Threads allocating from their own part don't bounce level 2-4 cache lines with threads on other groups.
+#if defined(_WIN32)
+	u32 pool = ::GetCurrentProcessorNumber();
+#elif defined(__linux__)
+	const int cpu = ::sched_getcpu();
+	u32 pool = cpu >= 0 ? cpu : s_cond_pool_ctr++;
+#else
+	u32 pool = s_cond_pool_ctr++;
+#endif
+
+	if (const u32 count = utils::get_thread_count(); count > 8 && pool < count)
+	{
+		pool = pool * 8 / count;
+	}
+
+	return s_tls_cond_pool = pool % 8;
+}
+
 static u32 cond_alloc(uptr iptr, u128 mask, u32 tls_slot = -1)
 {
 	// Try to get cond from tls slot instead
@@ -573,28 +620,31 @@ static u32 cond_alloc(uptr iptr, u128 mask, u32 tls_slot = -1)
 		return id;
 	}
 
-	const u32 level1 = s_cond_sem1.atomic_op([](u128& val) -> u32
-	{
-		constexpr u128 max_mask = dup8(8192);
+	const u32 pool = cond_get_pool();
 
-		// Leave only bits indicating sub-semaphore is full, find free one
-		const u32 pos = utils::ctz128(~val & max_mask);
+	u32 level1 = -1;
 
-		if (pos == 128) [[unlikely]]
+	// Try preferred part first, then the others
+	for (u32 i = 0; i < 8; i++)
+	{
+		const u32 part = (pool + i) % 8;
+
+		if (s_cond_sem1[part].val.load() >= 8192)
 		{
-			// No free space
-			return -1;
+			continue;
 		}
 
-		val += u128{1} << (pos / 14 * 14);
-
-		return pos / 14;
-	});
+		if (s_cond_sem1[part].val.try_inc(8192))
+		{
+			level1 = part;
+			break;
+		}
+	}
 
 	// Determine whether there is a free slot or not
 	if (level1 < 8) [[likely]]
 	{
-		const u32 level2 = level1 * 8 + s_cond_sem2[level1].atomic_op([](u128& val)
+		const u32 level2 = level1 * 8 + s_cond_sem2[level1].val.atomic_op([](u128& val)
 		{
 			constexpr u128 max_mask = dup8(1024);
 
@@ -684,7 +734,7 @@ static void cond_free(u32 cond_id, u32 tls_slot = -1)
 
 	utils::prefetch_write(s_cond_sem3 + level2);
 	utils::prefetch_write(s_cond_sem2 + level1);
-	utils::prefetch_write(&s_cond_sem1);
+	utils::prefetch_write(s_cond_sem1 + level1);
 
 	cond->destroy();
 
@@ -696,15 +746,12 @@ static void cond_free(u32 cond_id, u32 tls_slot = -1)
 		val -= u128{1} << (level3 * 7);
 	});
 
-	s_cond_sem2[level1].atomic_op([&](u128& val)
+	s_cond_sem2[level1].val.atomic_op([&](u128& val)
 	{
 		val -= u128{1} << (level2 * 11);
 	});
 
-	s_cond_sem1.atomic_op([&](u128& val)
-	{
-		val -= u128{1} << (level1 * 14);
-	});
+	s_cond_sem1[level1].val--;
 }
 
 static cond_handle* cond_id_lock(u32 cond_id, u32 size, u128 mask, u64 thread_id = 0, uptr iptr = 0)
@@ -773,7 +820,7 @@ namespace
 		u64 maxc: 5; // Collision counter
 		u64 maxd: 11; // Distance counter
 		u64 bits: 24; // Allocated bits
-		u64 prio: 24; // Reserved
+		u64 cont: 24; // Contention counter (saturated)
 
 		u64 ref : 17; // Ref counter
 		u64 iptr: 47; // First pointer to use slot (to count used slots)
@@ -909,15 +956,26 @@ atomic_t<u16>* root_info::slot_alloc(uptr ptr) noexcept
 			if (bits.maxd < limit)
 				bits.maxd = limit;
 
+			const bool had_ref = bits.ref != 0;
+
 			bits.ref++;
 
 			if (bits.bits != (1ull << max_threads) - 1)
 			{
 				const u32 id = std::countr_one(bits.bits);
+
+				// Count waiters sharing the slot with other pointers
+				if (had_ref && bits.iptr != ptr && bits.cont != (1u << 24) - 1)
+					bits.cont++;
+
 				bits.bits |= bits.bits + 1;
 				return _this->slots + id;
 			}
 
+			// Count waiters displaced to the next slot
+			if (bits.cont != (1u << 24) - 1)
+				bits.cont++;
+
 			return nullptr;
 		});
 
@@ -1370,13 +1428,11 @@ bool atomic_wait_engine::raw_notify(const void* data, u64 thread_id)
 	if (!data)
 	{
 		// Extract total amount of allocated bits (but hard to tell which level4 slots are occupied)
-		const auto sem = s_cond_sem1.load();
-
 		u32 total = 0;
 
 		for (u32 i = 0; i < 8; i++)
 		{
-			if ((sem >> (i * 14)) & (8192 + 8191))
+			if (s_cond_sem1[i].val)
 			{
 				total = (i + 1) * 8192;
 			}
@@ -1614,14 +1670,14 @@ SAFE_BUFFERS void atomic_wait_engine::notify_all(const void* data, u32 size, u12
 
 namespace atomic_wait
 {
-	extern void parse_hashtable(bool(*cb)(u64 id, u32 refs, u64 ptr, u32 max_coll))
+	extern void parse_hashtable(bool(*cb)(u64 id, u32 refs, u64 ptr, u32 max_coll, u32 contention))
 	{
 		for (u64 i = 0; i < s_hashtable_size; i++)
 		{
 			const auto root = &s_hashtable[i];
 			const auto slot = root->bits.load();
 
-			if (cb(i, static_cast<u32>(slot.ref), slot.iptr, static_cast<u32>(slot.maxc)))
+			if (cb(i, static_cast<u32>(slot.ref), slot.iptr, static_cast<u32>(slot.maxc), static_cast<u32>(slot.cont)))
 			{
 				break;
 			}